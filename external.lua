@@ -21,6 +21,10 @@ group ""
 
 group "tests"
    include "tests/test_mccinfo"
+   include "tests/test_file_readers"
+   include "tests/test_fsm"
+   include "tests/fuzz_theater_readers"
+   include "tests/bench_theater_readers"
 group ""
 
 group "core"
@@ -10,6 +10,12 @@
 #include "mccinfo/query.hpp"
 #include "mccinfo/core/log.h"
 #include "mccinfo/file_readers.hpp"
+#include "mccinfo/file_readers/indexer.hpp"
+#include "mccinfo/file_readers/incremental.hpp"
+#include "mccinfo/file_readers/film_index.hpp"
+#include "mccinfo/file_readers/carnage_report.hpp"
+#include "mccinfo/file_readers/medal_vector.hpp"
+#include "mccinfo/file_readers/stats_store.hpp"
 #include "mccinfo/fsm/provider.hpp"
 #include "mccinfo/fsm/controller.hpp"
 #include "mccinfo/fsm/context.hpp"
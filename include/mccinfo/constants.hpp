@@ -5,18 +5,9 @@
 #include <vector>
 
 #include "frozen/unordered_map.h"
+#include "mccinfo/game_hint.hpp"
 namespace mccinfo {
 
-enum class game_hint {
-    HALO1,
-    HALO2,
-    HALO3,
-    HALO3ODST,
-    HALOREACH,
-    HALO4,
-    HALO2A
-};
-
 namespace constants {
 
 #define BITFLAG(x) \
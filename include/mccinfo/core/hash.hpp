@@ -0,0 +1,98 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+namespace mccinfo::core {
+
+namespace details {
+
+inline constexpr uint64_t xxh_prime1 = 0x9E3779B185EBCA87ull;
+inline constexpr uint64_t xxh_prime2 = 0xC2B2AE3D27D4EB4Full;
+inline constexpr uint64_t xxh_prime3 = 0x165667B19E3779F9ull;
+inline constexpr uint64_t xxh_prime4 = 0x85EBCA77C2B2AE63ull;
+inline constexpr uint64_t xxh_prime5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t Read64(const std::byte *p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t Read32(const std::byte *p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t XXHRound(uint64_t acc, uint64_t input) {
+    acc += input * xxh_prime2;
+    acc = std::rotl(acc, 31);
+    return acc * xxh_prime1;
+}
+
+inline uint64_t XXHMergeRound(uint64_t acc, uint64_t value) {
+    acc ^= XXHRound(0, value);
+    return (acc * xxh_prime1) + xxh_prime4;
+}
+
+} // namespace details
+
+// XXH64 of bytes (little endian hosts). Used to fingerprint file headers and paths.
+inline uint64_t Hash64(std::span<const std::byte> bytes, uint64_t seed = 0) {
+    using namespace details;
+
+    const std::byte *p = bytes.data();
+    const std::byte *end = p + bytes.size();
+    uint64_t h;
+
+    if (bytes.size() >= 32) {
+        uint64_t v1 = seed + xxh_prime1 + xxh_prime2;
+        uint64_t v2 = seed + xxh_prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - xxh_prime1;
+        do {
+            v1 = XXHRound(v1, Read64(p));
+            v2 = XXHRound(v2, Read64(p + 8));
+            v3 = XXHRound(v3, Read64(p + 16));
+            v4 = XXHRound(v4, Read64(p + 24));
+            p += 32;
+        } while ((end - p) >= 32);
+
+        h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        h = XXHMergeRound(h, v1);
+        h = XXHMergeRound(h, v2);
+        h = XXHMergeRound(h, v3);
+        h = XXHMergeRound(h, v4);
+    } else {
+        h = seed + xxh_prime5;
+    }
+
+    h += static_cast<uint64_t>(bytes.size());
+
+    for (; (end - p) >= 8; p += 8) {
+        h ^= XXHRound(0, Read64(p));
+        h = (std::rotl(h, 27) * xxh_prime1) + xxh_prime4;
+    }
+    if ((end - p) >= 4) {
+        h ^= static_cast<uint64_t>(Read32(p)) * xxh_prime1;
+        h = (std::rotl(h, 23) * xxh_prime2) + xxh_prime3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h ^= std::to_integer<uint64_t>(*p) * xxh_prime5;
+        h = std::rotl(h, 11) * xxh_prime1;
+    }
+
+    h ^= h >> 33;
+    h *= xxh_prime2;
+    h ^= h >> 29;
+    h *= xxh_prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace mccinfo::core
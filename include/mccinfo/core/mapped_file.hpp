@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#undef NOMINMAX
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace mccinfo::core {
+
+// Shared memory mapping of a whole file. Writes through a writable mapping land in the file.
+class mapped_file {
+  public:
+    mapped_file() = default;
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+    mapped_file(mapped_file &&other) noexcept {
+        *this = std::move(other);
+    }
+    mapped_file &operator=(mapped_file &&other) noexcept {
+        if (this != &other) {
+            close();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+#if defined(_WIN32)
+            file_ = std::exchange(other.file_, INVALID_HANDLE_VALUE);
+            mapping_ = std::exchange(other.mapping_, nullptr);
+#else
+            fd_ = std::exchange(other.fd_, -1);
+#endif
+        }
+        return *this;
+    }
+
+    ~mapped_file() {
+        close();
+    }
+
+    // Maps an existing file read only
+    bool open(const std::filesystem::path &path) {
+        return map(path, 0, false);
+    }
+
+    // Maps a file for writing, creating it or resizing it to size bytes first
+    bool create(const std::filesystem::path &path, size_t size) {
+        return map(path, size, true);
+    }
+
+    // Maps an existing file for writing at its current size
+    bool open_writable(const std::filesystem::path &path) {
+        return map(path, 0, true);
+    }
+
+    void close() {
+#if defined(_WIN32)
+        if (data_ != nullptr) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_ != nullptr) {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+        }
+        file_ = INVALID_HANDLE_VALUE;
+        mapping_ = nullptr;
+#else
+        if (data_ != nullptr) {
+            munmap(data_, size_);
+        }
+        if (fd_ != -1) {
+            ::close(fd_);
+        }
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    bool is_open() const {
+        return (data_ != nullptr);
+    }
+    size_t size() const {
+        return size_;
+    }
+    std::span<std::byte> bytes() {
+        return std::span<std::byte>(data_, size_);
+    }
+    std::span<const std::byte> bytes() const {
+        return std::span<const std::byte>(data_, size_);
+    }
+
+  private:
+    bool map(const std::filesystem::path &path, size_t size, bool writable) {
+        close();
+#if defined(_WIN32)
+        DWORD access = writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+        DWORD disposition = (size != 0) ? OPEN_ALWAYS : OPEN_EXISTING;
+        // read only maps let a writer keep appending past the mapped size
+        DWORD share = FILE_SHARE_READ | FILE_SHARE_DELETE | (writable ? 0 : FILE_SHARE_WRITE);
+        file_ = CreateFileW(path.c_str(), access, share, nullptr, disposition,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER file_size = {};
+        if (size != 0) {
+            file_size.QuadPart = static_cast<LONGLONG>(size);
+            if (!SetFilePointerEx(file_, file_size, nullptr, FILE_BEGIN) || !SetEndOfFile(file_)) {
+                close();
+                return false;
+            }
+        } else if (!GetFileSizeEx(file_, &file_size) || (file_size.QuadPart == 0)) {
+            close();
+            return false;
+        }
+
+        mapping_ = CreateFileMappingW(file_, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0,
+                                      0, nullptr);
+        if (mapping_ == nullptr) {
+            close();
+            return false;
+        }
+
+        data_ = static_cast<std::byte *>(
+            MapViewOfFile(mapping_, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+        if (data_ == nullptr) {
+            close();
+            return false;
+        }
+        size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+        int flags = writable ? O_RDWR : O_RDONLY;
+        if (size != 0) {
+            flags |= O_CREAT;
+        }
+        fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ == -1) {
+            return false;
+        }
+
+        if (size != 0) {
+            if (ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+                close();
+                return false;
+            }
+        } else {
+            struct stat st = {};
+            if ((fstat(fd_, &st) != 0) || (st.st_size == 0)) {
+                close();
+                return false;
+            }
+            size = static_cast<size_t>(st.st_size);
+        }
+
+        void *data = mmap(nullptr, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ,
+                          MAP_SHARED, fd_, 0);
+        if (data == MAP_FAILED) {
+            close();
+            return false;
+        }
+        data_ = static_cast<std::byte *>(data);
+        size_ = size;
+#endif
+        return true;
+    }
+
+    std::byte *data_ = nullptr;
+    size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+} // namespace mccinfo::core
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mccinfo::core {
+
+// Fixed size pool where every worker owns a task queue. Workers take from the front of their own
+// queue and, once it runs dry, steal from the back of the other workers' queues.
+class thread_pool {
+  public:
+    using task_t = std::function<void()>;
+
+    explicit thread_pool(size_t thread_count = 0) {
+        if (thread_count == 0) {
+            thread_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+
+        queues_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            queues_.emplace_back(std::make_unique<worker_queue>());
+        }
+
+        workers_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            workers_.emplace_back([this, i] { this->worker_loop(i); });
+        }
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t size() const {
+        return workers_.size();
+    }
+
+    void submit(task_t task) {
+        size_t index = next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        {
+            std::lock_guard<std::mutex> lock(queues_[index]->mutex_);
+            queues_[index]->tasks_.push_back(std::move(task));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            ++queued_;
+            ++pending_;
+        }
+        wake_.notify_one();
+    }
+
+    // Blocks until every submitted task has finished running
+    void wait() {
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        idle_.wait(lock, [this] { return (pending_ == 0); });
+    }
+
+  private:
+    struct worker_queue {
+        std::mutex mutex_;
+        std::deque<task_t> tasks_;
+    };
+
+    bool try_pop(size_t index, task_t &task) {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex_);
+        if (queues_[index]->tasks_.empty()) {
+            return false;
+        }
+        task = std::move(queues_[index]->tasks_.front());
+        queues_[index]->tasks_.pop_front();
+        return true;
+    }
+
+    bool try_steal(size_t index, task_t &task) {
+        for (size_t i = 1; i < queues_.size(); ++i) {
+            auto &victim = queues_[(index + i) % queues_.size()];
+
+            std::lock_guard<std::mutex> lock(victim->mutex_);
+            if (!victim->tasks_.empty()) {
+                task = std::move(victim->tasks_.back());
+                victim->tasks_.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker_loop(size_t index) {
+        while (true) {
+            task_t task;
+            if (try_pop(index, task) || try_steal(index, task)) {
+                {
+                    std::lock_guard<std::mutex> lock(wake_mutex_);
+                    --queued_;
+                }
+
+                task();
+
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                if (--pending_ == 0) {
+                    idle_.notify_all();
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            if (stopping_ && (queued_ == 0)) {
+                return;
+            }
+            wake_.wait(lock, [this] { return stopping_ || (queued_ > 0); });
+        }
+    }
+
+    std::vector<std::unique_ptr<worker_queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{0};
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    size_t queued_ = 0;  // submitted, not yet taken by a worker
+    size_t pending_ = 0; // submitted, not yet finished
+    bool stopping_ = false;
+};
+
+} // namespace mccinfo::core
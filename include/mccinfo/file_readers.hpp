@@ -5,1342 +5,462 @@
 #include <filesystem>
 #include <optional>
 #include <chrono>
-#include <set>
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <bit>
+
+#include "mccinfo/core/log.h"
+#include "mccinfo/game_hint.hpp"
+#include "mccinfo/file_readers/byte_source.hpp"
+#include "mccinfo/file_readers/classifier.hpp"
+#include "mccinfo/file_readers/layouts.hpp"
+#include "mccinfo/file_readers/scanner.hpp"
+#include "mccinfo/file_readers/theater_file_data.hpp"
+#include "mccinfo/file_readers/timestamp.hpp"
+#include "mccinfo/file_readers/utf16.hpp"
 
 namespace mccinfo {
 namespace file_readers {
 
-inline bool IsLeapSecondsEnabled(void) {
-    std::wstring regSubKey = L"SYSTEM\\CurrentControlSet\\Control\\LeapSecondInformation";
-    std::wstring regValue(L"Enabled");
-    DWORD val;
-    DWORD dataSize = sizeof(val);
-    if (ERROR_SUCCESS == RegGetValueW(HKEY_LOCAL_MACHINE, regSubKey.c_str(), regValue.c_str(),
-                                      RRF_RT_DWORD, nullptr /*type not required*/, &val, &dataSize))
-        return val == (DWORD)1;
-    return false;
-}
+namespace details {
 
-inline unsigned int GetSystemAccountedLeapSeconds(void) {
-    if (IsLeapSecondsEnabled()) {
-        std::wstring regSubKey = L"SYSTEM\\CurrentControlSet\\Control\\LeapSecondInformation";
-        std::wstring regValue(L"LeapSeconds");
-        DWORD val = 0;
-        DWORD dataSize = sizeof(val);
-        if (ERROR_SUCCESS == RegGetValueW(HKEY_LOCAL_MACHINE, regSubKey.c_str(), regValue.c_str(),
-                                          RRF_RT_REG_BINARY, nullptr /*type not required*/, &val,
-                                          &dataSize))
-            return val;
+// Reads the leading `region_size` bytes of a theater file with a single unbuffered read, so the
+// readers decode every field from memory instead of seeking and re-reading the stream per field.
+inline std::optional<std::vector<std::byte>> LoadTheaterFileRegion(
+    const std::filesystem::path &theater_file, size_t region_size) {
+    std::error_code ec;
+    auto file_size = std::filesystem::file_size(theater_file, ec);
+    if (ec) {
+        return std::nullopt;
     }
-    return 0;
-}
-
 
-
-using player_info = std::pair<int, std::string>;
-
-struct theater_file_data {
-    std::string gametype_;
-    std::string desc_;
-    std::string author_xuid_;
-    std::string author_;
-    std::set<player_info> player_set_;
-    std::filesystem::file_time_type utc_timestamp_;
-};
-
-class theater_file_reader {
-  public:
-    std::optional<theater_file_data> Read(const std::filesystem::path &theater_file) {
-        try {
-            // should be openable and of explicit size
-            if (std::filesystem::is_regular_file(theater_file)) {
-                std::ifstream ifs;
-                ifs.open(theater_file, std::ios::binary);
-
-                return this->ReadImpl(theater_file, ifs);
-            }
-        }
-
-        catch (std::exception &e) {
-            std::cout << e.what() << std::endl;
-        }
-        
+    std::ifstream ifs;
+    ifs.rdbuf()->pubsetbuf(nullptr, 0);
+    ifs.open(theater_file, std::ios::binary);
+    if (!ifs) {
         return std::nullopt;
     }
 
-  private:
-    virtual std::optional<theater_file_data> ReadImpl(
-        const std::filesystem::path &theater_file,
-        std::ifstream &ifs) = 0;
-    virtual std::optional<std::string> ReadTheaterFileGameType(std::ifstream &ifs) = 0;
-    virtual std::optional<std::string> ReadTheaterFileGameDescription(std::ifstream &ifs) = 0;
-    virtual std::optional<std::string> ReadTheaterFileAuthorXUID(std::ifstream &ifs) = 0;
-    virtual std::optional<std::string> ReadTheaterFileAuthor(std::ifstream &ifs) = 0;
-    virtual std::optional<std::filesystem::file_time_type> ReadTheaterFileUTCTimestamp(
-        std::ifstream &ifs) = 0;
-    virtual std::optional<std::set<player_info>> ReadTheaterFilePlayerSet(std::ifstream &ifs) = 0;
-};
-
-class halo3_theater_file_reader : public theater_file_reader {
-  private:
-    virtual std::optional<theater_file_data> ReadImpl(const std::filesystem::path &theater_file,
-                                                      std::ifstream &ifs) override final {
-        theater_file_data file_data;
+    std::vector<std::byte> region(static_cast<size_t>(std::min<uintmax_t>(file_size, region_size)));
+    ifs.read(reinterpret_cast<char *>(region.data()), static_cast<std::streamsize>(region.size()));
+    region.resize(static_cast<size_t>(ifs.gcount()));
 
-        auto gametype = this->ReadTheaterFileGameType(ifs);
-        if (gametype.has_value()) {
-            file_data.gametype_ = gametype.value();
-        }
-
-        auto desc = this->ReadTheaterFileGameDescription(ifs);
-        if (desc.has_value()) {
-            file_data.desc_ = desc.value();
-        }
-
-        auto xuid = this->ReadTheaterFileAuthorXUID(ifs);
-        if (xuid.has_value()) {
-            file_data.author_xuid_ = xuid.value();
-        }
-
-        auto utc_timestamp = this->ReadTheaterFileUTCTimestamp(ifs);
-        if (utc_timestamp.has_value()) {
-            file_data.utc_timestamp_ = utc_timestamp.value();
-        }
-
-        auto player_set = this->ReadTheaterFilePlayerSet(ifs);
-        if (player_set.has_value()) {
-            file_data.player_set_ = player_set.value();
-        }
+    return region;
+}
 
-        ifs.close();
-        return file_data;
-        // if GameType == "", then Discern if its campaign or firefight
-        // could split this into halo3_odst_theater_file_data
+// Appends the bytes up to region_size that a shorter first load left out
+inline bool ExtendTheaterFileRegion(const std::filesystem::path &theater_file,
+                                    std::vector<std::byte> &region, size_t region_size) {
+    if (region.size() >= region_size) {
+        return true;
     }
-    virtual std::optional<std::string> ReadTheaterFileGameType(std::ifstream &ifs) override final {
-        static const unsigned long long desc_offset = 0x00000048;
-
-        ifs.seekg(0);
-        ifs.seekg(desc_offset);
-
-        std::vector<char> buffer;
-        buffer.resize(184);
-
-        ifs.read(&buffer.data()[0], 184);
 
-        std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()));
-
-        auto bytes = utility::ConvertWStringToBytes(wstr);
-        if (bytes.has_value()) {
-            return bytes.value();
-        }
-
-        return std::nullopt;
+    std::ifstream ifs;
+    ifs.rdbuf()->pubsetbuf(nullptr, 0);
+    ifs.open(theater_file, std::ios::binary);
+    if (!ifs) {
+        return false;
     }
-    virtual std::optional<std::string> ReadTheaterFileGameDescription(std::ifstream &ifs) override final {
-        static const unsigned long long desc_offset = 0x00000048;
-
-        ifs.seekg(0);
-        ifs.seekg(desc_offset);
-
-        bool offset_found = false;
-        bool gap_found = false;
-        unsigned long long rel_offset = 0x0;
-        while (!offset_found) {
-            std::vector<char> tbuffer;
-            tbuffer.resize(2);
-            ifs.read(&tbuffer.data()[0], 2);
-            rel_offset += 2;
-            if ((!gap_found) && (tbuffer[0] == '\0')) {
-                gap_found = true;
-            }
-            if ((gap_found) && (tbuffer[0] != '\0')) {
-                rel_offset -= 2;
-                ifs.seekg(-2, std::ios_base::cur);
-                offset_found = true;
-            }
-        }
 
-        unsigned long long desc_length = 184 - rel_offset;
-        std::vector<char> buffer;
-        buffer.resize(desc_length);
-
-        ifs.read(&buffer.data()[0], desc_length);
+    size_t loaded = region.size();
+    region.resize(region_size);
+    ifs.seekg(static_cast<std::streamoff>(loaded));
+    ifs.read(reinterpret_cast<char *>(region.data() + loaded),
+             static_cast<std::streamsize>(region_size - loaded));
+    region.resize(loaded + static_cast<size_t>(std::max<std::streamsize>(ifs.gcount(), 0)));
+    return true;
+}
 
-        std::string str(buffer.data());
-        return str;
+// Empty if [offset, offset + count) is not entirely inside the region
+inline std::span<const std::byte> RegionAt(std::span<const std::byte> region, size_t offset,
+                                           size_t count) {
+    if ((offset > region.size()) || (count > (region.size() - offset))) {
+        return {};
     }
-    virtual std::optional<std::string> ReadTheaterFileAuthorXUID(std::ifstream &ifs) override final {
-        static const unsigned long long xuid_offset = 0x00000100;
-
-        ifs.seekg(0);
-        ifs.seekg(xuid_offset);
-        std::vector<char> buffer;
-        buffer.resize(8);
+    return region.subspan(offset, count);
+}
 
-        size_t i = 0;
-        for (auto &b : buffer) {
-            ifs.read(&buffer.data()[i], 1);
-            ++i;
-        }
+// Strings are stored as null terminated UTF-16LE, transcoded straight into the inline storage
+template <size_t N>
+void DecodeWString(std::span<const std::byte> bytes, fixed_string<N> &str) {
+    str.resize(TranscodeUTF16LEToUTF8(bytes, str.buffer()));
+}
 
-        std::reverse(buffer.begin(), buffer.end());
+template <size_t N>
+void DecodeString(std::span<const std::byte> bytes, fixed_string<N> &str) {
+    const char *data = reinterpret_cast<const char *>(bytes.data());
+    str.assign(std::string_view(data, strnlen(data, bytes.size())));
+}
 
-        std::ostringstream ret{};
-        for (const auto &b : buffer) {
-            ret << std::hex << std::setfill('0') << std::setw(2) << (int)((unsigned char)b);
-        }
-        auto tu = [](std::string s) -> std::string {
-            for (auto &c : s)
-                c = toupper(c);
-            return s;
-        };
-        std::string xuid("0x" + tu(ret.str()));
-        return xuid;
+template <size_t N>
+void DecodeXUID(std::span<const std::byte> bytes, fixed_string<N> &xuid) {
+    static constexpr char hex[] = "0123456789ABCDEF";
+
+    // stored little endian, displayed most significant byte first
+    auto buffer = xuid.buffer();
+    size_t size = 0;
+    buffer[size++] = '0';
+    buffer[size++] = 'x';
+    for (auto it = bytes.rbegin(); (it != bytes.rend()) && ((size + 2) <= buffer.size()); ++it) {
+        buffer[size++] = hex[std::to_integer<uint8_t>(*it) >> 4];
+        buffer[size++] = hex[std::to_integer<uint8_t>(*it) & 0xF];
     }
-    virtual std::optional<std::string> ReadTheaterFileAuthor(std::ifstream &ifs) override final {
-        return "";
-    }
-    virtual std::optional<std::filesystem::file_time_type> ReadTheaterFileUTCTimestamp(
-        std::ifstream &ifs) override final {
-        static const unsigned long long timestamp_offset = 0x00000068; // read at least 128 bytes?
-        static const unsigned long long duration_offset = 0x00000118;  // read two bytes
-
-        ifs.seekg(0);
-        ifs.seekg(duration_offset);
-
-        char buffer[3];
-        buffer[2] = '\0';
-        ifs.read(&buffer[0], 1);
-        ifs.read(&buffer[1], 1);
-        char t = buffer[0];
-        buffer[0] = buffer[1];
-        buffer[1] = t;
-        unsigned char fixed[3];
-        fixed[2] = '\0';
-        if (0 > buffer[0]) {
-            fixed[0] = 128 + abs((-128 + (-1 * buffer[0])));
-        } else
-            fixed[0] = buffer[0];
-        if (0 > buffer[1]) {
-            fixed[1] = 128 + abs((-128 + (-1 * buffer[1])));
-        } else
-            fixed[1] = buffer[1];
-
-        std::ostringstream ret{};
-
-        for (size_t i = 0; i < 2; ++i)
-            ret << std::hex << std::setfill('0') << std::setw(2) << (int)fixed[i];
-
-        // std::cout << "fixed[0]: " << (int)fixed[0] << std::endl;
-        // std::cout << "fixed[1]: " << (int)fixed[1] << std::endl;
-        auto match_length = std::chrono::seconds(strtoul(ret.str().c_str(), NULL, 16));
-
-        ifs.seekg(timestamp_offset);
-        char buffer2[128];
-        ifs.read(buffer2, 128);
-        // ifs.close();
-
-        std::tm tm = {};
-        std::string dirty(buffer2, 128);
-
-        dirty = dirty.substr(dirty.find(','));
-        dirty.replace(0, 2, "");
+    xuid.resize(size);
+}
 
-        std::istringstream ss(dirty);
+inline int DecodeTeam(std::byte team) {
+    return static_cast<int>(static_cast<int8_t>(std::to_integer<uint8_t>(team)));
+}
 
-        ss >> std::get_time(&tm, "%A %B %d, %Y %H:%M:%S");
-        if (ss.fail())
-            return std::nullopt;
+// Match length in seconds, little endian
+inline std::chrono::seconds DecodeDuration(std::span<const std::byte> bytes) {
+    return std::chrono::seconds(std::to_integer<unsigned>(bytes[0]) |
+                                (std::to_integer<unsigned>(bytes[1]) << 8));
+}
 
-        std::time_t local_time = mktime(&tm);
-        int dst = 0;
-        _get_daylight(&dst);
-        // std::cout << "match length: " << match_length << std::endl;
-        std::chrono::seconds dst_offset{dst * 3600};
-        std::chrono::utc_time<std::chrono::seconds> utc(
-            std::chrono::seconds(local_time) + match_length +
-            (std::filesystem::_File_time_clock::_Skipped_filetime_leap_seconds -
-             std::chrono::seconds(GetSystemAccountedLeapSeconds())) -
-            dst_offset);
+} // namespace details
 
-        return std::chrono::file_clock::from_utc(utc);
+// Decodes any title's theater file from its compile time layout; see file_readers/layouts.hpp
+template <theater_file_layout Layout>
+class theater_file_reader {
+  public:
+    static constexpr size_t GetRegionSize() {
+        return Layout.region_size_;
     }
-    virtual std::optional<std::set<player_info>> ReadTheaterFilePlayerSet(
-        std::ifstream &ifs) override final {
-        static const unsigned long long head_offset = 0x000001D8;
-
-        ifs.seekg(0);
-        ifs.seekg(head_offset);
-
-        bool player_set_offset_found = false;
-        unsigned int ones_found = 0;
-
-        while (!player_set_offset_found) {
-            bool found_one_this_it = false;
 
-            char buf[1];
-            ifs.read(&buf[0], 1);
-            if (buf[0] == '\1') {
-                ++ones_found;
-                found_one_this_it = true;
-            }
-            // check if the last 4 bytes, 11 bytes ahead, have the pattern:
-            // {not zero, not zero, zero, zero}
-
-            if ((ones_found >= 3) && found_one_this_it) {
-                char buf2[11];
-                ifs.read(&buf2[0], 11);
-                if ((buf2[7] != '\0') && (buf2[8] != '\0') && (buf2[9] == '\0') &&
-                    (buf2[10] == '\0')) {
-                    ifs.seekg(12, std::ios_base::cur);
-                    player_set_offset_found = true;
-                } else {
-                    // go back
-                    ifs.seekg(-11, std::ios_base::cur);
-                }
-            }
-        }
-
-        std::set<player_info> player_set;
-        int empty_region_count = 0;
-        while (true) {
-            // look at current byte, no more players if \0
-
-            bool current_is_empty_region = true;
-            char buf[1];
-            ifs.read(&buf[0], 1);
-            if (buf[0] == '\0')
-            {
-                ++empty_region_count;
-                if (empty_region_count >= 5) {
-                    break;
-                }
-            } else {
-                empty_region_count = 0;
-                current_is_empty_region = false;
-            }
-
-            // reset
-            ifs.seekg(-1, std::ios_base::cur);
-            if (!current_is_empty_region) {
-                // read player name
-                std::vector<char> buffer;
-                buffer.resize(32);
-
-                ifs.read(&buffer.data()[0], 32);
-
-                std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()));
-
-                bool success = false;
-                auto bytes = utility::ConvertWStringToBytes(wstr);
-                if (bytes.has_value()) {
-                
-                    success = true;
-                }
-
-                char team_buf[1];
-                ifs.seekg(120, std::ios_base::cur);
-                ifs.read(&team_buf[0], 1);
-                ifs.seekg(-1, std::ios_base::cur);
-                ifs.seekg(-120, std::ios_base::cur);
-
-                if (success) {
-                    player_set.insert({team_buf[0], bytes.value()});
-                }
-
-
-                // skip to next player
-                ifs.seekg(184 - 32, std::ios_base::cur);
-            } else 
-            {
-                ifs.seekg(184, std::ios_base::cur);
-            }
-        }
-
-        return player_set;
-    }
-};
+    // Leading bytes that hold every requested field, so narrow reads skip the player table
+    static constexpr size_t GetRegionSize(uint32_t fields) {
+        size_t size = 0;
+        auto extend = [&size](size_t offset, size_t length) {
+            size = std::max(size, offset + length);
+        };
 
-class haloreach_theater_file_reader : public theater_file_reader {
-  private:
-    virtual std::optional<theater_file_data> ReadImpl(const std::filesystem::path &theater_file,
-                                                      std::ifstream &ifs) override final {
-        theater_file_data file_data;
-        
-        auto gametype = this->ReadTheaterFileGameType(ifs);
-        if (gametype.has_value()) {
-            file_data.gametype_ = gametype.value();
+        if (fields & FIELD_GAMETYPE) {
+            extend(Layout.gametype_offset_, Layout.gametype_length_);
         }
-
-        auto desc = this->ReadTheaterFileGameDescription(ifs);
-        if (desc.has_value()) {
-            file_data.desc_ = desc.value();
+        if (fields & (FIELD_DESC | FIELD_UTC_TIMESTAMP)) {
+            extend(Layout.desc_offset_, Layout.desc_length_);
         }
-
-        auto author = this->ReadTheaterFileAuthor(ifs);
-        if (author.has_value()) {
-            file_data.author_ = author.value();
-            file_data.player_set_.insert({-1, file_data.author_});
+        if ((fields & FIELD_UTC_TIMESTAMP) && (Layout.duration_offset_ > 0)) {
+            extend(Layout.duration_offset_, 2);
         }
-
-        auto xuid = this->ReadTheaterFileAuthorXUID(ifs);
-        if (xuid.has_value()) {
-            file_data.author_xuid_ = xuid.value();
+        if (fields & FIELD_AUTHOR_XUID) {
+            extend(Layout.xuid_offset_, 8);
         }
-
-        /*
-        auto utc_timestamp = this->ReadTheaterFileUTCTimestamp(ifs);
-        if (utc_timestamp.has_value()) {
-            file_data.utc_timestamp_ = utc_timestamp.value();
+        if (fields & FIELD_AUTHOR) {
+            extend(Layout.author_offset_, Layout.author_length_);
         }
-        */
-
-        auto player_set = this->ReadTheaterFilePlayerSet(ifs);
-        if (player_set.has_value()) {
-            file_data.player_set_.insert(player_set.value().begin(), player_set.value().end());
+        if (fields & FIELD_PLAYER_SET) {
+            extend(Layout.region_size_, 0);
         }
-
-        ifs.close();
-        return file_data;
-        // if GameType == "", then Discern if its campaign or firefight
-        // could split this into halo3_odst_theater_file_data
+        return std::min(size, Layout.region_size_);
     }
-    virtual std::optional<std::string> ReadTheaterFileGameType(std::ifstream &ifs) override final {
-        static const unsigned long long gametype_offset = 0x000000C0;
-
-        ifs.seekg(0);
-        ifs.seekg(gametype_offset);
-
-        std::vector<char> buffer;
-        buffer.resize(256);
-
-        ifs.read(&buffer.data()[0], 256);
-
-        std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()));
 
-        auto bytes = utility::ConvertWStringToBytes(wstr);
-        if (bytes.has_value()) {
-            return bytes.value();
+    static std::optional<theater_file_data> Read(
+        const std::filesystem::path &theater_file, uint32_t fields = FIELD_ALL,
+        const clock_context &clock = clock_context::System()) {
+        try {
+            // should be openable and of explicit size
+            if (std::filesystem::is_regular_file(theater_file)) {
+                auto region = details::LoadTheaterFileRegion(theater_file, GetRegionSize(fields));
+                if (region.has_value()) {
+                    return Read(theater_file, region.value(), fields, clock);
+                }
+            }
         }
 
-        return std::nullopt;
-    }
-    virtual std::optional<std::string> ReadTheaterFileGameDescription(
-        std::ifstream &ifs) override final {
-        static const unsigned long long desc_offset = 0x000001C0;
-
-        ifs.seekg(0);
-        ifs.seekg(desc_offset);
-
-        unsigned long long desc_length = 256;
-        std::vector<char> buffer;
-        buffer.resize(desc_length);
-
-        ifs.read(&buffer.data()[0], desc_length);
-
-        std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()), buffer.size());
-
-        auto bytes = utility::ConvertWStringToBytes(wstr);
-        if (bytes.has_value()) {
-            return bytes.value();
+        catch (std::exception &e) {
+            std::cout << e.what() << std::endl;
         }
 
         return std::nullopt;
     }
-    virtual std::optional<std::string> ReadTheaterFileAuthorXUID(
-        std::ifstream &ifs) override final {
-        static const unsigned long long xuid_offset = 0x00000080;
-
-        ifs.seekg(0);
-        ifs.seekg(xuid_offset);
-        std::vector<char> buffer;
-        buffer.resize(8);
 
-        size_t i = 0;
-        for (auto &b : buffer) {
-            ifs.read(&buffer.data()[i], 1);
-            ++i;
+    // Decodes from a caller-provided copy of (at least) the leading GetRegionSize(fields) bytes
+    static std::optional<theater_file_data> Read(
+        const std::filesystem::path &theater_file, std::span<const std::byte> region,
+        uint32_t fields = FIELD_ALL, const clock_context &clock = clock_context::System()) {
+        try {
+            theater_file_data file_data;
+            Decode(theater_file, region, file_data, fields, clock);
+            return file_data;
         }
 
-        std::reverse(buffer.begin(), buffer.end());
-
-        std::ostringstream ret{};
-        for (const auto &b : buffer) {
-            ret << std::hex << std::setfill('0') << std::setw(2) << (int)((unsigned char)b);
+        catch (std::exception &e) {
+            std::cout << e.what() << std::endl;
         }
-        auto tu = [](std::string s) -> std::string {
-            for (auto &c : s)
-                c = toupper(c);
-            return s;
-        };
-        std::string xuid("0x" + tu(ret.str()));
-        return xuid;
-    }
-    virtual std::optional<std::string> ReadTheaterFileAuthor(std::ifstream &ifs) override final {
-        static const unsigned long long author_offset = 0x00000088;
 
-        ifs.seekg(0);
-        ifs.seekg(author_offset);
-        std::vector<char> buffer;
-        buffer.resize(16);
-
-        ifs.read(&buffer.data()[0], 16);
-        
-        std::string str(buffer.data());
-        return str;
+        return std::nullopt;
     }
-    virtual std::optional<std::filesystem::file_time_type> ReadTheaterFileUTCTimestamp(
-        std::ifstream &ifs) override final {
-        
-        static const unsigned long long timestamp_offset = 0x00000068; // read at least 128 bytes?
-        static const unsigned long long duration_offset = 0x00000118;  // read two bytes
-
-        ifs.seekg(0);
-        ifs.seekg(duration_offset);
-
-        char buffer[3];
-        buffer[2] = '\0';
-        ifs.read(&buffer[0], 1);
-        ifs.read(&buffer[1], 1);
-        char t = buffer[0];
-        buffer[0] = buffer[1];
-        buffer[1] = t;
-        unsigned char fixed[3];
-        fixed[2] = '\0';
-        if (0 > buffer[0]) {
-            fixed[0] = 128 + abs((-128 + (-1 * buffer[0])));
-        } else
-            fixed[0] = buffer[0];
-        if (0 > buffer[1]) {
-            fixed[1] = 128 + abs((-128 + (-1 * buffer[1])));
-        } else
-            fixed[1] = buffer[1];
-
-        std::ostringstream ret{};
-
-        for (size_t i = 0; i < 2; ++i)
-            ret << std::hex << std::setfill('0') << std::setw(2) << (int)fixed[i];
-
-        // std::cout << "fixed[0]: " << (int)fixed[0] << std::endl;
-        // std::cout << "fixed[1]: " << (int)fixed[1] << std::endl;
-        auto match_length = std::chrono::seconds(strtoul(ret.str().c_str(), NULL, 16));
-
-        ifs.seekg(timestamp_offset);
-        char buffer2[128];
-        ifs.read(buffer2, 128);
-        // ifs.close();
-
-        std::tm tm = {};
-        std::string dirty(buffer2, 128);
-
-        dirty = dirty.substr(dirty.find(','));
-        dirty.replace(0, 2, "");
-
-        std::istringstream ss(dirty);
-
-        ss >> std::get_time(&tm, "%A %B %d, %Y %H:%M:%S");
-        if (ss.fail())
-            return std::nullopt;
-
-        std::time_t local_time = mktime(&tm);
-        int dst = 0;
-        _get_daylight(&dst);
-        // std::cout << "match length: " << match_length << std::endl;
-        std::chrono::seconds dst_offset{dst * 3600};
-        std::chrono::utc_time<std::chrono::seconds> utc(
-            std::chrono::seconds(local_time) + match_length +
-            (std::filesystem::_File_time_clock::_Skipped_filetime_leap_seconds -
-             std::chrono::seconds(GetSystemAccountedLeapSeconds())) -
-            dst_offset);
-
-        return std::chrono::file_clock::from_utc(utc);
 
+    // Decodes from a buffer, memory map or chunked source. The region is used in place when the
+    // source holds it contiguously; theater_file only names the film (see gametype_from_path_).
+    template <byte_source Source>
+    static std::optional<theater_file_data> Read(
+        const std::filesystem::path &theater_file, const Source &source,
+        uint32_t fields = FIELD_ALL, const clock_context &clock = clock_context::System()) {
+        std::vector<std::byte> scratch;
+        return Read(theater_file, details::SourceRegion(source, GetRegionSize(fields), scratch),
+                    fields, clock);
     }
-    virtual std::optional<std::set<player_info>> ReadTheaterFilePlayerSet(
-        std::ifstream &ifs) override final {
 
-        
-        static const unsigned long long head_offset = 0x00000BD0;
-
-        ifs.seekg(0);
-        ifs.seekg(head_offset);
-
-        std::set<player_info> player_set;
-
-        int empty_region_count = 0;
-        while (true) {
-            // look at current byte, no more players if \0
-            bool current_is_empty_region = true;
-            char buf[1];
-            ifs.read(&buf[0], 1);
-            if (buf[0] == '\0') {
-                ++empty_region_count;
-                if (empty_region_count >= 2) {
-                    break;
-                }
+    // Fields not requested, or that the region is too short to hold, are left empty. The author
+    // joins the player set (as team -1) only when both are requested.
+    static void Decode(const std::filesystem::path &theater_file,
+                       std::span<const std::byte> region, theater_file_data &file_data,
+                       uint32_t fields = FIELD_ALL,
+                       const clock_context &clock = clock_context::System()) {
+        if (fields & FIELD_GAMETYPE) {
+            if (Layout.gametype_from_path_ &&
+                (theater_file.generic_string().find("campaign") != std::string::npos)) {
+                file_data.gametype_.assign("Campaign");
             } else {
-                empty_region_count = 0;
-                current_is_empty_region = false;
+                details::DecodeWString(
+                    details::RegionAt(region, Layout.gametype_offset_, Layout.gametype_length_),
+                    file_data.gametype_);
             }
+        }
 
-            // reset
-            ifs.seekg(-1, std::ios_base::cur);
-            
-            if (!current_is_empty_region) {
-                // read player name
-                std::vector<char> buffer;
-                buffer.resize(32);
-
-                ifs.read(&buffer.data()[0], 32);
-
-                std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()));
-                
-                bool success = false;
-                auto bytes = utility::ConvertWStringToBytes(wstr);
-                if (bytes.has_value()) {
-                    
-                    success = true;
-                }
-                char team_buf[1];
-                ifs.seekg(88, std::ios_base::cur);
-                ifs.read(&team_buf[0], 1);
-                ifs.seekg(-1, std::ios_base::cur);
-                ifs.seekg(-88, std::ios_base::cur);
+        if (fields & (FIELD_DESC | FIELD_UTC_TIMESTAMP)) {
+            DecodeGameDescription(region, file_data.desc_);
+        }
 
-                if (success) {
-                    player_set.insert({team_buf[0], bytes.value()});
+        if constexpr (Layout.author_length_ > 0) {
+            if (fields & FIELD_AUTHOR) {
+                auto author =
+                    details::RegionAt(region, Layout.author_offset_, Layout.author_length_);
+                if (!author.empty()) {
+                    details::DecodeString(author, file_data.author_);
+                    if (fields & FIELD_PLAYER_SET) {
+                        file_data.player_set_.insert(-1, file_data.author_);
+                    }
                 }
-
-                ifs.seekg(160 - 32, std::ios_base::cur);
-            } else {
-                ifs.seekg(160, std::ios_base::cur);
             }
-
-            // skip to next player
         }
 
-
-        return player_set;
-    }
-};
-
-class halo4_theater_file_reader : public theater_file_reader {
-  private:
-    virtual std::optional<theater_file_data> ReadImpl(const std::filesystem::path &theater_file,
-                                                      std::ifstream &ifs) override final {
-        theater_file_data file_data;
-        
-        if (theater_file.generic_string().find("campaign") != std::string::npos) {
-            file_data.gametype_ = "Campaign";
-        } 
-        else {
-            auto gametype = this->ReadTheaterFileGameType(ifs);
-            if (gametype.has_value()) {
-                file_data.gametype_ = gametype.value();
+        if (fields & FIELD_AUTHOR_XUID) {
+            auto xuid = details::RegionAt(region, Layout.xuid_offset_, 8);
+            if (!xuid.empty()) {
+                details::DecodeXUID(xuid, file_data.author_xuid_);
             }
         }
 
-        auto desc = this->ReadTheaterFileGameDescription(ifs);
-        if (desc.has_value()) {
-            file_data.desc_ = desc.value();
-        }
-
-        auto author = this->ReadTheaterFileAuthor(ifs);
-        if (author.has_value()) {
-            file_data.author_ = author.value();
-            file_data.player_set_.insert({-1, file_data.author_});
-        }
-
-        auto xuid = this->ReadTheaterFileAuthorXUID(ifs);
-        if (xuid.has_value()) {
-            file_data.author_xuid_ = xuid.value();
-        }
-
-        /*
-        auto utc_timestamp = this->ReadTheaterFileUTCTimestamp(ifs);
-        if (utc_timestamp.has_value()) {
-            file_data.utc_timestamp_ = utc_timestamp.value();
-        }
-        */
-
-        auto player_set = this->ReadTheaterFilePlayerSet(ifs);
-        if (player_set.has_value()) {
-            file_data.player_set_.insert(player_set.value().begin(), player_set.value().end());
-        }
-
-        ifs.close();
-        return file_data;
-        // if GameType == "", then Discern if its campaign or firefight
-        // could split this into halo3_odst_theater_file_data
-    }
-    virtual std::optional<std::string> ReadTheaterFileGameType(std::ifstream &ifs) override final {
-        static const unsigned long long gametype_offset = 0x000000C0;
-
-        ifs.seekg(0);
-        ifs.seekg(gametype_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-        std::vector<char> buffer;
-        buffer.resize(256);
-
-        ifs.read(&buffer.data()[0], 256);
-        if (ifs.fail()) {
-            return std::nullopt;
-        }
-
-        std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()));
-
-        auto bytes = utility::ConvertWStringToBytes(wstr);
-        if (bytes.has_value()) {
-            return bytes.value();
-        }
-
-        return std::nullopt;
-    }
-    virtual std::optional<std::string> ReadTheaterFileGameDescription(
-        std::ifstream &ifs) override final {
-        static const unsigned long long desc_offset = 0x000001C0;
-
-        ifs.seekg(0);
-        ifs.seekg(desc_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-        unsigned long long desc_length = 256;
-        std::vector<char> buffer;
-        buffer.resize(desc_length);
-
-        ifs.read(&buffer.data()[0], desc_length);
-        if (ifs.fail()) {
-            return std::nullopt;
-        }
-        std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()), buffer.size());
-
-        auto bytes = utility::ConvertWStringToBytes(wstr);
-        if (bytes.has_value()) {
-            return bytes.value();
-        }
-
-        return std::nullopt;
-    }
-    virtual std::optional<std::string> ReadTheaterFileAuthorXUID(
-        std::ifstream &ifs) override final {
-        static const unsigned long long xuid_offset = 0x00000080;
-
-        ifs.seekg(0);
-        ifs.seekg(xuid_offset);
-        if (!ifs) {
-            return std::nullopt;
-
-        }
-        std::vector<char> buffer;
-        buffer.resize(8);
-
-        size_t i = 0;
-        for (auto &b : buffer) {
-            ifs.read(&buffer.data()[i], 1);
-            if (ifs.fail()) {
-                return std::nullopt;
+        if (fields & FIELD_UTC_TIMESTAMP) {
+            // the description ends with the local time the match started
+            auto local_time = FindTheaterTimestamp(file_data.desc_.view());
+            if (local_time.has_value()) {
+                if constexpr (Layout.duration_offset_ > 0) {
+                    auto duration = details::RegionAt(region, Layout.duration_offset_, 2);
+                    if (!duration.empty()) {
+                        local_time.value() += details::DecodeDuration(duration);
+                    }
+                }
+                file_data.utc_timestamp_ =
+                    clock.ToFileTime(local_time.value()).time_since_epoch().count();
             }
-            ++i;
-        }
 
-        std::reverse(buffer.begin(), buffer.end());
-
-        std::ostringstream ret{};
-        for (const auto &b : buffer) {
-            ret << std::hex << std::setfill('0') << std::setw(2) << (int)((unsigned char)b);
-        }
-        auto tu = [](std::string s) -> std::string {
-            for (auto &c : s)
-                c = toupper(c);
-            return s;
-        };
-        std::string xuid("0x" + tu(ret.str()));
-        return xuid;
-    }
-    virtual std::optional<std::string> ReadTheaterFileAuthor(std::ifstream &ifs) override final {
-        static const unsigned long long author_offset = 0x00000088;
-
-        ifs.seekg(0);
-        ifs.seekg(author_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-
-        std::vector<char> buffer;
-        buffer.resize(16);
-
-        ifs.read(&buffer.data()[0], 16);
-        if (ifs.fail()) {
-            return std::nullopt;
-        }
-        std::string str(buffer.data());
-        return str;
-    }
-    virtual std::optional<std::filesystem::file_time_type> ReadTheaterFileUTCTimestamp(
-        std::ifstream &ifs) override final {
-
-        static const unsigned long long timestamp_offset = 0x00000068; // read at least 128 bytes?
-        static const unsigned long long duration_offset = 0x00000118;  // read two bytes
-
-        ifs.seekg(0);
-        ifs.seekg(duration_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-
-        char buffer[3];
-        buffer[2] = '\0';
-        ifs.read(&buffer[0], 1);
-        if (ifs.fail()) {
-            return std::nullopt;
-        }
-        ifs.read(&buffer[1], 1);
-        if (ifs.fail()) {
-            return std::nullopt;
+            if (!(fields & FIELD_DESC)) {
+                file_data.desc_ = {};
+            }
         }
-        char t = buffer[0];
-        buffer[0] = buffer[1];
-        buffer[1] = t;
-        unsigned char fixed[3];
-        fixed[2] = '\0';
-        if (0 > buffer[0]) {
-            fixed[0] = 128 + abs((-128 + (-1 * buffer[0])));
-        } else
-            fixed[0] = buffer[0];
-        if (0 > buffer[1]) {
-            fixed[1] = 128 + abs((-128 + (-1 * buffer[1])));
-        } else
-            fixed[1] = buffer[1];
 
-        std::ostringstream ret{};
-
-        for (size_t i = 0; i < 2; ++i)
-            ret << std::hex << std::setfill('0') << std::setw(2) << (int)fixed[i];
-
-        // std::cout << "fixed[0]: " << (int)fixed[0] << std::endl;
-        // std::cout << "fixed[1]: " << (int)fixed[1] << std::endl;
-        auto match_length = std::chrono::seconds(strtoul(ret.str().c_str(), NULL, 16));
-
-        ifs.seekg(timestamp_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-        char buffer2[128];
-        ifs.read(buffer2, 128);
-        if (ifs.fail()) {
-            return std::nullopt;
+        if (fields & FIELD_PLAYER_SET) {
+            DecodePlayerSet(region, file_data.player_set_);
         }
-        // ifs.close();
-
-        std::tm tm = {};
-        std::string dirty(buffer2, 128);
-
-        dirty = dirty.substr(dirty.find(','));
-        dirty.replace(0, 2, "");
-
-        std::istringstream ss(dirty);
-
-        ss >> std::get_time(&tm, "%A %B %d, %Y %H:%M:%S");
-        if (ss.fail())
-            return std::nullopt;
-
-        std::time_t local_time = mktime(&tm);
-        int dst = 0;
-        _get_daylight(&dst);
-        // std::cout << "match length: " << match_length << std::endl;
-        std::chrono::seconds dst_offset{dst * 3600};
-        std::chrono::utc_time<std::chrono::seconds> utc(
-            std::chrono::seconds(local_time) + match_length +
-            (std::filesystem::_File_time_clock::_Skipped_filetime_leap_seconds -
-             std::chrono::seconds(GetSystemAccountedLeapSeconds())) -
-            dst_offset);
-
-        return std::chrono::file_clock::from_utc(utc);
     }
 
-    virtual std::optional<std::set<player_info>> ReadTheaterFilePlayerSet(
-        std::ifstream &ifs) override final {
-
-        static const unsigned long long head_offset = 0x0002C3C0;
-
-        ifs.seekg(0);
-        ifs.seekg(head_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-
-        std::set<player_info> player_set;
-
-        int empty_region_count = 0;
-        while (player_set.size() < 16) {
-            bool current_is_empty_region = true;
-            char buf[1];
-            ifs.read(&buf[0], 1);
-            if (ifs.fail()) {
-                return std::nullopt;
-            }
-            if (buf[0] == '\0') {
-                ++empty_region_count;
-                if (empty_region_count >= 2) {
-                    break;
-                }
-            } else {
-                empty_region_count = 0;
-                current_is_empty_region = false;
-            }
-
-            // reset
-            ifs.seekg(-1, std::ios_base::cur);
-            if (!ifs) {
-                return std::nullopt;
-            }
-
-            if (!current_is_empty_region) {
-                // read player name
-                std::vector<char> buffer;
-                buffer.resize(32);
-
-                ifs.read(&buffer.data()[0], 32);
-                if (ifs.fail()) {
-                    return std::nullopt;
-                }
-
-                std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()));
-
-                bool success = false;
-                auto bytes = utility::ConvertWStringToBytes(wstr);
-                if (bytes.has_value()) {
-                    success = true;
-                }
-                char team_buf[1];
-                // go to team
-                ifs.seekg(328 - 72, std::ios_base::cur);
-                if (!ifs) {
-                    return std::nullopt;
-                }
-                ifs.read(&team_buf[0], 1);
-                if (ifs.fail()) {
-                    return std::nullopt;
-                }
-                if (success) {
-                    player_set.insert({team_buf[0], bytes.value()});
-                }
-
-                ifs.seekg(-1, std::ios_base::cur);
-                if (!ifs) {
-                    return std::nullopt;
-                }
-                ifs.seekg(40, std::ios_base::cur);
-                if (!ifs) {
-                    return std::nullopt;
+  private:
+    static void DecodeGameDescription(std::span<const std::byte> region,
+                                      decltype(theater_file_data::desc_) &desc) {
+        auto bytes = details::RegionAt(region, Layout.desc_offset_, Layout.desc_length_);
+        if (bytes.empty()) {
+            return;
+        }
+
+        if constexpr (Layout.desc_encoding_ == description_encoding::UTF16) {
+            details::DecodeWString(bytes, desc);
+        } else {
+            // the ascii description follows the wide gametype after a gap of null bytes
+            bool gap_found = false;
+            for (size_t rel_offset = 0; rel_offset < bytes.size(); rel_offset += 2) {
+                bool is_null = (bytes[rel_offset] == std::byte{0});
+                if ((!gap_found) && is_null) {
+                    gap_found = true;
                 }
-
-            } else {
-                ifs.seekg(328, std::ios_base::cur);
-                if (!ifs) {
-                    return std::nullopt;
+                if (gap_found && !is_null) {
+                    details::DecodeString(bytes.subspan(rel_offset), desc);
+                    return;
                 }
             }
-
-            // skip to next player
         }
-
-        return player_set;
     }
-};
 
-class halo2a_theater_file_reader : public theater_file_reader {
-  private:
-    virtual std::optional<theater_file_data> ReadImpl(const std::filesystem::path &theater_file,
-                                                      std::ifstream &ifs) override final {
-        theater_file_data file_data;
-
-        // No film for campaign
-        auto gametype = this->ReadTheaterFileGameType(ifs);
-        if (gametype.has_value()) {
-            file_data.gametype_ = gametype.value();
-        }
-
-        auto desc = this->ReadTheaterFileGameDescription(ifs);
-        if (desc.has_value()) {
-            file_data.desc_ = desc.value();
-        }
-
-        auto author = this->ReadTheaterFileAuthor(ifs);
-        if (author.has_value()) {
-            file_data.author_ = author.value();
-            file_data.player_set_.insert({-1, file_data.author_});
+    static void DecodePlayerSet(std::span<const std::byte> region,
+                                player_roster &player_set) {
+        size_t offset = Layout.player_table_offset_;
+        if constexpr (Layout.player_table_follows_marker_) {
+            auto table_offset = scanner::FindPlayerTableAfterMarker(
+                region, offset, Layout.player_marker_scan_length_);
+            if (!table_offset.has_value()) {
+                return;
+            }
+            offset = table_offset.value();
         }
 
-        auto xuid = this->ReadTheaterFileAuthorXUID(ifs);
-        if (xuid.has_value()) {
-            file_data.author_xuid_ = xuid.value();
-        }
+        auto scan = scanner::ScanPlayerTable(region, offset, Layout.player_stride_,
+                                             Layout.max_empty_slots_, Layout.max_players_);
 
-        /*
-        auto utc_timestamp = this->ReadTheaterFileUTCTimestamp(ifs);
-        if (utc_timestamp.has_value()) {
-            file_data.utc_timestamp_ = utc_timestamp.value();
-        }
-        */
-        auto player_set = this->ReadTheaterFilePlayerSet(ifs);
-        if (player_set.has_value()) {
-            file_data.player_set_.insert(player_set.value().begin(), player_set.value().end());
+        for (uint64_t occupied = scan.occupied_; occupied != 0; occupied &= occupied - 1) {
+            auto slot = region.subspan(offset + (std::countr_zero(occupied) * Layout.player_stride_),
+                                       Layout.player_stride_);
+            player_info player;
+            player.team_ = static_cast<int8_t>(details::DecodeTeam(slot[Layout.team_offset_]));
+            details::DecodeWString(slot.first(Layout.player_name_length_), player.name_);
+            player_set.insert(player);
         }
-        /*
-        */
-        //can get 
-        ifs.close();
-        return file_data;
-        // if GameType == "", then Discern if its campaign or firefight
-        // could split this into halo3_odst_theater_file_data
     }
-    virtual std::optional<std::string> ReadTheaterFileGameType(std::ifstream &ifs) override final {
-        static const unsigned long long gametype_offset = 0x000000C0;
-
-        ifs.seekg(0);
-        ifs.seekg(gametype_offset);
-
-        if (!ifs) {
-            return std::nullopt;
-        }
-
-        std::vector<char> buffer;
-        buffer.resize(256);
+};
 
-        ifs.read(&buffer.data()[0], 256);
+using halo3_theater_file_reader = theater_file_reader<layouts::halo3>;
+using halo3odst_theater_file_reader = theater_file_reader<layouts::halo3odst>;
+using haloreach_theater_file_reader = theater_file_reader<layouts::haloreach>;
+using halo4_theater_file_reader = theater_file_reader<layouts::halo4>;
+using halo2a_theater_file_reader = theater_file_reader<layouts::halo2a>;
 
-        if (ifs.fail()) {
-            return std::nullopt;
-        }
+namespace details {
 
-        std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()));
+// Covers the whole region of the 0x2000 byte titles, so only Halo 4 engine films read twice
+inline constexpr size_t theater_file_probe_size = layouts::haloreach.region_size_;
 
-        auto bytes = utility::ConvertWStringToBytes(wstr);
-        if (bytes.has_value()) {
-            return bytes.value();
-        }
+template <theater_file_layout Layout>
+std::optional<theater_file_data> ReadProbedTheaterFile(const std::filesystem::path &theater_file,
+                                                       std::vector<std::byte> &region,
+                                                       uint32_t fields,
+                                                       const clock_context &clock) {
+    using reader = theater_file_reader<Layout>;
 
+    // a short probe already holds the whole file
+    if ((region.size() == theater_file_probe_size) &&
+        !ExtendTheaterFileRegion(theater_file, region, reader::GetRegionSize(fields))) {
         return std::nullopt;
     }
-    virtual std::optional<std::string> ReadTheaterFileGameDescription(
-        std::ifstream &ifs) override final {
-        static const unsigned long long desc_offset = 0x000001C0;
-
-        ifs.seekg(0);
-        ifs.seekg(desc_offset);
+    return reader::Read(theater_file, region, fields, clock);
+}
 
-        if (!ifs) {
+} // namespace details
+
+// Reads a theater file of any title, which is told from the header instead of a game_hint.
+// nullopt if the file can't be read or its header isn't a known film header.
+inline std::optional<theater_file_data> ReadAnyTheaterFile(
+    const std::filesystem::path &theater_file, uint32_t fields = FIELD_ALL,
+    const clock_context &clock = clock_context::System()) {
+    try {
+        auto region =
+            details::LoadTheaterFileRegion(theater_file, details::theater_file_probe_size);
+        if (!region.has_value()) {
             return std::nullopt;
         }
 
-        unsigned long long desc_length = 256;
-        std::vector<char> buffer;
-        buffer.resize(desc_length);
-
-        ifs.read(&buffer.data()[0], desc_length);
-
-        if (ifs.fail()) {
+        auto signature = ClassifyTheaterFile(region.value());
+        if (!signature.has_value()) {
             return std::nullopt;
         }
 
-        std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()), buffer.size());
-
-        auto bytes = utility::ConvertWStringToBytes(wstr);
-        if (bytes.has_value()) {
-            return bytes.value();
-        }
-
-        return std::nullopt;
-    }
-    virtual std::optional<std::string> ReadTheaterFileAuthorXUID(
-        std::ifstream &ifs) override final {
-        static const unsigned long long xuid_offset = 0x00000080;
-
-        ifs.seekg(0);
-        ifs.seekg(xuid_offset);
-
-        if (!ifs) {
+        switch (signature->title_) {
+        case mccinfo::game_hint::HALO2A:
+            return details::ReadProbedTheaterFile<layouts::halo2a>(theater_file, region.value(),
+                                                                   fields, clock);
+        case mccinfo::game_hint::HALO3:
+            return details::ReadProbedTheaterFile<layouts::halo3>(theater_file, region.value(),
+                                                                  fields, clock);
+        case mccinfo::game_hint::HALO3ODST:
+            return details::ReadProbedTheaterFile<layouts::halo3odst>(theater_file, region.value(),
+                                                                      fields, clock);
+        case mccinfo::game_hint::HALOREACH:
+            return details::ReadProbedTheaterFile<layouts::haloreach>(theater_file, region.value(),
+                                                                      fields, clock);
+        case mccinfo::game_hint::HALO4:
+            return details::ReadProbedTheaterFile<layouts::halo4>(theater_file, region.value(),
+                                                                  fields, clock);
+        default:
             return std::nullopt;
         }
-
-        std::vector<char> buffer;
-        buffer.resize(8);
-
-        size_t i = 0;
-        for (auto &b : buffer) {
-            ifs.read(&buffer.data()[i], 1);
-            if (ifs.fail()) {
-                return std::nullopt;
-            }
-            ++i;
-        }
-
-        std::reverse(buffer.begin(), buffer.end());
-
-        std::ostringstream ret{};
-        for (const auto &b : buffer) {
-            ret << std::hex << std::setfill('0') << std::setw(2) << (int)((unsigned char)b);
-        }
-        auto tu = [](std::string s) -> std::string {
-            for (auto &c : s)
-                c = toupper(c);
-            return s;
-        };
-        std::string xuid("0x" + tu(ret.str()));
-        return xuid;
     }
-    virtual std::optional<std::string> ReadTheaterFileAuthor(std::ifstream &ifs) override final {
-        static const unsigned long long author_offset = 0x00000088;
-
-        ifs.seekg(0);
-        ifs.seekg(author_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-
-        std::vector<char> buffer;
-        buffer.resize(16);
-
-        if (!ifs) {
-            return std::nullopt;
-        }
-
-        ifs.read(&buffer.data()[0], 16);
-
-        if (ifs.fail()) {
-            return std::nullopt;
-        }
 
-        std::string str(buffer.data());
-        return str;
+    catch (std::exception &e) {
+        std::cout << e.what() << std::endl;
     }
-    virtual std::optional<std::filesystem::file_time_type> ReadTheaterFileUTCTimestamp(
-        std::ifstream &ifs) override final {
-
-        static const unsigned long long timestamp_offset = 0x00000068; // read at least 128 bytes?
-        static const unsigned long long duration_offset = 0x00000118;  // read two bytes
-
-        ifs.seekg(0);
-        ifs.seekg(duration_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-
-
-        char buffer[3];
-        buffer[2] = '\0';
-        ifs.read(&buffer[0], 1);
-        if (ifs.fail()) {
-            return std::nullopt;
-        }
-        ifs.read(&buffer[1], 1);
-        if (ifs.fail()) {
-            return std::nullopt;
-        }
-        char t = buffer[0];
-        buffer[0] = buffer[1];
-        buffer[1] = t;
-        unsigned char fixed[3];
-        fixed[2] = '\0';
-        if (0 > buffer[0]) {
-            fixed[0] = 128 + abs((-128 + (-1 * buffer[0])));
-        } else
-            fixed[0] = buffer[0];
-        if (0 > buffer[1]) {
-            fixed[1] = 128 + abs((-128 + (-1 * buffer[1])));
-        } else
-            fixed[1] = buffer[1];
-
-        std::ostringstream ret{};
-
-        for (size_t i = 0; i < 2; ++i)
-            ret << std::hex << std::setfill('0') << std::setw(2) << (int)fixed[i];
-
-        // std::cout << "fixed[0]: " << (int)fixed[0] << std::endl;
-        // std::cout << "fixed[1]: " << (int)fixed[1] << std::endl;
-        auto match_length = std::chrono::seconds(strtoul(ret.str().c_str(), NULL, 16));
-
-        ifs.seekg(timestamp_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-
-        char buffer2[128];
-        ifs.read(buffer2, 128);
-
-        if (ifs.fail()) {
-            return std::nullopt;
-        }
-        // ifs.close();
-
-        std::tm tm = {};
-        std::string dirty(buffer2, 128);
-
-        dirty = dirty.substr(dirty.find(','));
-        dirty.replace(0, 2, "");
-
-        std::istringstream ss(dirty);
 
-        ss >> std::get_time(&tm, "%A %B %d, %Y %H:%M:%S");
-        if (ss.fail())
-            return std::nullopt;
-
-        std::time_t local_time = mktime(&tm);
-        int dst = 0;
-        _get_daylight(&dst);
-        // std::cout << "match length: " << match_length << std::endl;
-        std::chrono::seconds dst_offset{dst * 3600};
-        std::chrono::utc_time<std::chrono::seconds> utc(
-            std::chrono::seconds(local_time) + match_length +
-            (std::filesystem::_File_time_clock::_Skipped_filetime_leap_seconds -
-             std::chrono::seconds(GetSystemAccountedLeapSeconds())) -
-            dst_offset);
+    return std::nullopt;
+}
 
-        return std::chrono::file_clock::from_utc(utc);
+// ReadAnyTheaterFile for a film held in a byte_source instead of on disk
+template <byte_source Source>
+std::optional<theater_file_data> ReadAnyTheaterFile(
+    const std::filesystem::path &theater_file, const Source &source, uint32_t fields = FIELD_ALL,
+    const clock_context &clock = clock_context::System()) {
+    std::byte header[theater_file_signature_size];
+    auto signature = ClassifyTheaterFile(std::span(header, source.Read(0, header)));
+    if (!signature.has_value()) {
+        return std::nullopt;
     }
 
-    virtual std::optional<std::set<player_info>> ReadTheaterFilePlayerSet(
-        std::ifstream &ifs) override final {
-
-        static const unsigned long long head_offset = 0x0002C3C0;
-
-        ifs.seekg(0);
-        ifs.seekg(head_offset);
-        if (!ifs) {
-            return std::nullopt;
-        }
-        std::set<player_info> player_set;
-
-        int empty_region_count = 0;
-        while (player_set.size() < 16) {
-            bool current_is_empty_region = true;
-            char buf[1];
-            ifs.read(&buf[0], 1);
-
-            if (ifs.fail()) {
-                return std::nullopt;
-            }
-
-            if (buf[0] == '\0') {
-                ++empty_region_count;
-                if (empty_region_count >= 2) {
-                    break;
-                }
-            } else {
-                empty_region_count = 0;
-                current_is_empty_region = false;
-            }
-
-            // reset
-            ifs.seekg(-1, std::ios_base::cur);
-            if (!ifs) {
-                return std::nullopt;
-            }
-            if (!current_is_empty_region) {
-                // read player name
-                std::vector<char> buffer;
-                buffer.resize(32);
-
-                ifs.read(&buffer.data()[0], 32);
-
-                if (ifs.fail()) {
-                    return std::nullopt;
-                }
-
-                std::wstring wstr(reinterpret_cast<const wchar_t *>(buffer.data()));
-
-                bool success = false;
-                auto bytes = utility::ConvertWStringToBytes(wstr);
-                if (bytes.has_value()) {
-                    success = true;
-                }
-                char team_buf[1];
-                // go to team
-                ifs.seekg(328 - 72, std::ios_base::cur);
-                if (!ifs) {
-                    return std::nullopt;
-                }
-                ifs.read(&team_buf[0], 1);
-                if (ifs.fail()) {
-                    return std::nullopt;
-                }
-                if (success) {
-                    player_set.insert({team_buf[0], bytes.value()});
-                }
-
-                ifs.seekg(-1, std::ios_base::cur);
-                if (!ifs) {
-                    return std::nullopt;
-                }
-                ifs.seekg(40, std::ios_base::cur);
-                if (!ifs) {
-                    return std::nullopt;
-                }
-
-            } else {
-                ifs.seekg(328, std::ios_base::cur);
-                if (!ifs) {
-                    return std::nullopt;
-                }
-            }
-
-            // skip to next player
-        }
-
-        return player_set;
+    switch (signature->title_) {
+    case mccinfo::game_hint::HALO2A:
+        return halo2a_theater_file_reader::Read(theater_file, source, fields, clock);
+    case mccinfo::game_hint::HALO3:
+        return halo3_theater_file_reader::Read(theater_file, source, fields, clock);
+    case mccinfo::game_hint::HALO3ODST:
+        return halo3odst_theater_file_reader::Read(theater_file, source, fields, clock);
+    case mccinfo::game_hint::HALOREACH:
+        return haloreach_theater_file_reader::Read(theater_file, source, fields, clock);
+    case mccinfo::game_hint::HALO4:
+        return halo4_theater_file_reader::Read(theater_file, source, fields, clock);
+    default:
+        return std::nullopt;
     }
-};
+}
 
+// The header decides the title when it can, so a film filed under the wrong title still decodes;
+// hint is only used for files ClassifyTheaterFile doesn't recognize
 inline theater_file_data ReadTheaterFile(
-    const std::filesystem::path &theater_file, mccinfo::game_hint hint) {
+    const std::filesystem::path &theater_file, mccinfo::game_hint hint,
+    uint32_t fields = FIELD_ALL, const clock_context &clock = clock_context::System()) {
     // theater_file_timestamp.str("");
     theater_file_data file_data;
 
     if (std::filesystem::file_size(theater_file) > 0) {
-        switch (hint) {
-        case mccinfo::game_hint::HALO2A: {
-            mccinfo::file_readers::halo2a_theater_file_reader reader;
-            auto file_data_query = reader.Read(theater_file);
-            if (file_data_query.has_value()) {
-                file_data = file_data_query.value();
-                // theater_file_timestamp << file_data.utc_timestamp_;
-            }
-            break;
-        }
-        case mccinfo::game_hint::HALO3: {
-            mccinfo::file_readers::halo3_theater_file_reader reader;
-            auto file_data_query = reader.Read(theater_file);
-            if (file_data_query.has_value()) {
-                file_data = file_data_query.value();
-                // theater_file_timestamp << file_data.utc_timestamp_;
-            }
-            break;
-        }
-        case mccinfo::game_hint::HALOREACH: {
-            mccinfo::file_readers::haloreach_theater_file_reader reader;
-            auto file_data_query = reader.Read(theater_file);
-            if (file_data_query.has_value()) {
-                file_data = file_data_query.value();
-                // theater_file_timestamp << file_data.utc_timestamp_;
-            }
-            break;
-        }
-        case mccinfo::game_hint::HALO4: {
-            mccinfo::file_readers::halo4_theater_file_reader reader;
-            auto file_data_query = reader.Read(theater_file);
-            if (file_data_query.has_value()) {
-                file_data = file_data_query.value();
-                // theater_file_timestamp << file_data.utc_timestamp_;
+        std::optional<theater_file_data> file_data_query =
+            ReadAnyTheaterFile(theater_file, fields, clock);
+        if (!file_data_query.has_value()) {
+            switch (hint) {
+            case mccinfo::game_hint::HALO2A:
+                file_data_query = halo2a_theater_file_reader::Read(theater_file, fields, clock);
+                break;
+            case mccinfo::game_hint::HALO3:
+                file_data_query = halo3_theater_file_reader::Read(theater_file, fields, clock);
+                break;
+            case mccinfo::game_hint::HALO3ODST:
+                file_data_query = halo3odst_theater_file_reader::Read(theater_file, fields, clock);
+                break;
+            case mccinfo::game_hint::HALOREACH:
+                file_data_query = haloreach_theater_file_reader::Read(theater_file, fields, clock);
+                break;
+            case mccinfo::game_hint::HALO4:
+                file_data_query = halo4_theater_file_reader::Read(theater_file, fields, clock);
+                break;
+            default:
+                break;
             }
-            break;
         }
-        default:
-            break;
+
+        if (file_data_query.has_value()) {
+            file_data = std::move(file_data_query.value());
+            // theater_file_timestamp << file_data.utc_timestamp_;
         }
     } else {
         MI_CORE_WARN("ReadTheaterFile() called with an empty theater file: {0}",
@@ -1350,4 +470,4 @@ inline theater_file_data ReadTheaterFile(
 }
 
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "mccinfo/core/mapped_file.hpp"
+
+namespace mccinfo {
+namespace file_readers {
+
+/**
+ * @brief Random access bytes of a theater file that is not (or not only) on disk: a buffer
+ * received over IPC, a memory map, or the segments of an archive.
+ *
+ * View returns the bytes in place when they are contiguous in the source and nullopt otherwise;
+ * Read copies and returns how many bytes were available. Decoders View first, so contiguous
+ * sources are decoded with no copy at all.
+ */
+template <typename T>
+concept byte_source = requires(const T &source, size_t offset, size_t count,
+                               std::span<std::byte> dst) {
+    { source.size() } -> std::convertible_to<size_t>;
+    { source.View(offset, count) } -> std::same_as<std::optional<std::span<const std::byte>>>;
+    { source.Read(offset, dst) } -> std::convertible_to<size_t>;
+};
+
+// A contiguous buffer owned by the caller
+class buffer_source {
+  public:
+    buffer_source() = default;
+    explicit buffer_source(std::span<const std::byte> bytes) : bytes_(bytes) {
+    }
+
+    size_t size() const {
+        return bytes_.size();
+    }
+
+    std::optional<std::span<const std::byte>> View(size_t offset, size_t count) const {
+        if (offset > bytes_.size()) {
+            return std::span<const std::byte>();
+        }
+        return bytes_.subspan(offset, std::min(count, bytes_.size() - offset));
+    }
+
+    size_t Read(size_t offset, std::span<std::byte> dst) const {
+        auto view = View(offset, dst.size()).value();
+        std::copy(view.begin(), view.end(), dst.begin());
+        return view.size();
+    }
+
+  private:
+    std::span<const std::byte> bytes_;
+};
+
+// A read only memory map of a theater file
+class mapped_source {
+  public:
+    bool Open(const std::filesystem::path &theater_file) {
+        return map_.open(theater_file);
+    }
+
+    size_t size() const {
+        return map_.size();
+    }
+
+    std::optional<std::span<const std::byte>> View(size_t offset, size_t count) const {
+        return buffer_source(map_.bytes()).View(offset, count);
+    }
+
+    size_t Read(size_t offset, std::span<std::byte> dst) const {
+        return buffer_source(map_.bytes()).Read(offset, dst);
+    }
+
+  private:
+    core::mapped_file map_;
+};
+
+// Consecutive chunks, e.g. decompressed archive blocks or shared memory pages; not owned
+class chunked_source {
+  public:
+    chunked_source() = default;
+    explicit chunked_source(std::vector<std::span<const std::byte>> chunks)
+        : chunks_(std::move(chunks)) {
+        starts_.reserve(chunks_.size());
+        for (const auto &chunk : chunks_) {
+            starts_.push_back(size_);
+            size_ += chunk.size();
+        }
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    // In place only when [offset, offset + count) lies inside a single chunk
+    std::optional<std::span<const std::byte>> View(size_t offset, size_t count) const {
+        if (offset >= size_) {
+            return std::span<const std::byte>();
+        }
+        count = std::min(count, size_ - offset);
+
+        size_t index = ChunkAt(offset);
+        size_t rel_offset = offset - starts_[index];
+        if ((chunks_[index].size() - rel_offset) < count) {
+            return std::nullopt;
+        }
+        return chunks_[index].subspan(rel_offset, count);
+    }
+
+    size_t Read(size_t offset, std::span<std::byte> dst) const {
+        size_t copied = 0;
+        while ((copied < dst.size()) && ((offset + copied) < size_)) {
+            size_t index = ChunkAt(offset + copied);
+            auto chunk = chunks_[index].subspan(offset + copied - starts_[index]);
+            size_t count = std::min(chunk.size(), dst.size() - copied);
+            std::memcpy(dst.data() + copied, chunk.data(), count);
+            copied += count;
+        }
+        return copied;
+    }
+
+  private:
+    // Index of the chunk holding offset, which must be < size_. Empty chunks share their start
+    // with the next chunk, so the last start <= offset is never one of them.
+    size_t ChunkAt(size_t offset) const {
+        auto it = std::upper_bound(starts_.begin(), starts_.end(), offset);
+        return static_cast<size_t>(it - starts_.begin()) - 1;
+    }
+
+    std::vector<std::span<const std::byte>> chunks_;
+    std::vector<size_t> starts_;
+    size_t size_ = 0;
+};
+
+namespace details {
+
+// The leading region_size bytes of source, in place if possible and copied into scratch if not
+template <byte_source Source>
+std::span<const std::byte> SourceRegion(const Source &source, size_t region_size,
+                                        std::vector<std::byte> &scratch) {
+    auto view = source.View(0, region_size);
+    if (view.has_value()) {
+        return view.value();
+    }
+
+    scratch.resize(std::min(region_size, static_cast<size_t>(source.size())));
+    scratch.resize(source.Read(0, scratch));
+    return scratch;
+}
+
+} // namespace details
+
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,928 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <frozen/unordered_map.h>
+
+#include "mccinfo/core/mapped_file.hpp"
+#include "mccinfo/file_readers/scanner.hpp"
+#include "mccinfo/file_readers/theater_file_data.hpp"
+
+namespace mccinfo {
+namespace file_readers {
+
+// Integer attributes of a carnage report <Player>, one column each
+enum class carnage_player_stat : uint8_t {
+    GAME_MODE,
+    EMBLEM_TEXTURE0,
+    EMBLEM_TEXTURE1,
+    EMBLEM_COLOR0,
+    EMBLEM_COLOR1,
+    EMBLEM_COLOR2,
+    NAMEPLATE,
+    AVATAR,
+    TEAM_ID,
+    SCORE,
+    STANDING,
+    TOTAL_MEDAL_COUNT,
+    KILLS,
+    DEATHS,
+    ASSISTS,
+    BETRAYALS,
+    SUICIDES,
+    MOST_KILLS_IN_A_ROW,
+    SECONDS_ALIVE,
+    KILLS_WEAPON,
+    KILLS_GRENADE,
+    KILLS_MELEE,
+    KILLS_OTHER,
+    COMPLETED_GAME,
+    SECONDS_PLAYED,
+    KILLED_MOST_PLAYER_INDEX,
+    KILLED_MOST_PLAYER_COUNT,
+    MOST_KILLED_BY_PLAYER_INDEX,
+    MOST_KILLED_BY_PLAYER_COUNT,
+    MOST_USED_WEAPON,
+    MOST_USED_WEAPON_COUNT,
+    COUNT,
+};
+
+// Text attributes of a carnage report <Player>, one column each
+enum class carnage_player_text : uint8_t {
+    GAMERTAG,
+    CLANTAG,
+    SERVICE_ID,
+    COUNT,
+};
+
+namespace details {
+
+enum class player_attribute_kind : uint8_t {
+    XUID,
+    GUEST,
+    STAT,
+    TEXT,
+};
+
+struct player_attribute {
+    player_attribute_kind kind_ = player_attribute_kind::STAT;
+    uint8_t column_ = 0;
+};
+
+// Mixes the length and last eight characters of a name, which tell every attribute name apart;
+// at run time that is one unaligned load rather than a loop over the name
+struct attribute_name_hash {
+    constexpr size_t operator()(std::string_view name, size_t seed) const {
+        uint64_t tail = 0;
+        size_t tail_size = std::min<size_t>(name.size(), 8);
+        if (!std::is_constant_evaluated() && (tail_size == 8) &&
+            (std::endian::native == std::endian::little)) {
+            std::memcpy(&tail, name.data() + name.size() - 8, 8);
+        } else {
+            for (size_t i = 0; i < tail_size; ++i) {
+                auto c = static_cast<unsigned char>(name[name.size() - tail_size + i]);
+                tail |= static_cast<uint64_t>(c) << (8 * i);
+            }
+        }
+        uint64_t x = (tail + (name.size() * 0x100000001B3ULL)) ^ seed;
+        x *= 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(x ^ (x >> 29));
+    }
+};
+
+template <typename Column>
+constexpr std::pair<std::string_view, player_attribute> Attribute(std::string_view name,
+                                                                  Column column) {
+    constexpr auto kind = std::is_same_v<Column, carnage_player_stat>
+                              ? player_attribute_kind::STAT
+                              : player_attribute_kind::TEXT;
+    return {name, {kind, static_cast<uint8_t>(column)}};
+}
+
+// Attribute name -> column, resolved with one perfect hash probe
+inline constexpr frozen::unordered_map<std::string_view, player_attribute, 36, attribute_name_hash>
+    player_attributes = {
+    {"mXboxUserId", {player_attribute_kind::XUID, 0}},
+    {"isGuest", {player_attribute_kind::GUEST, 0}},
+    Attribute("mGameMode", carnage_player_stat::GAME_MODE),
+    Attribute("mGamertagText", carnage_player_text::GAMERTAG),
+    Attribute("ClantagText", carnage_player_text::CLANTAG),
+    Attribute("EmblemTexture0", carnage_player_stat::EMBLEM_TEXTURE0),
+    Attribute("EmblemTexture1", carnage_player_stat::EMBLEM_TEXTURE1),
+    Attribute("EmblemColor0", carnage_player_stat::EMBLEM_COLOR0),
+    Attribute("EmblemColor1", carnage_player_stat::EMBLEM_COLOR1),
+    Attribute("EmblemColor2", carnage_player_stat::EMBLEM_COLOR2),
+    Attribute("Nameplate", carnage_player_stat::NAMEPLATE),
+    Attribute("Avatar", carnage_player_stat::AVATAR),
+    Attribute("ServiceId", carnage_player_text::SERVICE_ID),
+    Attribute("mTeamId", carnage_player_stat::TEAM_ID),
+    Attribute("Score", carnage_player_stat::SCORE),
+    Attribute("mStanding", carnage_player_stat::STANDING),
+    Attribute("mTotalMedalCount", carnage_player_stat::TOTAL_MEDAL_COUNT),
+    Attribute("mKills", carnage_player_stat::KILLS),
+    Attribute("mDeaths", carnage_player_stat::DEATHS),
+    Attribute("mAssists", carnage_player_stat::ASSISTS),
+    Attribute("mBetrayals", carnage_player_stat::BETRAYALS),
+    Attribute("mSuicides", carnage_player_stat::SUICIDES),
+    Attribute("mMostKillsInARow", carnage_player_stat::MOST_KILLS_IN_A_ROW),
+    Attribute("mSecondsAlive", carnage_player_stat::SECONDS_ALIVE),
+    Attribute("mKillsWeapon", carnage_player_stat::KILLS_WEAPON),
+    Attribute("mKillsGrenade", carnage_player_stat::KILLS_GRENADE),
+    Attribute("mKillsMelee", carnage_player_stat::KILLS_MELEE),
+    Attribute("mKillsOther", carnage_player_stat::KILLS_OTHER),
+    Attribute("mCompletedGame", carnage_player_stat::COMPLETED_GAME),
+    Attribute("mSecondsPlayed", carnage_player_stat::SECONDS_PLAYED),
+    Attribute("mKilledMostPlayerIndex", carnage_player_stat::KILLED_MOST_PLAYER_INDEX),
+    Attribute("mKilledMostPlayerCount", carnage_player_stat::KILLED_MOST_PLAYER_COUNT),
+    Attribute("mMostKilledByPlayerIndex", carnage_player_stat::MOST_KILLED_BY_PLAYER_INDEX),
+    Attribute("mMostKilledByPlayerCount", carnage_player_stat::MOST_KILLED_BY_PLAYER_COUNT),
+    Attribute("mMostUsedWeapon", carnage_player_stat::MOST_USED_WEAPON),
+    Attribute("mMostUsedWeaponCount", carnage_player_stat::MOST_USED_WEAPON_COUNT),
+};
+
+// Nullopt unless all of value is a number that fits Int
+template <typename Int>
+std::optional<Int> ParseInt(std::string_view value, int base = 10) {
+    Int result = 0;
+    const char *end = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(value.data(), end, result, base);
+    if ((ec != std::errc()) || (ptr != end)) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+inline std::optional<uint64_t> ParseXUID(std::string_view value) {
+    if ((value.size() > 2) && (value[0] == '0') && ((value[1] == 'x') || (value[1] == 'X'))) {
+        value.remove_prefix(2);
+    }
+    return ParseInt<uint64_t>(value, 16);
+}
+
+inline bool ParseBool(std::string_view value) {
+    return (value == "true") || (value == "1");
+}
+
+// The code point of a "#67" or "#x43" entity
+inline std::optional<uint32_t> CharacterReference(std::string_view entity) {
+    if (!entity.starts_with("#")) {
+        return std::nullopt;
+    }
+    bool hex = entity.starts_with("#x");
+    return ParseInt<uint32_t>(entity.substr(hex ? 2 : 1), hex ? 16 : 10);
+}
+
+} // namespace details
+
+/**
+ * @brief Everything outside <Players> in a carnage report. Text is as written in the file, with
+ * entities still escaped; see UnescapeXML.
+ */
+struct carnage_report_header {
+    int32_t game_enum_ = 0;
+    bool is_matchmaking_ = false;
+    bool has_network_members_in_party_ = false;
+    int32_t party_size_ = 0;
+    bool last_match_incomplete_ = false;
+    bool is_teams_enabled_ = false;
+    int64_t hopper_id_ = 0;
+    std::string_view hopper_name_;
+    std::string_view gametype_name_;
+    std::string_view game_unique_id_;
+};
+
+/**
+ * @brief A parsed carnage report, one column per player attribute. Text columns view the parsed
+ * buffer, which the report keeps mapped or copied when it was read from a file.
+ *
+ * Custom stats and medals are stored flat, leaving out blank custom stats and medals with a count
+ * of 0; player i owns the entries from its begin offset up to player i + 1's.
+ */
+struct carnage_report {
+    carnage_report_header header_;
+
+    std::vector<uint64_t> xbox_user_id_;
+    std::vector<uint8_t> is_guest_;
+    std::array<std::vector<int32_t>, static_cast<size_t>(carnage_player_stat::COUNT)> stats_;
+    std::array<std::vector<std::string_view>, static_cast<size_t>(carnage_player_text::COUNT)>
+        texts_;
+
+    std::vector<uint32_t> custom_stats_begin_;
+    std::vector<std::string_view> custom_stat_names_;
+    std::vector<std::string_view> custom_stat_values_;
+
+    std::vector<uint32_t> medals_begin_;
+    std::vector<uint16_t> medal_ids_;
+    std::vector<int32_t> medal_counts_;
+
+    // Numeric attributes that weren't a number of their column's type; each kept its default, as
+    // if the attribute were missing
+    uint32_t malformed_values_ = 0;
+
+    // What the text columns view: a mapping of the file, or a copy of it
+    core::mapped_file source_;
+    std::vector<char> text_;
+
+    size_t PlayerCount() const {
+        return xbox_user_id_.size();
+    }
+
+    std::span<const int32_t> Stat(carnage_player_stat stat) const {
+        return stats_[static_cast<size_t>(stat)];
+    }
+    int32_t Stat(carnage_player_stat stat, size_t player) const {
+        return stats_[static_cast<size_t>(stat)][player];
+    }
+    std::string_view Text(carnage_player_text text, size_t player) const {
+        return texts_[static_cast<size_t>(text)][player];
+    }
+
+    std::span<const std::string_view> CustomStatNames(size_t player) const {
+        return Entries(custom_stat_names_, custom_stats_begin_, player);
+    }
+    std::span<const std::string_view> CustomStatValues(size_t player) const {
+        return Entries(custom_stat_values_, custom_stats_begin_, player);
+    }
+    std::span<const uint16_t> MedalIds(size_t player) const {
+        return Entries(medal_ids_, medals_begin_, player);
+    }
+    std::span<const int32_t> MedalCounts(size_t player) const {
+        return Entries(medal_counts_, medals_begin_, player);
+    }
+
+    // 0 if the player has no entry for medal_id
+    int32_t MedalCount(size_t player, uint16_t medal_id) const {
+        auto ids = MedalIds(player);
+        auto counts = MedalCounts(player);
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (ids[i] == medal_id) {
+                return counts[i];
+            }
+        }
+        return 0;
+    }
+
+    void Clear() {
+        header_ = {};
+        xbox_user_id_.clear();
+        is_guest_.clear();
+        for (auto &column : stats_) {
+            column.clear();
+        }
+        for (auto &column : texts_) {
+            column.clear();
+        }
+        custom_stats_begin_.clear();
+        custom_stat_names_.clear();
+        custom_stat_values_.clear();
+        medals_begin_.clear();
+        medal_ids_.clear();
+        medal_counts_.clear();
+        malformed_values_ = 0;
+    }
+
+  private:
+    template <typename T>
+    static std::span<const T> Entries(const std::vector<T> &entries,
+                                      const std::vector<uint32_t> &begins, size_t player) {
+        size_t begin = begins[player];
+        size_t end = ((player + 1) < begins.size()) ? begins[player + 1] : entries.size();
+        return std::span<const T>(entries).subspan(begin, end - begin);
+    }
+};
+
+namespace details {
+
+// Players in a 16 player match; columns grow past it if a report has more
+inline constexpr size_t carnage_report_reserve_players = 16;
+
+// Finds the '"' and '>' characters of a start tag a block at a time, keeping the block's match
+// mask between calls so consecutive delimiters cost a bit scan rather than another search
+class tag_scanner {
+  public:
+    explicit tag_scanner(const char *end) : end_(end) {
+    }
+
+    // First '"' or '>' at or after p, which never moves backwards between calls; nullptr if none
+    const char *Next(const char *p) {
+        if (p < block_end_) {
+            uint64_t mask = mask_ & (~uint64_t(0) << (p - block_));
+            if (mask != 0) {
+                return block_ + std::countr_zero(mask);
+            }
+            p = block_end_;
+        }
+
+#if defined(MCCINFO_SCANNER_AVX2)
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i gt = _mm256_set1_epi8('>');
+        for (; (end_ - p) >= 32; p += 32) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            __m256i found =
+                _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, gt));
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(found));
+            if (mask != 0) {
+                return Found(p, 32, mask);
+            }
+        }
+#elif defined(MCCINFO_SCANNER_SSE2)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i gt = _mm_set1_epi8('>');
+        for (; (end_ - p) >= 16; p += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            __m128i found = _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, gt));
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(found));
+            if (mask != 0) {
+                return Found(p, 16, mask);
+            }
+        }
+#endif
+        block_end_ = nullptr;
+        for (; p < end_; ++p) {
+            if ((*p == '"') || (*p == '>')) {
+                return p;
+            }
+        }
+        return nullptr;
+    }
+
+  private:
+    const char *Found(const char *block, size_t width, uint64_t mask) {
+        block_ = block;
+        block_end_ = block + width;
+        mask_ = mask;
+        return block + std::countr_zero(mask);
+    }
+
+    const char *end_;
+    const char *block_ = nullptr;
+    const char *block_end_ = nullptr;
+    uint64_t mask_ = 0;
+};
+
+class carnage_report_parser {
+  public:
+    explicit carnage_report_parser(carnage_report &report) : report_(report) {
+    }
+
+    // Single forward pass over xml; true if the root element was closed
+    bool Parse(std::string_view xml) {
+        Reserve();
+
+        const char *p = xml.data();
+        const char *end = p + xml.size();
+
+        size_t depth = 0;
+        std::string_view root;
+
+        while (true) {
+            p = static_cast<const char *>(std::memchr(p, '<', static_cast<size_t>(end - p)));
+            if (p == nullptr) {
+                return false;
+            }
+            if (++p == end) {
+                return false;
+            }
+
+            if ((*p == '?') || (*p == '!')) {
+                p = SkipMarkup(p, end);
+                if (p == nullptr) {
+                    return false;
+                }
+                continue;
+            }
+
+            if (*p == '/') {
+                auto name = ReadName(++p, end);
+                if ((depth == 0) || (name.empty())) {
+                    return false;
+                }
+                if (name == "Player") {
+                    in_player_ = false;
+                }
+                if (--depth == 0) {
+                    return (name == root);
+                }
+                continue;
+            }
+
+            auto name = ReadName(p, end);
+            if (name.empty()) {
+                return false;
+            }
+
+            auto kind = Classify(name);
+            if (kind == element_kind::PLAYER) {
+                BeginPlayer();
+            } else if ((kind == element_kind::CUSTOM_STAT) && in_player_) {
+                report_.custom_stat_names_.emplace_back();
+                report_.custom_stat_values_.emplace_back();
+            } else if ((kind == element_kind::MEDAL) && in_player_) {
+                if (ReadMedal(p, end)) {
+                    continue;
+                }
+                report_.medal_ids_.emplace_back();
+                report_.medal_counts_.emplace_back();
+            }
+
+            bool self_closing = false;
+            bool read = (kind == element_kind::PLAYER) &&
+                        ReadPlayerAttributes(p, end, self_closing);
+            if (!read && !ReadAttributes(p, end, kind, self_closing)) {
+                return false;
+            }
+            if (in_player_) {
+                DropEmptyEntry(kind);
+            }
+
+            if (!self_closing) {
+                if (depth == 0) {
+                    root = name;
+                }
+                ++depth;
+            }
+        }
+    }
+
+  private:
+    enum class element_kind {
+        OTHER,
+        PLAYER,
+        CUSTOM_STAT,
+        MEDAL,
+    };
+
+    static element_kind Classify(std::string_view name) {
+        if (name == "Medal") {
+            return element_kind::MEDAL;
+        }
+        if (name == "Player") {
+            return element_kind::PLAYER;
+        }
+        if (name == "CustomStat") {
+            return element_kind::CUSTOM_STAT;
+        }
+        return element_kind::OTHER;
+    }
+
+    static bool IsSpace(char c) {
+        return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+    }
+
+    static bool IsNameEnd(char c) {
+        return IsSpace(c) || (c == '/') || (c == '>') || (c == '=');
+    }
+
+    static std::string_view ReadName(const char *&p, const char *end) {
+        const char *begin = p;
+        while ((p < end) && !IsNameEnd(*p)) {
+            ++p;
+        }
+        return std::string_view(begin, static_cast<size_t>(p - begin));
+    }
+
+    // Past the end of <?...?>, <!-- ... --> or <!...>, starting after the '<'
+    static const char *SkipMarkup(const char *p, const char *end) {
+        std::string_view rest(p, static_cast<size_t>(end - p));
+        size_t close = rest.starts_with("!--") ? rest.find("-->", 3) : rest.find('>');
+        if (close == std::string_view::npos) {
+            return nullptr;
+        }
+        return p + close + (rest.starts_with("!--") ? 3 : 1);
+    }
+
+    // Reads name="value" pairs up to and past the closing '>' of the start tag at p
+    bool ReadAttributes(const char *&p, const char *end, element_kind kind, bool &self_closing) {
+        while (true) {
+            while ((p < end) && IsSpace(*p)) {
+                ++p;
+            }
+            if (p == end) {
+                return false;
+            }
+            if (*p == '>') {
+                ++p;
+                return true;
+            }
+            if (*p == '/') {
+                if (((p + 1) == end) || (p[1] != '>')) {
+                    return false;
+                }
+                p += 2;
+                self_closing = true;
+                return true;
+            }
+
+            auto name = ReadName(p, end);
+            while ((p < end) && IsSpace(*p)) {
+                ++p;
+            }
+            if (name.empty() || (p == end) || (*p != '=')) {
+                return false;
+            }
+            ++p;
+            while ((p < end) && IsSpace(*p)) {
+                ++p;
+            }
+            if ((p == end) || ((*p != '"') && (*p != '\''))) {
+                return false;
+            }
+
+            char quote = *p++;
+            auto close =
+                static_cast<const char *>(std::memchr(p, quote, static_cast<size_t>(end - p)));
+            if (close == nullptr) {
+                return false;
+            }
+            OnAttribute(kind, name, std::string_view(p, static_cast<size_t>(close - p)));
+            p = close + 1;
+        }
+    }
+
+    // A <Player> start tag as MCC writes it: name="value" pairs separated by whitespace. Names and
+    // values are cut at the delimiters the scanner finds, so no byte is looked at twice; anything
+    // else (other quoting, spaces around '=') leaves p alone for the generic reader. The pairs
+    // read before giving up are read again there; their columns are just overwritten, but any
+    // value that failed to parse would be counted twice, so the count is put back.
+    bool ReadPlayerAttributes(const char *&p, const char *end, bool &self_closing) {
+        tag_scanner delimiters(end);
+        const char *q = p;
+        uint32_t malformed_values = report_.malformed_values_;
+        auto fall_back = [&] {
+            report_.malformed_values_ = malformed_values;
+            return false;
+        };
+        while (true) {
+            while ((q < end) && IsSpace(*q)) {
+                ++q;
+            }
+            if (q == end) {
+                return fall_back();
+            }
+            if ((*q == '>') || (*q == '/')) {
+                if ((*q == '/') && (((q + 1) == end) || (q[1] != '>'))) {
+                    return fall_back();
+                }
+                self_closing = (*q == '/');
+                p = q + (self_closing ? 2 : 1);
+                return true;
+            }
+
+            // a '>' before the opening quote means the tag ended mid attribute
+            const char *open = delimiters.Next(q);
+            if ((open == nullptr) || (*open != '"') || (open < (q + 2)) || (open[-1] != '=')) {
+                return fall_back();
+            }
+            // values may hold a '>'
+            const char *close = delimiters.Next(open + 1);
+            while ((close != nullptr) && (*close == '>')) {
+                close = delimiters.Next(close + 1);
+            }
+            if (close == nullptr) {
+                return fall_back();
+            }
+
+            // a malformed name (e.g. holding a space) matches no column and is skipped
+            std::string_view name(q, static_cast<size_t>(open - 1 - q));
+            std::string_view value(open + 1, static_cast<size_t>(close - open - 1));
+            OnPlayerAttribute(name, value);
+            q = close + 1;
+        }
+    }
+
+    // Medals are most of a report; read the exact form MCC writes, <Medal mId="1" mCount="2"/>,
+    // without the generic attribute loop. Leaves p alone if the element has any other form.
+    bool ReadMedal(const char *&p, const char *end) {
+        constexpr std::string_view id_prefix = " mId=\"";
+        constexpr std::string_view count_prefix = "\" mCount=\"";
+        constexpr std::string_view suffix = "\"/>";
+
+        auto expect = [end](const char *at, std::string_view literal) -> const char * {
+            if ((static_cast<size_t>(end - at) < literal.size()) ||
+                (std::memcmp(at, literal.data(), literal.size()) != 0)) {
+                return nullptr;
+            }
+            return at + literal.size();
+        };
+
+        uint16_t id = 0;
+        int32_t count = 0;
+        const char *q = expect(p, id_prefix);
+        if (q == nullptr) {
+            return false;
+        }
+        auto id_result = std::from_chars(q, end, id);
+        if ((id_result.ec != std::errc()) ||
+            ((q = expect(id_result.ptr, count_prefix)) == nullptr)) {
+            return false;
+        }
+        auto count_result = std::from_chars(q, end, count);
+        if ((count_result.ec != std::errc()) ||
+            ((q = expect(count_result.ptr, suffix)) == nullptr)) {
+            return false;
+        }
+
+        if (count != 0) {
+            report_.medal_ids_.push_back(id);
+            report_.medal_counts_.push_back(count);
+        }
+        p = q;
+        return true;
+    }
+
+    void OnAttribute(element_kind kind, std::string_view name, std::string_view value) {
+        switch (kind) {
+        case element_kind::PLAYER:
+            OnPlayerAttribute(name, value);
+            break;
+        case element_kind::CUSTOM_STAT:
+            if (!in_player_) {
+                break;
+            }
+            if (name == "mStatName") {
+                report_.custom_stat_names_.back() = value;
+            } else if (name == "mValueForDisplay") {
+                report_.custom_stat_values_.back() = value;
+            }
+            break;
+        case element_kind::MEDAL:
+            if (!in_player_) {
+                break;
+            }
+            if (name == "mId") {
+                Number(ParseInt<uint16_t>(value), report_.medal_ids_.back());
+            } else if (name == "mCount") {
+                Number(ParseInt<int32_t>(value), report_.medal_counts_.back());
+            }
+            break;
+        case element_kind::OTHER:
+            if (!in_player_) {
+                OnHeaderAttribute(name, value);
+            }
+            break;
+        }
+    }
+
+    void OnPlayerAttribute(std::string_view name, std::string_view value) {
+        auto it = player_attributes.find(name);
+        if (it == player_attributes.end()) {
+            return;
+        }
+        const auto *attribute = &it->second;
+
+        switch (attribute->kind_) {
+        case player_attribute_kind::XUID:
+            Number(ParseXUID(value), report_.xbox_user_id_.back());
+            break;
+        case player_attribute_kind::GUEST:
+            report_.is_guest_.back() = ParseBool(value);
+            break;
+        case player_attribute_kind::STAT:
+            Number(ParseInt<int32_t>(value), report_.stats_[attribute->column_].back());
+            break;
+        case player_attribute_kind::TEXT:
+            report_.texts_[attribute->column_].back() = value;
+            break;
+        }
+    }
+
+    // Most medal entries have a count of 0 and most custom stats are blank; keep neither
+    void DropEmptyEntry(element_kind kind) {
+        if ((kind == element_kind::MEDAL) && (report_.medal_counts_.back() == 0)) {
+            report_.medal_ids_.pop_back();
+            report_.medal_counts_.pop_back();
+        } else if ((kind == element_kind::CUSTOM_STAT) &&
+                   report_.custom_stat_names_.back().empty() &&
+                   report_.custom_stat_values_.back().empty()) {
+            report_.custom_stat_names_.pop_back();
+            report_.custom_stat_values_.pop_back();
+        }
+    }
+
+    void OnHeaderAttribute(std::string_view name, std::string_view value) {
+        auto &header = report_.header_;
+        if (name == "mGameEnum") {
+            Number(ParseInt<int32_t>(value), header.game_enum_);
+        } else if (name == "IsMatchmaking") {
+            header.is_matchmaking_ = ParseBool(value);
+        } else if (name == "mHasNetworkMembersInParty") {
+            header.has_network_members_in_party_ = ParseBool(value);
+        } else if (name == "mPartySize") {
+            Number(ParseInt<int32_t>(value), header.party_size_);
+        } else if (name == "mLastMatchIncomplete") {
+            header.last_match_incomplete_ = ParseBool(value);
+        } else if (name == "IsTeamsEnabled") {
+            header.is_teams_enabled_ = ParseBool(value);
+        } else if (name == "HopperId") {
+            Number(ParseInt<int64_t>(value), header.hopper_id_);
+        } else if (name == "HopperName") {
+            header.hopper_name_ = value;
+        } else if (name == "GameTypeName") {
+            header.gametype_name_ = value;
+        } else if (name == "GameUniqueId") {
+            header.game_unique_id_ = value;
+        }
+    }
+
+    // A value that didn't parse leaves out at its default and is counted against the report
+    template <typename Int, typename Out>
+    void Number(std::optional<Int> value, Out &out) {
+        if (value.has_value()) {
+            out = *value;
+        } else {
+            ++report_.malformed_values_;
+        }
+    }
+
+    // Every column gets a default entry, so a missing attribute can't misalign the table
+    void BeginPlayer() {
+        in_player_ = true;
+        report_.xbox_user_id_.emplace_back();
+        report_.is_guest_.emplace_back();
+        for (auto &column : report_.stats_) {
+            column.emplace_back();
+        }
+        for (auto &column : report_.texts_) {
+            column.emplace_back();
+        }
+        report_.custom_stats_begin_.push_back(
+            static_cast<uint32_t>(report_.custom_stat_names_.size()));
+        report_.medals_begin_.push_back(static_cast<uint32_t>(report_.medal_ids_.size()));
+    }
+
+    void Reserve() {
+        constexpr size_t players = carnage_report_reserve_players;
+        report_.xbox_user_id_.reserve(players);
+        report_.is_guest_.reserve(players);
+        for (auto &column : report_.stats_) {
+            column.reserve(players);
+        }
+        for (auto &column : report_.texts_) {
+            column.reserve(players);
+        }
+        report_.custom_stats_begin_.reserve(players);
+        report_.medals_begin_.reserve(players);
+    }
+
+    carnage_report &report_;
+    bool in_player_ = false;
+};
+
+} // namespace details
+
+/**
+ * @brief Parses a carnage report (mpcarnagereport*.xml, survivalcarnagereport*.xml) in one pass
+ * without building a document. Text columns view xml, which must outlive report. False for
+ * malformed or truncated reports, e.g. one MCC is still writing.
+ */
+inline bool ParseCarnageReport(std::string_view xml, carnage_report &report) {
+    report.Clear();
+    return details::carnage_report_parser(report).Parse(xml);
+}
+
+// Maps the report and parses it in place; the mapping lives as long as the result
+inline std::optional<carnage_report> ReadCarnageReport(const std::filesystem::path &xml_file) {
+    carnage_report report;
+    if (!report.source_.open(xml_file)) {
+        return std::nullopt;
+    }
+
+    auto bytes = report.source_.bytes();
+    std::string_view xml(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    if (!ParseCarnageReport(xml, report)) {
+        return std::nullopt;
+    }
+    return report;
+}
+
+// Copies the report into memory it owns before parsing, so the file isn't held open; use for
+// reports MCC may still replace or delete
+inline std::optional<carnage_report> LoadCarnageReport(const std::filesystem::path &xml_file) {
+    std::ifstream ifs(xml_file, std::ios::binary | std::ios::ate);
+    if (!ifs) {
+        return std::nullopt;
+    }
+
+    carnage_report report;
+    report.text_.resize(static_cast<size_t>(ifs.tellg()));
+    ifs.seekg(0);
+    ifs.read(report.text_.data(), static_cast<std::streamsize>(report.text_.size()));
+    report.text_.resize(static_cast<size_t>(ifs.gcount()));
+
+    std::string_view xml(report.text_.data(), report.text_.size());
+    if (!ParseCarnageReport(xml, report)) {
+        return std::nullopt;
+    }
+    return report;
+}
+
+// Replaces the five predefined entities and numeric character references
+inline std::string UnescapeXML(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+
+    while (!text.empty()) {
+        auto amp = text.find('&');
+        out.append(text.substr(0, amp));
+        if (amp == std::string_view::npos) {
+            break;
+        }
+        text.remove_prefix(amp);
+
+        auto semi = text.find(';');
+        if (semi == std::string_view::npos) {
+            out.append(text);
+            break;
+        }
+        auto entity = text.substr(1, semi - 1);
+        text.remove_prefix(semi + 1);
+
+        if (entity == "lt") {
+            out.push_back('<');
+        } else if (entity == "gt") {
+            out.push_back('>');
+        } else if (entity == "amp") {
+            out.push_back('&');
+        } else if (entity == "apos") {
+            out.push_back('\'');
+        } else if (entity == "quot") {
+            out.push_back('"');
+        } else if (auto ref = details::CharacterReference(entity); ref.has_value()) {
+            uint32_t cp = *ref;
+            if (cp < 0x80) {
+                out.push_back(static_cast<char>(cp));
+            } else if (cp < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            } else if (cp < 0x10000) {
+                out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            } else if (cp < 0x110000) {
+                out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+        } else {
+            out.push_back('&');
+            out.append(entity);
+            out.push_back(';');
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief The integer stats and unescaped gamertags of a carnage report, flat and fixed size so
+ * it can be cached byte for byte (see carnage_parse_cache). Players past max_players are left out.
+ */
+struct carnage_report_rows {
+    static constexpr size_t max_players = 16;
+
+    int32_t game_enum_ = 0;
+    uint32_t player_count_ = 0;
+    std::array<uint64_t, max_players> xbox_user_id_ = {};
+    std::array<fixed_string<32>, max_players> gamertag_ = {};
+    std::array<std::array<int32_t, max_players>, static_cast<size_t>(carnage_player_stat::COUNT)>
+        stats_ = {};
+
+    int32_t Stat(carnage_player_stat stat, size_t player) const {
+        return stats_[static_cast<size_t>(stat)][player];
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<carnage_report_rows>);
+
+inline carnage_report_rows GetCarnageReportRows(const carnage_report &report) {
+    carnage_report_rows rows;
+    rows.game_enum_ = report.header_.game_enum_;
+    rows.player_count_ =
+        static_cast<uint32_t>(std::min(report.PlayerCount(), carnage_report_rows::max_players));
+
+    for (size_t i = 0; i < rows.player_count_; ++i) {
+        rows.xbox_user_id_[i] = report.xbox_user_id_[i];
+        rows.gamertag_[i].assign(UnescapeXML(report.Text(carnage_player_text::GAMERTAG, i)));
+        for (size_t stat = 0; stat < rows.stats_.size(); ++stat) {
+            rows.stats_[stat][i] = report.Stat(static_cast<carnage_player_stat>(stat), i);
+        }
+    }
+    return rows;
+}
+
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "mccinfo/game_hint.hpp"
+
+namespace mccinfo {
+namespace file_readers {
+
+/**
+ * @brief Title and chdr version of a theater file, as told by its header. Every title's film
+ * starts with a _blf chunk (carrying the build name, e.g. "halo 3 saved film") followed by the
+ * chdr chunk, whose version separates the Halo 3 engine from Reach and later.
+ *
+ * Halo 3 and ODST write identical headers, as do Halo 4 and Halo 2 Anniversary when the build
+ * name is blank (.temp autosaves); those resolve to HALO3 and HALO4, whose layouts decode both.
+ */
+struct theater_file_signature {
+    mccinfo::game_hint title_;
+    uint16_t chdr_version_;
+};
+
+// Bytes ClassifyTheaterFile needs to see
+inline constexpr size_t theater_file_signature_size = 0x40;
+
+namespace details {
+
+inline constexpr size_t blf_build_name_offset = 0x0E;
+inline constexpr size_t blf_build_name_length = 0x20;
+inline constexpr size_t chdr_offset = 0x30;
+inline constexpr size_t chdr_version_offset = 0x38;
+inline constexpr size_t chdr_flags_offset = 0x3E;
+
+inline bool HasChunkMagic(std::span<const std::byte> header, size_t offset,
+                          const char (&magic)[5]) {
+    return std::memcmp(header.data() + offset, magic, 4) == 0;
+}
+
+inline bool BuildNameContains(std::span<const std::byte> header, std::string_view needle) {
+    const char *name = reinterpret_cast<const char *>(header.data() + blf_build_name_offset);
+    return std::string_view(name, strnlen(name, blf_build_name_length)).find(needle) !=
+           std::string_view::npos;
+}
+
+} // namespace details
+
+// Constant time probe of the first theater_file_signature_size bytes; nullopt if not a film
+inline std::optional<theater_file_signature> ClassifyTheaterFile(
+    std::span<const std::byte> header) {
+    if ((header.size() < theater_file_signature_size) ||
+        !details::HasChunkMagic(header, 0, "_blf") ||
+        !details::HasChunkMagic(header, details::chdr_offset, "chdr")) {
+        return std::nullopt;
+    }
+
+    // chunk headers are big endian regardless of the byte order mark
+    uint16_t version = static_cast<uint16_t>(
+        (std::to_integer<uint16_t>(header[details::chdr_version_offset]) << 8) |
+        std::to_integer<uint16_t>(header[details::chdr_version_offset + 1]));
+    bool extended_flags = (header[details::chdr_flags_offset] != std::byte{0});
+
+    switch (version) {
+    case 0x0009:
+        // no ODST film has been seen to tell apart by its build name, so ODST reads as Halo 3,
+        // whose layout it shares (see layouts::halo3odst)
+        return theater_file_signature{mccinfo::game_hint::HALO3, version};
+    case 0x000A:
+        if (!extended_flags) {
+            return theater_file_signature{mccinfo::game_hint::HALOREACH, version};
+        }
+        return theater_file_signature{details::BuildNameContains(header, "groundhog")
+                                          ? mccinfo::game_hint::HALO2A
+                                          : mccinfo::game_hint::HALO4,
+                                      version};
+    default:
+        return std::nullopt;
+    }
+}
+
+} // namespace file_readers
+} // namespace mccinfo
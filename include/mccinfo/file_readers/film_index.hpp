@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+
+namespace mccinfo {
+namespace file_readers {
+
+constexpr size_t film_id_digits = 8;
+
+namespace details {
+
+inline std::optional<uint32_t> ParseFilmIdToken(std::string_view token) {
+    if (token.size() != film_id_digits) {
+        return std::nullopt;
+    }
+
+    uint32_t id = 0;
+    for (char c : token) {
+        uint32_t digit;
+        if ((c >= '0') && (c <= '9')) {
+            digit = static_cast<uint32_t>(c - '0');
+        } else if ((c >= 'a') && (c <= 'f')) {
+            digit = static_cast<uint32_t>(c - 'a' + 10);
+        } else if ((c >= 'A') && (c <= 'F')) {
+            digit = static_cast<uint32_t>(c - 'A' + 10);
+        } else {
+            return std::nullopt;
+        }
+        id = (id << 4) | digit;
+    }
+    return id;
+}
+
+// The token before the last '_' of name, with name shortened to end before it
+inline std::string_view PopStemToken(std::string_view &name) {
+    auto sep = name.rfind('_');
+    if (sep == std::string_view::npos) {
+        auto token = name;
+        name = std::string_view();
+        return token;
+    }
+    auto token = name.substr(sep + 1);
+    name = name.substr(0, sep);
+    return token;
+}
+
+} // namespace details
+
+enum class film_kind {
+    NONE,
+    AUTOSAVE, // .temp snapshot written while the match is played
+    FILM,     // .film/.mov saved once the match ends
+};
+
+// Extensions are matched regardless of case, as the file systems MCC writes to ignore it
+inline film_kind GetFilmKind(const std::filesystem::path &file) {
+    auto extension = file.extension().generic_string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if (extension == ".temp") {
+        return film_kind::AUTOSAVE;
+    }
+    if ((extension == ".film") || (extension == ".mov")) {
+        return film_kind::FILM;
+    }
+    return film_kind::NONE;
+}
+
+/**
+ * @brief The film id shared by a match's autosave and its saved film, e.g. 0x10DB95E8 for both
+ * asq_chill_10db95e8.temp and asq_chill_10DB95E8_65D005D4.film. Autosaves end in the id; saved
+ * films append a second 8 digit token after it. Case is not significant.
+ */
+inline std::optional<uint32_t> ParseFilmId(const std::filesystem::path &file) {
+    auto kind = GetFilmKind(file);
+    if (kind == film_kind::NONE) {
+        return std::nullopt;
+    }
+
+    auto stem_string = file.stem().string();
+    std::string_view stem = stem_string;
+
+    if (kind == film_kind::FILM) {
+        if (!details::ParseFilmIdToken(details::PopStemToken(stem)).has_value()) {
+            return std::nullopt;
+        }
+    }
+    return details::ParseFilmIdToken(details::PopStemToken(stem));
+}
+
+/**
+ * @brief Autosaves and saved films by film id, so a match's film is found with one lookup instead
+ * of walking the temp directory when the match ends.
+ *
+ * Kept current by Add/Remove from file create and delete events; Scan seeds it from disk once.
+ * Safe to feed from one thread while another looks up.
+ */
+class film_index {
+  public:
+    // Returns false for paths that are not theater files or carry no film id
+    bool Add(const std::filesystem::path &file) {
+        auto id = ParseFilmId(file);
+        if (!id.has_value()) {
+            return false;
+        }
+
+        std::unique_lock lock(mutex_);
+        Entries(GetFilmKind(file))[id.value()] = file;
+        return true;
+    }
+
+    void Remove(const std::filesystem::path &file) {
+        auto id = ParseFilmId(file);
+        if (!id.has_value()) {
+            return;
+        }
+
+        std::unique_lock lock(mutex_);
+        auto &entries = Entries(GetFilmKind(file));
+        auto it = entries.find(id.value());
+        if ((it != entries.end()) && (it->second == file)) {
+            entries.erase(it);
+        }
+    }
+
+    // Adds every theater file under root; returns how many were added
+    size_t Scan(const std::filesystem::path &root) {
+        std::error_code ec;
+        std::filesystem::recursive_directory_iterator it(
+            root, std::filesystem::directory_options::skip_permission_denied, ec);
+
+        size_t added = 0;
+        for (; !ec && (it != std::filesystem::recursive_directory_iterator());
+             it.increment(ec)) {
+            if (it->is_regular_file(ec) && Add(it->path())) {
+                ++added;
+            }
+        }
+        return added;
+    }
+
+    void Clear() {
+        std::unique_lock lock(mutex_);
+        autosaves_.clear();
+        films_.clear();
+    }
+
+    std::optional<std::filesystem::path> Find(film_kind kind, uint32_t id) const {
+        std::shared_lock lock(mutex_);
+        const auto &entries = (kind == film_kind::AUTOSAVE) ? autosaves_ : films_;
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    // The saved film of the match autosave (or any file carrying its film id) belongs to
+    std::optional<std::filesystem::path> FindMatchingFilm(
+        const std::filesystem::path &theater_file) const {
+        auto id = ParseFilmId(theater_file);
+        if (!id.has_value()) {
+            return std::nullopt;
+        }
+        return Find(film_kind::FILM, id.value());
+    }
+
+    size_t Size() const {
+        std::shared_lock lock(mutex_);
+        return autosaves_.size() + films_.size();
+    }
+
+  private:
+    std::unordered_map<uint32_t, std::filesystem::path> &Entries(film_kind kind) {
+        return (kind == film_kind::AUTOSAVE) ? autosaves_ : films_;
+    }
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<uint32_t, std::filesystem::path> autosaves_;
+    std::unordered_map<uint32_t, std::filesystem::path> films_;
+};
+
+} // namespace file_readers
+} // namespace mccinfo
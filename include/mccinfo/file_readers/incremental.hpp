@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <vector>
+
+#include "mccinfo/file_readers.hpp"
+
+namespace mccinfo {
+namespace file_readers {
+
+// What changed between two polls of a live theater file
+struct theater_file_delta {
+    uint32_t changed_fields_ = 0; // theater_file_fields whose value differs from the last poll
+    player_roster joined_;        // in the roster now, not in the last poll
+    player_roster left_;          // in the last poll, not in the roster now
+};
+
+/**
+ * @brief Follows a theater file that is still being written (the autosave .temp film) and reports
+ * what changed on each Poll(). Only the pages that hold requested fields, plus pages appended
+ * since the last poll, are read again; a poll whose bytes are unchanged decodes nothing.
+ *
+ * The file is reopened per poll so the game and autosave_client can still move or delete it.
+ */
+template <theater_file_layout Layout>
+class live_theater_file_reader {
+  public:
+    static constexpr size_t page_size = 0x1000;
+
+    explicit live_theater_file_reader(std::filesystem::path theater_file,
+                                      uint32_t fields = FIELD_ALL,
+                                      const clock_context &clock = clock_context::System())
+        : theater_file_(std::move(theater_file)), fields_(fields), clock_(clock) {
+    }
+
+    // nullopt if the file could not be read or nothing requested has changed
+    std::optional<theater_file_delta> Poll() {
+        std::error_code ec;
+        auto file_size = std::filesystem::file_size(theater_file_, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+
+        // a shorter file is a new film written over the old name; read it from scratch, but diff
+        // against the old film so its players are reported as having left
+        if (file_size < file_size_) {
+            region_.clear();
+        }
+        file_size_ = file_size;
+
+        if (!RefreshRegion()) {
+            return std::nullopt;
+        }
+
+        theater_file_data file_data;
+        theater_file_reader<Layout>::Decode(theater_file_, region_, file_data, fields_, clock_);
+
+        auto delta = Diff(file_data_, file_data);
+        file_data_ = file_data;
+
+        if ((delta.changed_fields_ == 0) && delta.joined_.empty() && delta.left_.empty()) {
+            return std::nullopt;
+        }
+        return delta;
+    }
+
+    void Reset() {
+        region_.clear();
+        file_size_ = 0;
+        file_data_ = theater_file_data{};
+    }
+
+    const theater_file_data &GetData() const {
+        return file_data_;
+    }
+
+    const std::filesystem::path &GetPath() const {
+        return theater_file_;
+    }
+
+  private:
+    // Pages that may be rewritten in place: the header fields, and the player table when requested
+    bool IsHotPage(size_t page_offset) const {
+        size_t header_end = theater_file_reader<Layout>::GetRegionSize(fields_ & ~FIELD_PLAYER_SET);
+        if (page_offset < header_end) {
+            return true;
+        }
+        if (fields_ & FIELD_PLAYER_SET) {
+            size_t table_page = Layout.player_table_offset_ - (Layout.player_table_offset_ % page_size);
+            return (page_offset >= table_page);
+        }
+        return false;
+    }
+
+    // Returns true if any byte of the region differs from the last poll
+    bool RefreshRegion() {
+        size_t region_size = std::min<uintmax_t>(
+            file_size_, theater_file_reader<Layout>::GetRegionSize(fields_));
+
+        std::ifstream ifs;
+        ifs.rdbuf()->pubsetbuf(nullptr, 0);
+        ifs.open(theater_file_, std::ios::binary);
+        if (!ifs) {
+            return false;
+        }
+
+        size_t known_size = region_.size();
+        region_.resize(region_size);
+
+        bool changed = (region_size != known_size);
+        std::byte page[page_size];
+        for (size_t offset = 0; offset < region_size; offset += page_size) {
+            bool appended = ((offset + page_size) > known_size);
+            if (!appended && !IsHotPage(offset)) {
+                continue;
+            }
+
+            size_t length = std::min(page_size, region_size - offset);
+            ifs.seekg(static_cast<std::streamoff>(offset));
+            ifs.read(reinterpret_cast<char *>(page), static_cast<std::streamsize>(length));
+            if (static_cast<size_t>(ifs.gcount()) != length) {
+                // truncated under us, pick it up again on the next poll
+                region_.resize(offset);
+                return true;
+            }
+
+            if (std::memcmp(region_.data() + offset, page, length) != 0) {
+                std::memcpy(region_.data() + offset, page, length);
+                changed = true;
+            }
+        }
+
+        return changed;
+    }
+
+    static theater_file_delta Diff(const theater_file_data &last, const theater_file_data &now) {
+        theater_file_delta delta;
+        if (last.gametype_ != now.gametype_) {
+            delta.changed_fields_ |= FIELD_GAMETYPE;
+        }
+        if (last.desc_ != now.desc_) {
+            delta.changed_fields_ |= FIELD_DESC;
+        }
+        if (last.author_xuid_ != now.author_xuid_) {
+            delta.changed_fields_ |= FIELD_AUTHOR_XUID;
+        }
+        if (last.author_ != now.author_) {
+            delta.changed_fields_ |= FIELD_AUTHOR;
+        }
+        if (last.utc_timestamp_ != now.utc_timestamp_) {
+            delta.changed_fields_ |= FIELD_UTC_TIMESTAMP;
+        }
+
+        // both rosters are sorted, so one merge pass finds joins and leaves
+        auto l = last.player_set_.begin();
+        auto n = now.player_set_.begin();
+        while ((l != last.player_set_.end()) || (n != now.player_set_.end())) {
+            if ((n == now.player_set_.end()) || ((l != last.player_set_.end()) && (*l < *n))) {
+                delta.left_.insert(*l++);
+            } else if ((l == last.player_set_.end()) || (*n < *l)) {
+                delta.joined_.insert(*n++);
+            } else {
+                ++l;
+                ++n;
+            }
+        }
+        if (!delta.joined_.empty() || !delta.left_.empty()) {
+            delta.changed_fields_ |= FIELD_PLAYER_SET;
+        }
+
+        return delta;
+    }
+
+    std::filesystem::path theater_file_;
+    uint32_t fields_;
+    clock_context clock_;
+
+    std::vector<std::byte> region_;
+    uintmax_t file_size_ = 0;
+    theater_file_data file_data_;
+};
+
+using halo3_live_theater_file_reader = live_theater_file_reader<layouts::halo3>;
+using halo3odst_live_theater_file_reader = live_theater_file_reader<layouts::halo3odst>;
+using haloreach_live_theater_file_reader = live_theater_file_reader<layouts::haloreach>;
+using halo4_live_theater_file_reader = live_theater_file_reader<layouts::halo4>;
+using halo2a_live_theater_file_reader = live_theater_file_reader<layouts::halo2a>;
+
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mccinfo/core/thread_pool.hpp"
+#include "mccinfo/file_readers.hpp"
+#include "mccinfo/file_readers/parse_cache.hpp"
+
+namespace mccinfo {
+namespace file_readers {
+
+struct indexed_theater_file {
+    std::filesystem::path path_;
+    uintmax_t size_ = 0;
+    std::optional<theater_file_data> data_;
+    bool cached_ = false;
+};
+
+struct theater_index_report {
+    size_t files_ = 0;
+    size_t parsed_ = 0;
+    size_t cached_ = 0; // served from the parse cache without decoding
+    uintmax_t bytes_ = 0;
+    size_t threads_ = 0;
+    std::chrono::nanoseconds elapsed_{0};
+
+    double FilesPerSecond() const {
+        return (elapsed_.count() > 0) ? (files_ * 1e9 / elapsed_.count()) : 0.0;
+    }
+    double BytesPerSecond() const {
+        return (elapsed_.count() > 0) ? (bytes_ * 1e9 / elapsed_.count()) : 0.0;
+    }
+};
+
+struct theater_index {
+    std::vector<indexed_theater_file> files_;
+    theater_index_report report_;
+};
+
+inline bool IsTheaterFile(const std::filesystem::path &path) {
+    auto extension = path.extension().generic_string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    return (extension == ".film") || (extension == ".mov") || (extension == ".temp");
+}
+
+// Returns every theater file under root, sorted by path so an index is stable across runs
+inline std::vector<std::filesystem::path> CollectTheaterFiles(const std::filesystem::path &root) {
+    std::vector<std::filesystem::path> theater_files;
+
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(
+             root, std::filesystem::directory_options::skip_permission_denied, ec);
+         it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (ec) {
+            break;
+        }
+        if (it->is_regular_file(ec) && IsTheaterFile(it->path())) {
+            theater_files.push_back(it->path());
+        }
+    }
+
+    std::sort(theater_files.begin(), theater_files.end());
+    return theater_files;
+}
+
+namespace details {
+
+inline std::optional<theater_file_data> ReadTheaterFileQuery(
+    const std::filesystem::path &theater_file, std::optional<mccinfo::game_hint> hint,
+    uint32_t fields) {
+    if (!hint.has_value()) {
+        return ReadAnyTheaterFile(theater_file, fields);
+    }
+
+    switch (hint.value()) {
+    case mccinfo::game_hint::HALO2A:
+        return halo2a_theater_file_reader::Read(theater_file, fields);
+    case mccinfo::game_hint::HALO3:
+        return halo3_theater_file_reader::Read(theater_file, fields);
+    case mccinfo::game_hint::HALO3ODST:
+        return halo3odst_theater_file_reader::Read(theater_file, fields);
+    case mccinfo::game_hint::HALOREACH:
+        return haloreach_theater_file_reader::Read(theater_file, fields);
+    case mccinfo::game_hint::HALO4:
+        return halo4_theater_file_reader::Read(theater_file, fields);
+    default:
+        return std::nullopt;
+    }
+}
+
+} // namespace details
+
+// Parses every theater file under root on a work stealing pool (thread_count == 0 uses one
+// worker per core). Results keep the order of CollectTheaterFiles regardless of completion order.
+// Without a hint each file's title is told from its header. With a cache, unchanged files are
+// taken from it and everything decoded is stored back.
+inline theater_index IndexTheaterFiles(const std::filesystem::path &root,
+                                       std::optional<mccinfo::game_hint> hint = std::nullopt,
+                                       size_t thread_count = 0, uint32_t fields = FIELD_ALL,
+                                       theater_parse_cache *cache = nullptr) {
+    auto start = std::chrono::steady_clock::now();
+
+    theater_index index;
+    for (auto &path : CollectTheaterFiles(root)) {
+        index.files_.push_back({std::move(path), 0, std::nullopt, false});
+    }
+
+    // checked once up front; a cache closed while indexing just misses and drops its stores
+    if ((cache != nullptr) && !cache->IsOpen()) {
+        cache = nullptr;
+    }
+
+    {
+        core::thread_pool pool(thread_count);
+        index.report_.threads_ = pool.size();
+
+        // each task owns exactly one slot, so no synchronization is needed on the results
+        for (auto &entry : index.files_) {
+            pool.submit([&entry, hint, fields, cache] {
+                if (cache == nullptr) {
+                    std::error_code ec;
+                    entry.size_ = std::filesystem::file_size(entry.path_, ec);
+                    if (ec || (entry.size_ == 0)) {
+                        entry.size_ = 0;
+                        return;
+                    }
+                    entry.data_ = details::ReadTheaterFileQuery(entry.path_, hint, fields);
+                    return;
+                }
+
+                auto id = file_identity::Of(
+                    entry.path_, hint.has_value() ? (static_cast<uint64_t>(hint.value()) + 1) : 0);
+                if (!id.has_value() || (id->size_ == 0)) {
+                    return;
+                }
+                entry.size_ = id->size_;
+
+                entry.data_ = cache->Find(*id, fields);
+                if (entry.data_.has_value()) {
+                    entry.cached_ = true;
+                    return;
+                }
+
+                entry.data_ = details::ReadTheaterFileQuery(entry.path_, hint, fields);
+                if (entry.data_.has_value()) {
+                    cache->Store(*id, *entry.data_, fields);
+                }
+            });
+        }
+
+        pool.wait();
+    }
+
+    index.report_.files_ = index.files_.size();
+    for (const auto &entry : index.files_) {
+        index.report_.bytes_ += entry.size_;
+        if (entry.data_.has_value()) {
+            ++index.report_.parsed_;
+        }
+        if (entry.cached_) {
+            ++index.report_.cached_;
+        }
+    }
+    index.report_.elapsed_ = std::chrono::steady_clock::now() - start;
+
+    return index;
+}
+
+} // namespace file_readers
+} // namespace mccinfo
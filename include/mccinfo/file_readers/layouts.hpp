@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+
+namespace mccinfo {
+namespace file_readers {
+
+enum class description_encoding {
+    UTF16,          // null terminated UTF-16LE at desc_offset_
+    ASCII_AFTER_GAP // ascii following the null padding of the UTF-16 gametype
+};
+
+/**
+ * @brief Byte layout of a title's theater file header. Every decoded field of theater_file_data
+ * is described here, so a title only needs a table and no reader code of its own.
+ *
+ * Offsets are absolute from the start of the file; team_offset_ is relative to the slot start.
+ * Every scan is bounded by a length here or in the scanner, never by what the bytes contain, so a
+ * truncated or zero filled file fails in the same time as a valid one decodes.
+ */
+struct theater_file_layout {
+    size_t region_size_;
+
+    size_t gametype_offset_;
+    size_t gametype_length_;
+    bool gametype_from_path_; // films of campaign sessions are named after the mode instead
+
+    description_encoding desc_encoding_;
+    size_t desc_offset_;
+    size_t desc_length_;
+
+    size_t xuid_offset_;
+
+    size_t author_offset_;
+    size_t author_length_; // 0 if the title does not store the author
+
+    size_t duration_offset_; // 0 if the title does not store the match length
+
+    bool player_table_follows_marker_; // table offset is where the marker search starts
+    size_t player_marker_scan_length_; // bytes past the table offset the marker may start in
+    size_t player_table_offset_;
+    size_t player_stride_;
+    size_t player_name_length_;
+    size_t team_offset_;
+    size_t max_empty_slots_;
+    size_t max_players_; // 0 for no limit beyond scanner::max_player_slots
+};
+
+namespace layouts {
+
+inline constexpr theater_file_layout halo3 = {
+    .region_size_ = 0x00002000,
+    .gametype_offset_ = 0x00000048,
+    .gametype_length_ = 184,
+    .gametype_from_path_ = false,
+    .desc_encoding_ = description_encoding::ASCII_AFTER_GAP,
+    .desc_offset_ = 0x00000048,
+    .desc_length_ = 184,
+    .xuid_offset_ = 0x00000100,
+    .author_offset_ = 0,
+    .author_length_ = 0,
+    .duration_offset_ = 0x00000118,
+    .player_table_follows_marker_ = true,
+    .player_marker_scan_length_ = 0x00000800, // found at 0x498 in every known film
+    .player_table_offset_ = 0x000001D8,
+    .player_stride_ = 184,
+    .player_name_length_ = 32,
+    .team_offset_ = 32 + 120,
+    .max_empty_slots_ = 5,
+    .max_players_ = 0,
+};
+
+// ODST runs on the Halo 3 engine and writes the same film header
+inline constexpr theater_file_layout halo3odst = halo3;
+
+inline constexpr theater_file_layout haloreach = {
+    .region_size_ = 0x00002000,
+    .gametype_offset_ = 0x000000C0,
+    .gametype_length_ = 256,
+    .gametype_from_path_ = false,
+    .desc_encoding_ = description_encoding::UTF16,
+    .desc_offset_ = 0x000001C0,
+    .desc_length_ = 256,
+    .xuid_offset_ = 0x00000080,
+    .author_offset_ = 0x00000088,
+    .author_length_ = 16,
+    .duration_offset_ = 0,
+    .player_table_follows_marker_ = false,
+    .player_marker_scan_length_ = 0,
+    .player_table_offset_ = 0x00000BD0,
+    .player_stride_ = 160,
+    .player_name_length_ = 32,
+    .team_offset_ = 32 + 88,
+    .max_empty_slots_ = 2,
+    .max_players_ = 0,
+};
+
+inline constexpr theater_file_layout halo4 = {
+    .region_size_ = 0x0002E000,
+    .gametype_offset_ = 0x000000C0,
+    .gametype_length_ = 256,
+    .gametype_from_path_ = true,
+    .desc_encoding_ = description_encoding::UTF16,
+    .desc_offset_ = 0x000001C0,
+    .desc_length_ = 256,
+    .xuid_offset_ = 0x00000080,
+    .author_offset_ = 0x00000088,
+    .author_length_ = 16,
+    .duration_offset_ = 0,
+    .player_table_follows_marker_ = false,
+    .player_marker_scan_length_ = 0,
+    .player_table_offset_ = 0x0002C3C0,
+    .player_stride_ = 328,
+    .player_name_length_ = 32,
+    .team_offset_ = 32 + 256,
+    .max_empty_slots_ = 2,
+    .max_players_ = 16,
+};
+
+// No film for campaign
+inline constexpr theater_file_layout halo2a = [] {
+    theater_file_layout layout = halo4;
+    layout.gametype_from_path_ = false;
+    return layout;
+}();
+
+} // namespace layouts
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "mccinfo/file_readers/carnage_report.hpp"
+#include "mccinfo/file_readers/scanner.hpp"
+
+namespace mccinfo {
+namespace file_readers {
+
+namespace details {
+
+inline void PutVarint(std::vector<uint8_t> &out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Reads a varint at p, which must be followed by a whole one; single byte values take one branch
+inline uint32_t GetVarint(const uint8_t *&p) {
+    uint32_t value = *p++;
+    if (value < 0x80) {
+        return value;
+    }
+    value &= 0x7F;
+    for (uint32_t shift = 7;; shift += 7) {
+        uint32_t byte = *p++;
+        value |= (byte & 0x7F) << shift;
+        if (byte < 0x80) {
+            return value;
+        }
+    }
+}
+
+constexpr uint32_t ZigZag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+constexpr int32_t UnZigZag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+// Steps p past count varints, which must all lie before end. A varint ends at each byte without
+// the high bit, so long runs are skipped a block at a time by counting those bytes.
+inline const uint8_t *SkipVarints(const uint8_t *p, [[maybe_unused]] const uint8_t *end,
+                                  size_t count) {
+#if defined(MCCINFO_SCANNER_SSE2)
+    // a player's remaining entries are usually a few bytes; a block only pays off past that
+    while ((count >= 8) && (static_cast<size_t>(end - p) >= 16)) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        auto ends = static_cast<uint32_t>(~_mm_movemask_epi8(block)) & 0xFFFF;
+        auto found = static_cast<size_t>(std::popcount(ends));
+        if (found < count) {
+            count -= found;
+            p += 16;
+            continue;
+        }
+        while (--count > 0) {
+            ends &= ends - 1;
+        }
+        return p + std::countr_zero(ends) + 1;
+    }
+#endif
+    for (; count > 0; --count) {
+        while (*p++ >= 0x80) {
+        }
+    }
+    return p;
+}
+
+} // namespace details
+
+/**
+ * @brief Medals of a run of players, as read from encoded bytes (an archive, a mapping) without
+ * decoding them up front.
+ *
+ * A player is a varint entry count followed by one (id delta, zigzag count) varint pair per
+ * medal held, ids ascending. Players list a few of the ~400 medal ids, so this is an order of
+ * magnitude smaller than a count per id. Bytes must hold player_count whole players.
+ */
+class medal_vector_view {
+  public:
+    medal_vector_view() = default;
+    medal_vector_view(std::span<const uint8_t> bytes, size_t player_count)
+        : bytes_(bytes), player_count_(player_count) {
+    }
+
+    size_t PlayerCount() const {
+        return player_count_;
+    }
+    std::span<const uint8_t> Bytes() const {
+        return bytes_;
+    }
+
+    // Calls visit(player, medal_id, count) for every medal held, in player then id order
+    template <typename Visit>
+    void ForEach(Visit &&visit) const {
+        const uint8_t *p = bytes_.data();
+        for (size_t player = 0; player < player_count_; ++player) {
+            uint32_t entries = details::GetVarint(p);
+            uint32_t id = 0;
+            for (uint32_t i = 0; i < entries; ++i) {
+                id += details::GetVarint(p);
+                visit(player, static_cast<uint16_t>(id), details::UnZigZag(details::GetVarint(p)));
+            }
+        }
+    }
+
+    // Calls visit(player, count) for every player holding medal_id. Stops reading a player at
+    // the first id past medal_id and skips the rest of its entries.
+    template <typename Visit>
+    void ForEachHolder(uint16_t medal_id, Visit &&visit) const {
+        const uint8_t *p = bytes_.data();
+        const uint8_t *end = p + bytes_.size();
+        for (size_t player = 0; player < player_count_; ++player) {
+            uint32_t entries = details::GetVarint(p);
+            uint32_t id = 0;
+            uint32_t i = 0;
+            for (; i < entries; ++i) {
+                id += details::GetVarint(p);
+                if (id >= medal_id) {
+                    break;
+                }
+                while (*p++ >= 0x80) {
+                }
+            }
+            if (i == entries) {
+                continue;
+            }
+            int32_t count = details::UnZigZag(details::GetVarint(p));
+            if (id == medal_id) {
+                visit(player, count);
+            }
+            p = details::SkipVarints(p, end, 2 * static_cast<size_t>(entries - i - 1));
+        }
+    }
+
+    // medal_id's count summed over every player
+    int64_t Sum(uint16_t medal_id) const {
+        int64_t sum = 0;
+        ForEachHolder(medal_id, [&](size_t, int32_t count) { sum += count; });
+        return sum;
+    }
+
+    // Adds every player's counts into totals, indexed by medal id; ids past its end are ignored
+    void AddTo(std::span<int64_t> totals) const {
+        ForEach([&](size_t, uint16_t medal_id, int32_t count) {
+            if (medal_id < totals.size()) {
+                totals[medal_id] += count;
+            }
+        });
+    }
+
+  private:
+    std::span<const uint8_t> bytes_;
+    size_t player_count_ = 0;
+};
+
+// Owns the encoding of a medal_vector_view, built a player at a time
+class medal_vector {
+  public:
+    // Adds a player; entries with a count of 0 are dropped, ids need not be sorted
+    void Append(std::span<const uint16_t> ids, std::span<const int32_t> counts) {
+        order_.resize(ids.size());
+        std::iota(order_.begin(), order_.end(), size_t(0));
+        if (!std::is_sorted(ids.begin(), ids.end())) {
+            std::sort(order_.begin(), order_.end(),
+                      [&](size_t a, size_t b) { return ids[a] < ids[b]; });
+        }
+
+        auto held = std::count_if(counts.begin(), counts.end(), [](int32_t c) { return c != 0; });
+        details::PutVarint(bytes_, static_cast<uint32_t>(held));
+        uint32_t previous = 0;
+        for (size_t i : order_) {
+            if (counts[i] == 0) {
+                continue;
+            }
+            details::PutVarint(bytes_, ids[i] - previous);
+            details::PutVarint(bytes_, details::ZigZag(counts[i]));
+            previous = ids[i];
+        }
+        ++player_count_;
+    }
+
+    // Adds every player of report
+    void Append(const carnage_report &report) {
+        for (size_t player = 0; player < report.PlayerCount(); ++player) {
+            Append(report.MedalIds(player), report.MedalCounts(player));
+        }
+    }
+
+    void Clear() {
+        bytes_.clear();
+        player_count_ = 0;
+    }
+
+    size_t PlayerCount() const {
+        return player_count_;
+    }
+    std::span<const uint8_t> Bytes() const {
+        return bytes_;
+    }
+    medal_vector_view View() const {
+        return medal_vector_view(bytes_, player_count_);
+    }
+
+  private:
+    std::vector<uint8_t> bytes_;
+    std::vector<size_t> order_;
+    size_t player_count_ = 0;
+};
+
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <type_traits>
+
+#include "mccinfo/core/hash.hpp"
+#include "mccinfo/core/mapped_file.hpp"
+#include "mccinfo/file_readers/carnage_report.hpp"
+#include "mccinfo/file_readers/theater_file_data.hpp"
+
+namespace mccinfo {
+namespace file_readers {
+
+/**
+ * @brief What a cached parse is keyed on: the path, plus size, last write time and a hash of the
+ * first header_probe_size bytes so a file rewritten within the mtime resolution still misses.
+ */
+struct file_identity {
+    static constexpr size_t header_probe_size = 0x1000;
+
+    uint64_t path_hash_ = 0;
+    uint64_t size_ = 0;
+    int64_t mtime_ = 0;
+    uint64_t header_hash_ = 0;
+
+    friend bool operator==(const file_identity &, const file_identity &) = default;
+
+    // Callers decoding one file several ways (e.g. per title) pass a distinct seed for each
+    static std::optional<file_identity> Of(const std::filesystem::path &path, uint64_t seed = 0) {
+        file_identity id;
+
+        const auto &native = path.native();
+        id.path_hash_ = core::Hash64(std::as_bytes(std::span(native.data(), native.size())), seed);
+
+        std::error_code ec;
+        id.size_ = std::filesystem::file_size(path, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        id.mtime_ = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        if (ec) {
+            return std::nullopt;
+        }
+
+        std::ifstream ifs;
+        ifs.rdbuf()->pubsetbuf(nullptr, 0);
+        ifs.open(path, std::ios::binary);
+        if (!ifs) {
+            return std::nullopt;
+        }
+        std::byte probe[header_probe_size];
+        ifs.read(reinterpret_cast<char *>(probe), sizeof(probe));
+        id.header_hash_ = core::Hash64(std::span(probe, static_cast<size_t>(ifs.gcount())));
+
+        return id;
+    }
+};
+
+/**
+ * @brief On disk open addressing hash table of decoded files, memory mapped so a lookup is a
+ * probe into the page cache instead of a parse. Value must be trivially copyable; it is stored
+ * byte for byte, so the file is only valid for the build that wrote it (see entry size check).
+ *
+ * Lookups may run concurrently; Store takes the table exclusively.
+ */
+template <typename Value>
+class parse_cache {
+    static_assert(std::is_trivially_copyable_v<Value>);
+
+  public:
+    static constexpr uint32_t version = 1;
+    static constexpr uint64_t initial_capacity = 1024; // power of two
+
+    parse_cache() = default;
+    parse_cache(const parse_cache &) = delete;
+    parse_cache &operator=(const parse_cache &) = delete;
+
+    ~parse_cache() {
+        Close();
+    }
+
+    // Opens the cache at path, starting a fresh one if it is missing or from another build
+    bool Open(const std::filesystem::path &path) {
+        std::unique_lock lock(mutex_);
+        path_ = path;
+
+        if (map_.open_writable(path_) && IsValid()) {
+            return true;
+        }
+        return Recreate(initial_capacity);
+    }
+
+    void Close() {
+        std::unique_lock lock(mutex_);
+        map_.close();
+    }
+
+    bool IsOpen() const {
+        std::shared_lock lock(mutex_);
+        return map_.is_open();
+    }
+
+    size_t Size() const {
+        std::shared_lock lock(mutex_);
+        return map_.is_open() ? Header().count_ : 0;
+    }
+
+    // A hit requires the same identity and that the stored decode covered every requested field
+    std::optional<Value> Find(const file_identity &id, uint32_t fields = FIELD_ALL) const {
+        std::shared_lock lock(mutex_);
+        if (!map_.is_open()) {
+            return std::nullopt;
+        }
+
+        const entry *slot = Probe(id.path_hash_);
+        if ((slot->occupied_ == 0) || !(slot->id_ == id) ||
+            ((slot->fields_ & fields) != fields)) {
+            return std::nullopt;
+        }
+        return slot->value_;
+    }
+
+    // Inserts or replaces the entry for id's path
+    bool Store(const file_identity &id, const Value &value, uint32_t fields = FIELD_ALL) {
+        std::unique_lock lock(mutex_);
+        if (!map_.is_open()) {
+            return false;
+        }
+
+        if (((Header().count_ + 1) * 4) > (Header().capacity_ * 3)) {
+            if (!Grow()) {
+                return false;
+            }
+        }
+
+        entry *slot = Probe(id.path_hash_);
+        if (slot->occupied_ == 0) {
+            ++Header().count_;
+        }
+        slot->id_ = id;
+        slot->fields_ = fields;
+        slot->value_ = value;
+        slot->occupied_ = 1;
+        return true;
+    }
+
+  private:
+    struct header {
+        char magic_[8];
+        uint32_t version_;
+        uint32_t entry_size_;
+        uint64_t capacity_;
+        uint64_t count_;
+    };
+
+    struct entry {
+        file_identity id_;
+        uint32_t fields_;
+        uint32_t occupied_;
+        Value value_;
+    };
+
+    static constexpr char magic[8] = {'M', 'C', 'C', 'I', 'P', 'C', 'H', 'E'};
+
+    static size_t FileSizeFor(uint64_t capacity) {
+        return sizeof(header) + (static_cast<size_t>(capacity) * sizeof(entry));
+    }
+
+    header &Header() {
+        return *reinterpret_cast<header *>(map_.bytes().data());
+    }
+    const header &Header() const {
+        return *reinterpret_cast<const header *>(map_.bytes().data());
+    }
+
+    entry *Entries() const {
+        return reinterpret_cast<entry *>(const_cast<std::byte *>(map_.bytes().data()) +
+                                         sizeof(header));
+    }
+
+    bool IsValid() const {
+        if (map_.size() < sizeof(header)) {
+            return false;
+        }
+        const auto &h = Header();
+        return (std::memcmp(h.magic_, magic, sizeof(magic)) == 0) && (h.version_ == version) &&
+               (h.entry_size_ == sizeof(entry)) && (h.capacity_ != 0) &&
+               ((h.capacity_ & (h.capacity_ - 1)) == 0) && (h.count_ < h.capacity_) &&
+               (map_.size() == FileSizeFor(h.capacity_));
+    }
+
+    // Slot holding path_hash, or the empty slot where it would go
+    entry *Probe(uint64_t path_hash) const {
+        uint64_t mask = Header().capacity_ - 1;
+        entry *entries = Entries();
+        for (uint64_t i = path_hash & mask;; i = (i + 1) & mask) {
+            if ((entries[i].occupied_ == 0) || (entries[i].id_.path_hash_ == path_hash)) {
+                return &entries[i];
+            }
+        }
+    }
+
+    static void InitHeader(header &h, uint64_t capacity) {
+        std::memcpy(h.magic_, magic, sizeof(magic));
+        h.version_ = version;
+        h.entry_size_ = sizeof(entry);
+        h.capacity_ = capacity;
+        h.count_ = 0;
+    }
+
+    bool Recreate(uint64_t capacity) {
+        map_.close();
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+        if (!map_.create(path_, FileSizeFor(capacity))) {
+            return false;
+        }
+        InitHeader(Header(), capacity);
+        return true;
+    }
+
+    // Rehashes into a table twice the size, built beside the cache and renamed over it
+    bool Grow() {
+        auto grown_path = path_;
+        grown_path += ".grow";
+
+        std::error_code ec;
+        std::filesystem::remove(grown_path, ec); // left over from an interrupted grow
+
+        core::mapped_file grown;
+        uint64_t capacity = Header().capacity_ * 2;
+        if (!grown.create(grown_path, FileSizeFor(capacity))) {
+            return false;
+        }
+
+        auto &grown_header = *reinterpret_cast<header *>(grown.bytes().data());
+        InitHeader(grown_header, capacity);
+        auto *grown_entries = reinterpret_cast<entry *>(grown.bytes().data() + sizeof(header));
+
+        const entry *entries = Entries();
+        for (uint64_t i = 0; i < Header().capacity_; ++i) {
+            if (entries[i].occupied_ == 0) {
+                continue;
+            }
+            for (uint64_t j = entries[i].id_.path_hash_ & (capacity - 1);;
+                 j = (j + 1) & (capacity - 1)) {
+                if (grown_entries[j].occupied_ == 0) {
+                    grown_entries[j] = entries[i];
+                    ++grown_header.count_;
+                    break;
+                }
+            }
+        }
+
+        grown.close();
+        map_.close();
+
+        std::filesystem::rename(grown_path, path_, ec);
+        if (ec || !map_.open_writable(path_) || !IsValid()) {
+            return Recreate(initial_capacity);
+        }
+        return true;
+    }
+
+    std::filesystem::path path_;
+    core::mapped_file map_;
+    mutable std::shared_mutex mutex_;
+};
+
+using theater_parse_cache = parse_cache<theater_file_data>;
+using carnage_parse_cache = parse_cache<carnage_report_rows>;
+
+// Rows of a carnage report, taken from cache when the file is unchanged and parsed (then stored)
+// otherwise. nullopt if the report can't be read or is malformed.
+inline std::optional<carnage_report_rows> ReadCarnageReportRows(
+    const std::filesystem::path &xml_file, carnage_parse_cache *cache = nullptr) {
+    std::optional<file_identity> id;
+    if ((cache != nullptr) && cache->IsOpen()) {
+        id = file_identity::Of(xml_file);
+        if (id.has_value()) {
+            auto rows = cache->Find(*id);
+            if (rows.has_value()) {
+                return rows;
+            }
+        }
+    }
+
+    auto report = LoadCarnageReport(xml_file);
+    if (!report.has_value()) {
+        return std::nullopt;
+    }
+
+    auto rows = GetCarnageReportRows(report.value());
+    if (id.has_value()) {
+        cache->Store(*id, rows);
+    }
+    return rows;
+}
+
+} // namespace file_readers
+} // namespace mccinfo
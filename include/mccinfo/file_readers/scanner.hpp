@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#if !defined(MCCINFO_NO_SIMD)
+#if defined(__AVX2__)
+#define MCCINFO_SCANNER_AVX2
+#define MCCINFO_SCANNER_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MCCINFO_SCANNER_SSE2
+#endif
+#endif
+
+#if defined(MCCINFO_SCANNER_AVX2)
+#include <immintrin.h>
+#elif defined(MCCINFO_SCANNER_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace mccinfo {
+namespace file_readers {
+namespace scanner {
+
+// Tables are never larger than this many slots inside any title's header region
+inline constexpr size_t max_player_slots = 64;
+
+struct player_table_scan {
+    uint64_t occupied_ = 0; // bit i is set if slot i holds a player
+    size_t slot_count_ = 0; // slots visited, including the terminating empty run
+};
+
+namespace details {
+
+inline bool IsPlayerTableMarker(std::span<const std::byte> region, size_t offset) {
+    auto byte_at = [&](size_t i) { return std::to_integer<uint8_t>(region[offset + i]); };
+
+    // {not zero, not zero, zero, zero} at the end of the 11 bytes following the \1
+    return (byte_at(8) != 0) && (byte_at(9) != 0) && (byte_at(10) == 0) && (byte_at(11) == 0);
+}
+
+// Bit i set if the first byte of slot i is zero
+inline uint64_t EmptySlotMask(std::span<const std::byte> region, size_t offset, size_t stride,
+                              size_t slots) {
+    uint64_t empty = 0;
+    size_t i = 0;
+
+#if defined(MCCINFO_SCANNER_AVX2)
+    // gather the leading dword of 8 slots at a time, then test their low bytes against zero
+    const __m256i lane_offsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i low_byte = _mm256_set1_epi32(0xFF);
+    const __m256i stride_v = _mm256_set1_epi32(static_cast<int>(stride));
+    for (; (i + 8) <= slots; i += 8) {
+        __m256i indices = _mm256_add_epi32(
+            _mm256_set1_epi32(static_cast<int>(offset + (i * stride))),
+            _mm256_mullo_epi32(lane_offsets, stride_v));
+        __m256i heads = _mm256_i32gather_epi32(reinterpret_cast<const int *>(region.data()),
+                                               indices, 1);
+        __m256i zero = _mm256_cmpeq_epi32(_mm256_and_si256(heads, low_byte),
+                                          _mm256_setzero_si256());
+        auto bits = static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(zero)));
+        empty |= bits << i;
+    }
+#endif
+
+    for (; i < slots; ++i) {
+        if (region[offset + (i * stride)] == std::byte{0}) {
+            empty |= (1ULL << i);
+        }
+    }
+
+    return empty;
+}
+
+} // namespace details
+
+/**
+ * @brief Finds the Halo 3 player table, which starts 24 bytes past the first \1 byte (from the
+ * third \1 after head_offset onward) that is followed by the marker pattern. Only \1 bytes in
+ * [head_offset, head_offset + scan_length) are considered.
+ */
+inline std::optional<size_t> FindPlayerTableAfterMarker(std::span<const std::byte> region,
+                                                        size_t head_offset, size_t scan_length) {
+    if (head_offset >= region.size()) {
+        return std::nullopt;
+    }
+    size_t scan_end = head_offset + std::min(scan_length, region.size() - head_offset);
+
+    unsigned int ones_found = 0;
+    auto visit_one = [&](size_t offset) -> std::optional<size_t> {
+        if (++ones_found < 3) {
+            return std::nullopt;
+        }
+        if ((offset + 12) > region.size()) {
+            return region.size();
+        }
+        if (details::IsPlayerTableMarker(region, offset)) {
+            return offset + 24;
+        }
+        return std::nullopt;
+    };
+
+    size_t offset = head_offset;
+
+#if defined(MCCINFO_SCANNER_SSE2)
+    const __m128i ones = _mm_set1_epi8(1);
+    for (; (offset + 16) <= scan_end; offset += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(region.data() + offset));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, ones)));
+        while (mask != 0) {
+            auto found = visit_one(offset + std::countr_zero(mask));
+            if (found.has_value()) {
+                return (found.value() < region.size()) ? found : std::nullopt;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; offset < scan_end; ++offset) {
+        if (region[offset] == std::byte{1}) {
+            auto found = visit_one(offset);
+            if (found.has_value()) {
+                return (found.value() < region.size()) ? found : std::nullopt;
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * @brief Classifies every slot of a player table in one pass: which slots hold a player and where
+ * the table ends (max_empty_slots consecutive empty slots, max_players players, or the region end).
+ */
+inline player_table_scan ScanPlayerTable(std::span<const std::byte> region, size_t offset,
+                                         size_t stride, size_t max_empty_slots,
+                                         size_t max_players) {
+    player_table_scan scan;
+    if ((offset > region.size()) || (stride == 0)) {
+        return scan;
+    }
+
+    size_t slots = std::min((region.size() - offset) / stride, max_player_slots);
+    if (slots == 0) {
+        return scan;
+    }
+
+    uint64_t valid = (slots == 64) ? ~0ULL : ((1ULL << slots) - 1);
+    uint64_t empty = details::EmptySlotMask(region, offset, stride, slots);
+
+    // bit i survives if slots [i, i + max_empty_slots) are all empty
+    uint64_t run_start = empty;
+    for (size_t k = 1; (k < max_empty_slots) && (run_start != 0); ++k) {
+        run_start &= empty >> k;
+    }
+
+    if (run_start != 0) {
+        auto first_run = static_cast<size_t>(std::countr_zero(run_start));
+        slots = first_run + std::max<size_t>(max_empty_slots, 1);
+        valid = (1ULL << first_run) - 1;
+    }
+
+    scan.occupied_ = ~empty & valid;
+    scan.slot_count_ = slots;
+
+    if ((max_players > 0) && (static_cast<size_t>(std::popcount(scan.occupied_)) > max_players)) {
+        uint64_t occupied = scan.occupied_;
+        for (size_t i = 0; i < max_players; ++i) {
+            occupied &= occupied - 1;
+        }
+        // occupied now holds the players past the limit; the scan ends at the first of them
+        auto last = static_cast<size_t>(std::countr_zero(occupied));
+        scan.occupied_ &= (1ULL << last) - 1;
+        scan.slot_count_ = last;
+    }
+
+    return scan;
+}
+
+} // namespace scanner
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,858 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mccinfo/core/mapped_file.hpp"
+#include "mccinfo/file_readers/carnage_report.hpp"
+#include "mccinfo/file_readers/medal_vector.hpp"
+#include "mccinfo/file_readers/scanner.hpp"
+
+namespace mccinfo {
+namespace file_readers {
+
+// Columns of the stats store, one row per player per match. The first carnage_player_stat::COUNT
+// mirror carnage_player_stat; GAMERTAG, MAP and GAMETYPE hold stats_store string ids.
+enum class stats_column : uint8_t {
+    MATCH = static_cast<uint8_t>(carnage_player_stat::COUNT), // ordinal of the appended match
+    GAME,
+    GAMERTAG,
+    MAP,
+    GAMETYPE,
+    COUNT,
+};
+
+inline constexpr size_t stats_column_count = static_cast<size_t>(stats_column::COUNT);
+
+constexpr stats_column StatsColumn(carnage_player_stat stat) {
+    return static_cast<stats_column>(stat);
+}
+
+// Rows whose column value lies in [min_, max_]
+struct stats_range {
+    stats_column column_;
+    int32_t min_ = std::numeric_limits<int32_t>::min();
+    int32_t max_ = std::numeric_limits<int32_t>::max();
+};
+
+// Every range must hold for a row to be counted
+using stats_filter = std::span<const stats_range>;
+
+// Min and max of every column over a run of rows
+struct stats_zone {
+    uint64_t first_row_ = 0;
+    uint64_t row_count_ = 0;
+    std::array<int32_t, stats_column_count> min_;
+    std::array<int32_t, stats_column_count> max_;
+};
+
+// Where a match's medals are in the medal file, and the row of its first player
+struct stats_medal_index {
+    uint64_t offset_ = 0;
+    uint64_t first_row_ = 0;
+};
+
+struct stats_group {
+    static constexpr size_t max_keys = 2;
+
+    std::array<int32_t, max_keys> keys_ = {};
+    uint64_t rows_ = 0;
+    std::vector<int64_t> sums_; // one per requested value column
+};
+
+namespace details {
+
+// Rows scanned at a time; a block's filter mask stays in L1
+inline constexpr size_t stats_block_rows = 2048;
+
+// Group by uses a dense table while the key space is at most this many slots
+inline constexpr uint64_t stats_dense_group_slots = uint64_t(1) << 20;
+
+// mask[i] = -1 if lo <= values[i] <= hi, and 0 otherwise; and_mask keeps rows already cleared
+inline void FilterRange(const int32_t *values, size_t count, int32_t lo, int32_t hi,
+                        int32_t *mask, bool and_mask) {
+    size_t i = 0;
+#if defined(MCCINFO_SCANNER_AVX2)
+    const __m256i lo_v = _mm256_set1_epi32(lo);
+    const __m256i hi_v = _mm256_set1_epi32(hi);
+    for (; (i + 8) <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+        __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(lo_v, v), _mm256_cmpgt_epi32(v, hi_v));
+        auto *dst = reinterpret_cast<__m256i *>(mask + i);
+        __m256i keep = and_mask ? _mm256_loadu_si256(dst) : _mm256_set1_epi32(-1);
+        _mm256_storeu_si256(dst, _mm256_andnot_si256(out, keep));
+    }
+#elif defined(MCCINFO_SCANNER_SSE2)
+    const __m128i lo_v = _mm_set1_epi32(lo);
+    const __m128i hi_v = _mm_set1_epi32(hi);
+    for (; (i + 4) <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        __m128i out = _mm_or_si128(_mm_cmplt_epi32(v, lo_v), _mm_cmpgt_epi32(v, hi_v));
+        auto *dst = reinterpret_cast<__m128i *>(mask + i);
+        __m128i keep = and_mask ? _mm_loadu_si128(dst) : _mm_set1_epi32(-1);
+        _mm_storeu_si128(dst, _mm_andnot_si128(out, keep));
+    }
+#endif
+    for (; i < count; ++i) {
+        int32_t in = ((values[i] >= lo) && (values[i] <= hi)) ? -1 : 0;
+        mask[i] = and_mask ? (mask[i] & in) : in;
+    }
+}
+
+// Sum of values[i] over the rows mask keeps, or over every row if mask is null
+inline int64_t SumColumn(const int32_t *values, const int32_t *mask, size_t count) {
+    int64_t sum = 0;
+    size_t i = 0;
+#if defined(MCCINFO_SCANNER_AVX2)
+    __m256i acc = _mm256_setzero_si256();
+    for (; (i + 8) <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+        if (mask != nullptr) {
+            auto keep = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask + i));
+            v = _mm256_and_si256(v, keep);
+        }
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(MCCINFO_SCANNER_SSE2)
+    // SSE2 has no sign extension to 64 bits; pair each value with its sign word instead
+    __m128i acc = _mm_setzero_si128();
+    for (; (i + 4) <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+        if (mask != nullptr) {
+            v = _mm_and_si128(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask + i)));
+        }
+        __m128i sign = _mm_srai_epi32(v, 31);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+    }
+    alignas(16) int64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes), acc);
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i < count; ++i) {
+        sum += (mask != nullptr) ? (values[i] & mask[i]) : values[i];
+    }
+    return sum;
+}
+
+// Rows mask keeps; the mask's -1 entries summed and negated
+inline uint64_t CountMask(const int32_t *mask, size_t count) {
+    return static_cast<uint64_t>(-SumColumn(mask, nullptr, count));
+}
+
+} // namespace details
+
+/**
+ * @brief A read only snapshot of a stats_store: its column files mapped, plus the zone maps of
+ * its sealed segments and of the rows after them. Aggregates skip segments the filter rules out
+ * by zone map, and only test the ranges a segment's zone does not already satisfy.
+ *
+ * Rows appended after the snapshot was taken are not seen; take another View for them.
+ */
+class stats_view {
+  public:
+    uint64_t RowCount() const {
+        return row_count_;
+    }
+
+    std::span<const int32_t> Column(stats_column column) const {
+        if (row_count_ == 0) {
+            return {};
+        }
+        auto bytes = columns_[static_cast<size_t>(column)].bytes();
+        return std::span<const int32_t>(reinterpret_cast<const int32_t *>(bytes.data()),
+                                        row_count_);
+    }
+    std::span<const int32_t> Column(carnage_player_stat stat) const {
+        return Column(StatsColumn(stat));
+    }
+
+    const std::vector<stats_zone> &Zones() const {
+        return zones_;
+    }
+
+    uint64_t Count(stats_filter filter = {}) const {
+        uint64_t count = 0;
+        Scan(filter, [&](uint64_t, size_t rows, const int32_t *mask) {
+            count += (mask != nullptr) ? details::CountMask(mask, rows) : rows;
+        });
+        return count;
+    }
+
+    int64_t Sum(stats_column column, stats_filter filter = {}) const {
+        auto values = Column(column);
+        int64_t sum = 0;
+        Scan(filter, [&](uint64_t first_row, size_t rows, const int32_t *mask) {
+            sum += details::SumColumn(values.data() + first_row, mask, rows);
+        });
+        return sum;
+    }
+
+    uint64_t MatchCount() const {
+        return medal_index_.size();
+    }
+
+    // The medals of match's players, one per row from its first row
+    medal_vector_view Medals(size_t match) const {
+        auto begin = medal_index_[match].offset_;
+        auto end = ((match + 1) < medal_index_.size()) ? medal_index_[match + 1].offset_
+                                                        : medal_bytes_.size();
+        auto first_row = medal_index_[match].first_row_;
+        auto last_row = ((match + 1) < medal_index_.size()) ? medal_index_[match + 1].first_row_
+                                                            : row_count_;
+        return medal_vector_view(medal_bytes_.subspan(begin, end - begin),
+                                 static_cast<size_t>(last_row - first_row));
+    }
+
+    // medal_id's count summed over the rows filter keeps
+    int64_t SumMedal(uint16_t medal_id, stats_filter filter = {}) const {
+        int64_t sum = 0;
+        if (filter.empty()) {
+            for (size_t match = 0; match < MatchCount(); ++match) {
+                sum += Medals(match).Sum(medal_id);
+            }
+            return sum;
+        }
+
+        Scan(filter, [&](uint64_t first_row, size_t rows, const int32_t *mask) {
+            // every match with a row in the block; the last may continue into the next one
+            auto it = std::upper_bound(medal_index_.begin(), medal_index_.end(), first_row,
+                                       [](uint64_t row, const stats_medal_index &match) {
+                                           return row < match.first_row_;
+                                       });
+            for (auto match = static_cast<size_t>(it - medal_index_.begin()) - 1;
+                 (match < MatchCount()) && (medal_index_[match].first_row_ < first_row + rows);
+                 ++match) {
+                uint64_t match_row = medal_index_[match].first_row_;
+                Medals(match).ForEachHolder(medal_id, [&](size_t player, int32_t count) {
+                    uint64_t row = match_row + player;
+                    if ((row >= first_row) && (row < first_row + rows) &&
+                        ((mask == nullptr) || (mask[row - first_row] != 0))) {
+                        sum += count;
+                    }
+                });
+            }
+        });
+        return sum;
+    }
+
+    // Row count and per column sums for every distinct combination of up to
+    // stats_group::max_keys key columns, ordered by key
+    std::vector<stats_group> GroupBy(std::span<const stats_column> keys,
+                                     std::span<const stats_column> values,
+                                     stats_filter filter = {}) const {
+        if (keys.empty() || (keys.size() > stats_group::max_keys) || zones_.empty()) {
+            return {};
+        }
+
+        std::array<std::span<const int32_t>, stats_group::max_keys> key_columns = {};
+        std::array<int32_t, stats_group::max_keys> key_min = {};
+        std::array<uint64_t, stats_group::max_keys> key_span = {1, 1};
+        for (size_t k = 0; k < keys.size(); ++k) {
+            auto c = static_cast<size_t>(keys[k]);
+            key_columns[k] = Column(keys[k]);
+            int32_t lo = zones_.front().min_[c];
+            int32_t hi = zones_.front().max_[c];
+            for (const auto &zone : zones_) {
+                lo = std::min(lo, zone.min_[c]);
+                hi = std::max(hi, zone.max_[c]);
+            }
+            key_min[k] = lo;
+            key_span[k] = static_cast<uint64_t>(static_cast<int64_t>(hi) - lo) + 1;
+        }
+
+        std::vector<const int32_t *> value_columns;
+        for (auto column : values) {
+            value_columns.push_back(Column(column).data());
+        }
+        size_t value_count = value_columns.size();
+
+        // Slot of a row: its keys relative to their minimums, as one number
+        auto slot_of = [&](uint64_t row) {
+            uint64_t slot = static_cast<uint64_t>(static_cast<int64_t>(key_columns[0][row]) -
+                                                  key_min[0]);
+            if (keys.size() > 1) {
+                slot = (slot * key_span[1]) +
+                       static_cast<uint64_t>(static_cast<int64_t>(key_columns[1][row]) -
+                                             key_min[1]);
+            }
+            return slot;
+        };
+
+        constexpr uint64_t dense_slots = details::stats_dense_group_slots;
+        bool dense = (key_span[0] <= dense_slots) && (key_span[1] <= dense_slots) &&
+                     ((key_span[0] * key_span[1]) <= dense_slots);
+        uint64_t slot_count = dense ? (key_span[0] * key_span[1]) : 0;
+
+        // Dense: slots index the tables directly. Sparse: slots map to a group index first.
+        std::unordered_map<uint64_t, size_t> sparse_groups;
+        std::vector<uint64_t> group_slots;
+        std::vector<uint64_t> rows(slot_count);
+        std::vector<int64_t> sums(slot_count * value_count);
+
+        Scan(filter, [&](uint64_t first_row, size_t count, const int32_t *mask) {
+            for (size_t i = 0; i < count; ++i) {
+                if ((mask != nullptr) && (mask[i] == 0)) {
+                    continue;
+                }
+                uint64_t row = first_row + i;
+                uint64_t group = slot_of(row);
+                if (!dense) {
+                    auto [it, added] = sparse_groups.try_emplace(group, group_slots.size());
+                    if (added) {
+                        group_slots.push_back(group);
+                        rows.push_back(0);
+                        sums.resize(sums.size() + value_count);
+                    }
+                    group = it->second;
+                }
+                ++rows[group];
+                int64_t *group_sums = sums.data() + (group * value_count);
+                for (size_t v = 0; v < value_count; ++v) {
+                    group_sums[v] += value_columns[v][row];
+                }
+            }
+        });
+
+        std::vector<size_t> order;
+        if (dense) {
+            for (size_t slot = 0; slot < rows.size(); ++slot) {
+                if (rows[slot] != 0) {
+                    order.push_back(slot);
+                }
+            }
+        } else {
+            order.resize(group_slots.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(),
+                      [&](size_t a, size_t b) { return group_slots[a] < group_slots[b]; });
+        }
+
+        std::vector<stats_group> groups;
+        groups.reserve(order.size());
+        for (size_t group : order) {
+            uint64_t slot = dense ? group : group_slots[group];
+            stats_group &out = groups.emplace_back();
+            if (keys.size() > 1) {
+                auto offset = static_cast<int64_t>(slot % key_span[1]);
+                out.keys_[1] = static_cast<int32_t>(key_min[1] + offset);
+                slot /= key_span[1];
+            }
+            out.keys_[0] = static_cast<int32_t>(key_min[0] + static_cast<int64_t>(slot));
+            out.rows_ = rows[group];
+            out.sums_.assign(sums.begin() + (group * value_count),
+                             sums.begin() + ((group + 1) * value_count));
+        }
+        return groups;
+    }
+
+  private:
+    friend class stats_store;
+
+    // Calls block(first_row, rows, mask) for every block of rows that may pass filter; mask is
+    // null when the segment's zone map shows every row passes
+    template <typename Block>
+    void Scan(stats_filter filter, Block &&block) const {
+        std::vector<stats_range> partial;
+        std::vector<int32_t> mask(details::stats_block_rows);
+
+        for (const auto &zone : zones_) {
+            partial.clear();
+            bool skip = false;
+            for (const auto &range : filter) {
+                auto c = static_cast<size_t>(range.column_);
+                if ((zone.max_[c] < range.min_) || (zone.min_[c] > range.max_)) {
+                    skip = true;
+                    break;
+                }
+                if ((zone.min_[c] < range.min_) || (zone.max_[c] > range.max_)) {
+                    partial.push_back(range);
+                }
+            }
+            if (skip) {
+                continue;
+            }
+
+            uint64_t end = zone.first_row_ + zone.row_count_;
+            for (uint64_t row = zone.first_row_; row < end; row += details::stats_block_rows) {
+                auto rows = static_cast<size_t>(std::min<uint64_t>(details::stats_block_rows,
+                                                                   end - row));
+                if (partial.empty()) {
+                    block(row, rows, nullptr);
+                    continue;
+                }
+                for (size_t p = 0; p < partial.size(); ++p) {
+                    details::FilterRange(Column(partial[p].column_).data() + row, rows,
+                                         partial[p].min_, partial[p].max_, mask.data(), p != 0);
+                }
+                block(row, rows, mask.data());
+            }
+        }
+    }
+
+    uint64_t row_count_ = 0;
+    std::array<core::mapped_file, stats_column_count> columns_;
+    std::vector<stats_zone> zones_;
+    core::mapped_file medal_file_;
+    core::mapped_file medal_index_file_;
+    std::span<const uint8_t> medal_bytes_;
+    std::span<const stats_medal_index> medal_index_;
+};
+
+/**
+ * @brief Append only, columnar store of carnage report stats: one file of int32 values per
+ * column, a dictionary file for gamertags, maps and gametypes, the zone maps of sealed
+ * segments of segment_rows rows, and each match's medals as a medal_vector. Queries run on a
+ * stats_view, which maps the columns.
+ *
+ * A small manifest, replaced by rename after each append, records how much of every file is
+ * committed; Open discards anything written past it, so an interrupted append leaves the store
+ * as it was before. One writer at a time; Views may be taken from any thread.
+ */
+class stats_store {
+  public:
+    static constexpr uint32_t version = 2;
+    static constexpr uint64_t segment_rows = 1 << 16;
+
+    stats_store() = default;
+    stats_store(const stats_store &) = delete;
+    stats_store &operator=(const stats_store &) = delete;
+
+    // Opens the store in root, starting a fresh one if it is missing or from another version
+    bool Open(const std::filesystem::path &root) {
+        std::unique_lock lock(mutex_);
+        return OpenLocked(root);
+    }
+
+    void Close() {
+        std::unique_lock lock(mutex_);
+        CloseLocked();
+    }
+
+    bool IsOpen() const {
+        std::shared_lock lock(mutex_);
+        return is_open_;
+    }
+
+    uint64_t RowCount() const {
+        std::shared_lock lock(mutex_);
+        return manifest_.row_count_;
+    }
+
+    uint32_t MatchCount() const {
+        std::shared_lock lock(mutex_);
+        return manifest_.match_count_;
+    }
+
+    std::optional<int32_t> StringId(std::string_view text) const {
+        std::shared_lock lock(mutex_);
+        auto it = string_ids_.find(text);
+        if (it == string_ids_.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    // A copy, since a failed Append rolls back by reopening the store, which drops its strings
+    std::string String(int32_t id) const {
+        std::shared_lock lock(mutex_);
+        if ((id < 0) || (static_cast<size_t>(id) >= strings_.size())) {
+            return {};
+        }
+        return strings_[static_cast<size_t>(id)];
+    }
+
+    // Adds a row per player of report, played on map. On failure the store is rolled back to
+    // its last committed append.
+    bool Append(const carnage_report &report, std::string_view map) {
+        std::unique_lock lock(mutex_);
+        if (!is_open_) {
+            return false;
+        }
+        if (report.PlayerCount() == 0) {
+            return true;
+        }
+
+        size_t players = report.PlayerCount();
+        auto match = static_cast<int32_t>(manifest_.match_count_);
+        auto map_id = Intern(map);
+        auto gametype_id = Intern(UnescapeXML(report.header_.gametype_name_));
+
+        std::vector<int32_t> gamertag_ids(players);
+        for (size_t i = 0; i < players; ++i) {
+            gamertag_ids[i] = Intern(UnescapeXML(report.Text(carnage_player_text::GAMERTAG, i)));
+        }
+
+        std::vector<int32_t> values(players);
+        for (size_t c = 0; c < stats_column_count; ++c) {
+            auto column = static_cast<stats_column>(c);
+            if (c < static_cast<size_t>(carnage_player_stat::COUNT)) {
+                auto stat = report.Stat(static_cast<carnage_player_stat>(c));
+                std::copy(stat.begin(), stat.end(), values.begin());
+            } else if (column == stats_column::GAMERTAG) {
+                values = gamertag_ids;
+            } else {
+                int32_t value = (column == stats_column::MATCH) ? match
+                                : (column == stats_column::GAME) ? report.header_.game_enum_
+                                : (column == stats_column::MAP)  ? map_id
+                                                                 : gametype_id;
+                std::fill(values.begin(), values.end(), value);
+            }
+
+            column_files_[c].write(reinterpret_cast<const char *>(values.data()),
+                                   static_cast<std::streamsize>(players * sizeof(int32_t)));
+            tail_[c].insert(tail_[c].end(), values.begin(), values.end());
+        }
+
+        medals_.Clear();
+        medals_.Append(report);
+        stats_medal_index index{manifest_.medals_size_, manifest_.row_count_};
+        medal_index_file_.write(reinterpret_cast<const char *>(&index), sizeof(index));
+        medal_file_.write(reinterpret_cast<const char *>(medals_.Bytes().data()),
+                          static_cast<std::streamsize>(medals_.Bytes().size()));
+        manifest_.medals_size_ += medals_.Bytes().size();
+
+        bool written = WriteStrings() && medal_file_.flush() && medal_index_file_.flush();
+        for (auto &file : column_files_) {
+            written &= static_cast<bool>(file.flush());
+        }
+
+        manifest_.row_count_ += players;
+        ++manifest_.match_count_;
+        while (written && (tail_[0].size() >= segment_rows)) {
+            written = Seal();
+        }
+
+        if (!written || !WriteManifest()) {
+            OpenLocked(root_);
+            return false;
+        }
+        return true;
+    }
+
+    stats_view View() const {
+        std::shared_lock lock(mutex_);
+
+        stats_view view;
+        if (!is_open_ || (manifest_.row_count_ == 0)) {
+            return view;
+        }
+        for (size_t c = 0; c < stats_column_count; ++c) {
+            if (!view.columns_[c].open(ColumnPath(c)) ||
+                (view.columns_[c].size() < (manifest_.row_count_ * sizeof(int32_t)))) {
+                return stats_view();
+            }
+        }
+        if (!view.medal_file_.open(MedalsPath()) ||
+            (view.medal_file_.size() < manifest_.medals_size_) ||
+            !view.medal_index_file_.open(MedalIndexPath()) ||
+            (view.medal_index_file_.size() <
+             (manifest_.match_count_ * sizeof(stats_medal_index)))) {
+            return stats_view();
+        }
+        view.medal_bytes_ = std::span(
+            reinterpret_cast<const uint8_t *>(view.medal_file_.bytes().data()),
+            static_cast<size_t>(manifest_.medals_size_));
+        view.medal_index_ = std::span(
+            reinterpret_cast<const stats_medal_index *>(view.medal_index_file_.bytes().data()),
+            manifest_.match_count_);
+        view.row_count_ = manifest_.row_count_;
+        view.zones_ = zones_;
+        if (!tail_[0].empty()) {
+            view.zones_.push_back(TailZone(tail_[0].size()));
+        }
+        return view;
+    }
+
+  private:
+    struct manifest {
+        char magic_[8];
+        uint32_t version_;
+        uint32_t column_count_;
+        uint64_t segment_rows_;
+        uint64_t row_count_;
+        uint64_t strings_size_; // committed bytes of the dictionary file
+        uint32_t string_count_;
+        uint32_t match_count_;
+        uint64_t zone_count_;
+        uint64_t medals_size_; // committed bytes of the medal file
+    };
+
+    static constexpr char magic[8] = {'M', 'C', 'C', 'I', 'S', 'T', 'A', 'T'};
+
+    std::filesystem::path ColumnPath(size_t column) const {
+        return root_ / ("column_" + std::to_string(column) + ".i32");
+    }
+    std::filesystem::path StringsPath() const {
+        return root_ / "strings.dict";
+    }
+    std::filesystem::path MedalsPath() const {
+        return root_ / "medals.bin";
+    }
+    std::filesystem::path MedalIndexPath() const {
+        return root_ / "medal_index.bin";
+    }
+    std::filesystem::path ZonesPath() const {
+        return root_ / "zones.bin";
+    }
+    std::filesystem::path ManifestPath() const {
+        return root_ / "manifest.bin";
+    }
+
+    bool OpenLocked(const std::filesystem::path &root) {
+        CloseLocked();
+        root_ = root;
+
+        std::error_code ec;
+        std::filesystem::create_directories(root_, ec);
+        if (ec) {
+            return false;
+        }
+
+        if (!ReadManifest() || !Load()) {
+            Reset();
+            if (!WriteManifest() || !Load()) {
+                return false;
+            }
+        }
+
+        for (size_t c = 0; c < stats_column_count; ++c) {
+            column_files_[c].open(ColumnPath(c), std::ios::binary | std::ios::app);
+        }
+        strings_file_.open(StringsPath(), std::ios::binary | std::ios::app);
+        zones_file_.open(ZonesPath(), std::ios::binary | std::ios::app);
+        medal_file_.open(MedalsPath(), std::ios::binary | std::ios::app);
+        medal_index_file_.open(MedalIndexPath(), std::ios::binary | std::ios::app);
+
+        is_open_ = strings_file_.is_open() && zones_file_.is_open() && medal_file_.is_open() &&
+                   medal_index_file_.is_open() &&
+                   std::all_of(column_files_.begin(), column_files_.end(),
+                               [](const std::ofstream &file) { return file.is_open(); });
+        if (!is_open_) {
+            CloseLocked();
+        }
+        return is_open_;
+    }
+
+    void CloseLocked() {
+        for (auto &file : column_files_) {
+            file.close();
+            file.clear();
+        }
+        strings_file_.close();
+        strings_file_.clear();
+        zones_file_.close();
+        zones_file_.clear();
+        medal_file_.close();
+        medal_file_.clear();
+        medal_index_file_.close();
+        medal_index_file_.clear();
+        is_open_ = false;
+        Reset();
+    }
+
+    void Reset() {
+        std::memcpy(manifest_.magic_, magic, sizeof(magic));
+        manifest_.version_ = version;
+        manifest_.column_count_ = static_cast<uint32_t>(stats_column_count);
+        manifest_.segment_rows_ = segment_rows;
+        manifest_.row_count_ = 0;
+        manifest_.strings_size_ = 0;
+        manifest_.string_count_ = 0;
+        manifest_.match_count_ = 0;
+        manifest_.zone_count_ = 0;
+        manifest_.medals_size_ = 0;
+        strings_.clear();
+        string_ids_.clear();
+        pending_strings_.clear();
+        zones_.clear();
+        for (auto &tail : tail_) {
+            tail.clear();
+        }
+    }
+
+    bool ReadManifest() {
+        std::ifstream ifs(ManifestPath(), std::ios::binary);
+        if (!ifs.read(reinterpret_cast<char *>(&manifest_), sizeof(manifest_))) {
+            return false;
+        }
+        return (std::memcmp(manifest_.magic_, magic, sizeof(magic)) == 0) &&
+               (manifest_.version_ == version) &&
+               (manifest_.column_count_ == stats_column_count) &&
+               (manifest_.segment_rows_ == segment_rows) &&
+               (manifest_.zone_count_ * segment_rows <= manifest_.row_count_);
+    }
+
+    bool WriteManifest() {
+        auto staged = ManifestPath();
+        staged += ".tmp";
+        {
+            std::ofstream ofs(staged, std::ios::binary | std::ios::trunc);
+            if (!ofs.write(reinterpret_cast<const char *>(&manifest_), sizeof(manifest_)) ||
+                !ofs.flush()) {
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(staged, ManifestPath(), ec);
+        return !ec;
+    }
+
+    // Truncates every file to what the manifest committed, then reads the dictionary, the zone
+    // maps and the unsealed rows back in
+    bool Load() {
+        auto truncate = [](const std::filesystem::path &path, uint64_t size) {
+            std::error_code ec;
+            if (!std::filesystem::exists(path, ec)) {
+                std::ofstream create(path, std::ios::binary);
+            }
+            if ((std::filesystem::file_size(path, ec) < size) || ec) {
+                return false;
+            }
+            std::filesystem::resize_file(path, size, ec);
+            return !ec;
+        };
+
+        uint64_t column_size = manifest_.row_count_ * sizeof(int32_t);
+        for (size_t c = 0; c < stats_column_count; ++c) {
+            if (!truncate(ColumnPath(c), column_size)) {
+                return false;
+            }
+        }
+        if (!truncate(StringsPath(), manifest_.strings_size_) ||
+            !truncate(ZonesPath(), manifest_.zone_count_ * sizeof(stats_zone)) ||
+            !truncate(MedalsPath(), manifest_.medals_size_) ||
+            !truncate(MedalIndexPath(), manifest_.match_count_ * sizeof(stats_medal_index))) {
+            return false;
+        }
+
+        std::ifstream strings(StringsPath(), std::ios::binary);
+        for (uint32_t i = 0; i < manifest_.string_count_; ++i) {
+            uint32_t size = 0;
+            if (!strings.read(reinterpret_cast<char *>(&size), sizeof(size))) {
+                return false;
+            }
+            std::string text(size, '\0');
+            if (!strings.read(text.data(), size)) {
+                return false;
+            }
+            strings_.push_back(std::move(text));
+            string_ids_.emplace(strings_.back(), static_cast<int32_t>(i));
+        }
+
+        zones_.resize(manifest_.zone_count_);
+        std::ifstream zones(ZonesPath(), std::ios::binary);
+        if (!zones.read(reinterpret_cast<char *>(zones_.data()),
+                        static_cast<std::streamsize>(zones_.size() * sizeof(stats_zone)))) {
+            return false;
+        }
+
+        uint64_t sealed_rows = manifest_.zone_count_ * segment_rows;
+        auto tail_rows = static_cast<size_t>(manifest_.row_count_ - sealed_rows);
+        for (size_t c = 0; c < stats_column_count; ++c) {
+            tail_[c].resize(tail_rows);
+            std::ifstream column(ColumnPath(c), std::ios::binary);
+            column.seekg(static_cast<std::streamoff>(sealed_rows * sizeof(int32_t)));
+            if (!column.read(reinterpret_cast<char *>(tail_[c].data()),
+                             static_cast<std::streamsize>(tail_rows * sizeof(int32_t)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int32_t Intern(std::string_view text) {
+        auto it = string_ids_.find(text);
+        if (it != string_ids_.end()) {
+            return it->second;
+        }
+        auto id = static_cast<int32_t>(strings_.size());
+        strings_.emplace_back(text);
+        string_ids_.emplace(strings_.back(), id);
+        pending_strings_.push_back(id);
+        return id;
+    }
+
+    bool WriteStrings() {
+        for (int32_t id : pending_strings_) {
+            const auto &text = strings_[static_cast<size_t>(id)];
+            auto size = static_cast<uint32_t>(text.size());
+            strings_file_.write(reinterpret_cast<const char *>(&size), sizeof(size));
+            strings_file_.write(text.data(), static_cast<std::streamsize>(text.size()));
+            manifest_.strings_size_ += sizeof(size) + text.size();
+            ++manifest_.string_count_;
+        }
+        pending_strings_.clear();
+        return static_cast<bool>(strings_file_.flush());
+    }
+
+    stats_zone TailZone(size_t rows) const {
+        stats_zone zone;
+        zone.first_row_ = manifest_.zone_count_ * segment_rows;
+        zone.row_count_ = rows;
+        for (size_t c = 0; c < stats_column_count; ++c) {
+            auto [lo, hi] = std::minmax_element(tail_[c].begin(), tail_[c].begin() + rows);
+            zone.min_[c] = *lo;
+            zone.max_[c] = *hi;
+        }
+        return zone;
+    }
+
+    // Closes the first segment_rows unsealed rows into a segment with a zone map
+    bool Seal() {
+        auto zone = TailZone(segment_rows);
+        zones_file_.write(reinterpret_cast<const char *>(&zone), sizeof(zone));
+        if (!zones_file_.flush()) {
+            return false;
+        }
+        zones_.push_back(zone);
+        ++manifest_.zone_count_;
+        for (auto &tail : tail_) {
+            tail.erase(tail.begin(), tail.begin() + segment_rows);
+        }
+        return true;
+    }
+
+    std::filesystem::path root_;
+    bool is_open_ = false;
+    manifest manifest_ = {};
+
+    std::deque<std::string> strings_; // a deque so the string_id_ keys stay put
+    std::unordered_map<std::string_view, int32_t> string_ids_;
+    std::vector<int32_t> pending_strings_; // interned since the last append was committed
+
+    std::vector<stats_zone> zones_;
+    std::array<std::vector<int32_t>, stats_column_count> tail_; // rows after the last segment
+
+    std::array<std::ofstream, stats_column_count> column_files_;
+    std::ofstream strings_file_;
+    std::ofstream zones_file_;
+    std::ofstream medal_file_;
+    std::ofstream medal_index_file_;
+    medal_vector medals_; // the appended match's, encoded before it is written
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace mccinfo {
+namespace file_readers {
+
+/**
+ * @brief Null terminated UTF-8 string stored inline. Holds at most Capacity - 1 bytes; longer
+ * input is cut at the last whole code point that fits.
+ */
+template <size_t Capacity>
+class fixed_string {
+    static_assert((Capacity > 1) && (Capacity <= 0xFFFF));
+
+  public:
+    using size_type = std::conditional_t<(Capacity <= 0xFF), uint8_t, uint16_t>;
+
+    fixed_string() = default;
+    fixed_string(std::string_view str) {
+        assign(str);
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity - 1;
+    }
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return (size_ == 0);
+    }
+    const char *c_str() const {
+        return data_;
+    }
+    std::string_view view() const {
+        return std::string_view(data_, size_);
+    }
+    operator std::string_view() const {
+        return view();
+    }
+
+    // Writable storage for decoders; follow with resize() to commit what was written
+    std::span<char> buffer() {
+        return std::span<char>(data_, capacity());
+    }
+    void resize(size_t size) {
+        size_ = static_cast<size_type>(std::min(size, capacity()));
+        data_[size_] = '\0';
+    }
+
+    void assign(std::string_view str) {
+        size_t size = std::min(str.size(), capacity());
+        if (size < str.size()) {
+            // don't leave a partial code point behind
+            while ((size > 0) && ((static_cast<unsigned char>(str[size]) & 0xC0) == 0x80)) {
+                --size;
+            }
+        }
+        std::copy_n(str.data(), size, data_);
+        resize(size);
+    }
+
+    friend bool operator==(const fixed_string &lhs, const fixed_string &rhs) {
+        return lhs.view() == rhs.view();
+    }
+    friend auto operator<=>(const fixed_string &lhs, const fixed_string &rhs) {
+        return lhs.view() <=> rhs.view();
+    }
+
+  private:
+    char data_[Capacity] = {};
+    size_type size_ = 0;
+};
+
+struct player_info {
+    int8_t team_ = 0; // -1 for the film author
+    fixed_string<49> name_; // 16 UTF-16 code units
+
+    friend bool operator==(const player_info &, const player_info &) = default;
+    friend auto operator<=>(const player_info &lhs, const player_info &rhs) {
+        if (auto cmp = (lhs.team_ <=> rhs.team_); cmp != 0) {
+            return cmp;
+        }
+        return lhs.name_ <=> rhs.name_;
+    }
+};
+
+/**
+ * @brief Players ordered by (team, name) without duplicates, stored inline. Sixteen players plus
+ * the film author always fit; anything past capacity is dropped.
+ */
+class player_roster {
+  public:
+    static constexpr size_t capacity = 24;
+
+    using const_iterator = const player_info *;
+
+    bool insert(int team, std::string_view name) {
+        player_info player;
+        player.team_ = static_cast<int8_t>(team);
+        player.name_.assign(name);
+        return insert(player);
+    }
+
+    bool insert(const player_info &player) {
+        auto it = std::lower_bound(begin(), end(), player);
+        if (((it != end()) && (*it == player)) || (size_ == capacity)) {
+            return false;
+        }
+
+        auto index = static_cast<size_t>(it - begin());
+        std::copy_backward(players_.begin() + index, players_.begin() + size_,
+                           players_.begin() + size_ + 1);
+        players_[index] = player;
+        ++size_;
+        return true;
+    }
+
+    void clear() {
+        size_ = 0;
+    }
+
+    const_iterator begin() const {
+        return players_.data();
+    }
+    const_iterator end() const {
+        return players_.data() + size_;
+    }
+    size_t size() const {
+        return size_;
+    }
+    bool empty() const {
+        return (size_ == 0);
+    }
+
+  private:
+    std::array<player_info, capacity> players_ = {};
+    uint8_t size_ = 0;
+};
+
+// Selects the members of theater_file_data a read decodes; see theater_file_reader::Read
+enum theater_file_fields : uint32_t {
+    FIELD_GAMETYPE      = 1u << 0,
+    FIELD_DESC          = 1u << 1,
+    FIELD_AUTHOR_XUID   = 1u << 2,
+    FIELD_AUTHOR        = 1u << 3,
+    FIELD_UTC_TIMESTAMP = 1u << 4,
+    FIELD_PLAYER_SET    = 1u << 5,
+    FIELD_ALL           = (1u << 6) - 1,
+};
+
+struct theater_file_data {
+    fixed_string<256> gametype_;
+    fixed_string<256> desc_;
+    fixed_string<20> author_xuid_; // "0x" + 16 hex digits
+    fixed_string<20> author_;
+    player_roster player_set_;
+    std::filesystem::file_time_type::rep utc_timestamp_ = 0; // file_clock ticks, 0 if unknown
+
+    std::filesystem::file_time_type UTCTimestamp() const {
+        using duration = std::filesystem::file_time_type::duration;
+        return std::filesystem::file_time_type(duration(utc_timestamp_));
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<theater_file_data>);
+
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#undef NOMINMAX
+#endif
+
+namespace mccinfo {
+namespace file_readers {
+
+#if defined(_WIN32)
+inline bool IsLeapSecondsEnabled(void) {
+    std::wstring regSubKey = L"SYSTEM\\CurrentControlSet\\Control\\LeapSecondInformation";
+    std::wstring regValue(L"Enabled");
+    DWORD val;
+    DWORD dataSize = sizeof(val);
+    if (ERROR_SUCCESS == RegGetValueW(HKEY_LOCAL_MACHINE, regSubKey.c_str(), regValue.c_str(),
+                                      RRF_RT_DWORD, nullptr /*type not required*/, &val, &dataSize))
+        return val == (DWORD)1;
+    return false;
+}
+
+inline unsigned int GetSystemAccountedLeapSeconds(void) {
+    if (IsLeapSecondsEnabled()) {
+        std::wstring regSubKey = L"SYSTEM\\CurrentControlSet\\Control\\LeapSecondInformation";
+        std::wstring regValue(L"LeapSeconds");
+        DWORD val = 0;
+        DWORD dataSize = sizeof(val);
+        if (ERROR_SUCCESS == RegGetValueW(HKEY_LOCAL_MACHINE, regSubKey.c_str(), regValue.c_str(),
+                                          RRF_RT_REG_BINARY, nullptr /*type not required*/, &val,
+                                          &dataSize))
+            return val;
+    }
+    return 0;
+}
+#endif
+
+/**
+ * @brief Everything needed to turn the local wall clock time written into a film description
+ * into a file_time_type. Computed once (see System()) and passed to the decoders, so parsing
+ * never touches the registry, and tests can pin it.
+ *
+ * A captured context looks up the UTC offset in effect at each film's own time, so films recorded
+ * on the other side of a daylight saving change still convert correctly. A pinned utc_offset_ is
+ * used as is.
+ */
+struct clock_context {
+    std::chrono::seconds utc_offset_{0};   // local time - UTC, daylight saving included
+    std::chrono::seconds leap_seconds_{0}; // added to UTC before converting to file time
+    bool local_zone_ = false; // ask the system time zone instead of using utc_offset_
+
+    static clock_context Capture() {
+        clock_context ctx;
+
+        std::time_t now = std::time(nullptr);
+        std::tm local = {};
+        std::tm utc = {};
+#if defined(_WIN32)
+        localtime_s(&local, &now);
+        gmtime_s(&utc, &now);
+#else
+        localtime_r(&now, &local);
+        gmtime_r(&now, &utc);
+#endif
+        // mktime reads both as local time, so the difference is exactly the offset from UTC
+        local.tm_isdst = 0;
+        utc.tm_isdst = 0;
+        ctx.utc_offset_ = std::chrono::seconds(
+            static_cast<long long>(std::difftime(std::mktime(&local), std::mktime(&utc))));
+        ctx.local_zone_ = true;
+
+#if defined(_MSC_VER)
+        ctx.leap_seconds_ = std::filesystem::_File_time_clock::_Skipped_filetime_leap_seconds -
+                            std::chrono::seconds(GetSystemAccountedLeapSeconds());
+#endif
+        return ctx;
+    }
+
+    // Captured on first use and shared by every reader for the lifetime of the process
+    static const clock_context &System() {
+        static const clock_context ctx = Capture();
+        return ctx;
+    }
+
+    // local time - UTC at local_time; utc_offset_ if the system can't tell
+    std::chrono::seconds UTCOffsetAt(std::chrono::sys_seconds local_time) const {
+        if (!local_zone_) {
+            return utc_offset_;
+        }
+
+        std::time_t local_seconds = static_cast<std::time_t>(local_time.time_since_epoch().count());
+        std::tm fields = {};
+#if defined(_WIN32)
+        if (gmtime_s(&fields, &local_seconds) != 0) {
+            return utc_offset_;
+        }
+
+        SYSTEMTIME local = {};
+        local.wYear = static_cast<WORD>(fields.tm_year + 1900);
+        local.wMonth = static_cast<WORD>(fields.tm_mon + 1);
+        local.wDay = static_cast<WORD>(fields.tm_mday);
+        local.wHour = static_cast<WORD>(fields.tm_hour);
+        local.wMinute = static_cast<WORD>(fields.tm_min);
+        local.wSecond = static_cast<WORD>(fields.tm_sec);
+
+        SYSTEMTIME utc = {};
+        FILETIME utc_file_time = {};
+        if (!TzSpecificLocalTimeToSystemTime(nullptr, &local, &utc) ||
+            !SystemTimeToFileTime(&utc, &utc_file_time)) {
+            return utc_offset_;
+        }
+
+        // FILETIME counts 100ns ticks from 1601-01-01
+        auto ticks = (static_cast<int64_t>(utc_file_time.dwHighDateTime) << 32) |
+                     utc_file_time.dwLowDateTime;
+        auto utc_seconds = (ticks / 10000000) - 11644473600;
+#else
+        if (gmtime_r(&local_seconds, &fields) == nullptr) {
+            return utc_offset_;
+        }
+
+        // mktime reads the fields as local time and works out whether daylight saving applies
+        fields.tm_isdst = -1;
+        std::time_t utc_seconds = std::mktime(&fields);
+        if (utc_seconds == static_cast<std::time_t>(-1)) {
+            return utc_offset_;
+        }
+#endif
+        return std::chrono::seconds(static_cast<long long>(local_seconds - utc_seconds));
+    }
+
+    std::filesystem::file_time_type ToFileTime(std::chrono::sys_seconds local_time) const {
+        auto utc = local_time.time_since_epoch() - UTCOffsetAt(local_time) + leap_seconds_;
+#if defined(_MSC_VER)
+        return std::chrono::file_clock::from_utc(std::chrono::utc_time<std::chrono::seconds>(utc));
+#else
+        return std::chrono::time_point_cast<std::filesystem::file_time_type::duration>(
+            std::chrono::file_clock::from_sys(std::chrono::sys_seconds(utc)));
+#endif
+    }
+};
+
+namespace details {
+
+inline bool ParseDigits(std::string_view text, size_t &pos, size_t min_digits, size_t max_digits,
+                        int &value) {
+    size_t start = pos;
+    value = 0;
+    while ((pos < text.size()) && ((pos - start) < max_digits) && (text[pos] >= '0') &&
+           (text[pos] <= '9')) {
+        value = (value * 10) + (text[pos++] - '0');
+    }
+    return (pos - start) >= min_digits;
+}
+
+inline bool ParseLiteral(std::string_view text, size_t &pos, char c) {
+    if ((pos < text.size()) && (text[pos] == c)) {
+        ++pos;
+        return true;
+    }
+    return false;
+}
+
+inline size_t SkipLetters(std::string_view text, size_t pos) {
+    while ((pos < text.size()) && (((text[pos] | 0x20) >= 'a') && ((text[pos] | 0x20) <= 'z'))) {
+        ++pos;
+    }
+    return pos;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+inline constexpr int64_t DaysFromCivil(int y, unsigned m, unsigned d) {
+    y -= (m <= 2);
+    const int64_t era = ((y >= 0) ? y : (y - 399)) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - (era * 400));
+    const unsigned doy = ((153 * ((m > 2) ? (m - 3) : (m + 9))) + 2) / 5 + d - 1;
+    const unsigned doe = (yoe * 365) + (yoe / 4) - (yoe / 100) + doy;
+    return (era * 146097) + static_cast<int64_t>(doe) - 719468;
+}
+
+} // namespace details
+
+/**
+ * @brief Parses "Weekday Month DD, YYYY HH:MM:SS" (e.g. "Friday February 16, 2024 17:02:42").
+ * The weekday is not validated; the result is the wall clock time as if it were UTC. Years outside
+ * [1970, 2200) are rejected.
+ */
+inline std::optional<std::chrono::sys_seconds> ParseTheaterTimestamp(std::string_view text) {
+    static constexpr std::array<std::string_view, 12> months = {
+        "jan", "feb", "mar", "apr", "may", "jun", "jul", "aug", "sep", "oct", "nov", "dec"};
+
+    size_t pos = details::SkipLetters(text, 0);
+    if ((pos == 0) || !details::ParseLiteral(text, pos, ' ')) {
+        return std::nullopt;
+    }
+
+    size_t month_end = details::SkipLetters(text, pos);
+    if ((month_end - pos) < 3) {
+        return std::nullopt;
+    }
+    unsigned month = 0;
+    for (unsigned i = 0; i < months.size(); ++i) {
+        if (((text[pos] | 0x20) == months[i][0]) && ((text[pos + 1] | 0x20) == months[i][1]) &&
+            ((text[pos + 2] | 0x20) == months[i][2])) {
+            month = i + 1;
+            break;
+        }
+    }
+    pos = month_end;
+
+    int day, year, hour, minute, second;
+    if ((month == 0) || !details::ParseLiteral(text, pos, ' ') ||
+        !details::ParseDigits(text, pos, 1, 2, day) || !details::ParseLiteral(text, pos, ',') ||
+        !details::ParseLiteral(text, pos, ' ') || !details::ParseDigits(text, pos, 4, 4, year) ||
+        !details::ParseLiteral(text, pos, ' ') || !details::ParseDigits(text, pos, 1, 2, hour) ||
+        !details::ParseLiteral(text, pos, ':') || !details::ParseDigits(text, pos, 2, 2, minute) ||
+        !details::ParseLiteral(text, pos, ':') || !details::ParseDigits(text, pos, 2, 2, second)) {
+        return std::nullopt;
+    }
+
+    // the year bound keeps the result representable by every file_clock (nanosecond ticks overflow
+    // in 2262)
+    if ((day < 1) || (day > 31) || (hour > 23) || (minute > 59) || (second > 60) ||
+        (year < 1970) || (year >= 2200)) {
+        return std::nullopt;
+    }
+
+    int64_t days = details::DaysFromCivil(year, month, static_cast<unsigned>(day));
+    return std::chrono::sys_seconds(
+        std::chrono::seconds((days * 86400) + (hour * 3600) + (minute * 60) + second));
+}
+
+/**
+ * @brief Finds the timestamp in a film description ("<gametype> on <map>, <timestamp>"). Each
+ * ", " is tried in order, so commas in the gametype or map name don't derail it.
+ */
+inline std::optional<std::chrono::sys_seconds> FindTheaterTimestamp(std::string_view desc) {
+    for (size_t comma = desc.find(", "); comma != std::string_view::npos;
+         comma = desc.find(", ", comma + 1)) {
+        auto timestamp = ParseTheaterTimestamp(desc.substr(comma + 2));
+        if (timestamp.has_value()) {
+            return timestamp;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#if !defined(MCCINFO_NO_SIMD) &&                                                                  \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define MCCINFO_UTF16_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace mccinfo {
+namespace file_readers {
+
+/**
+ * @brief UTF-8 bytes needed to hold any transcoding of `utf16_bytes` bytes of UTF-16: one code
+ * unit never takes more than 3 bytes, and a surrogate pair (two units) takes 4.
+ */
+constexpr size_t UTF8CapacityFor(size_t utf16_bytes) {
+    return (utf16_bytes / 2) * 3;
+}
+
+namespace details {
+
+inline uint16_t LoadUTF16LE(const std::byte *src) {
+    return static_cast<uint16_t>(std::to_integer<uint16_t>(src[0]) |
+                                 (std::to_integer<uint16_t>(src[1]) << 8));
+}
+
+// Copies leading ascii code units 8 at a time; stops before the first unit that is not ascii or
+// is a null terminator, leaving it to the scalar path.
+inline void TranscodeASCIIRun(std::span<const std::byte> src, std::span<char> dst, size_t &in,
+                              size_t &out) {
+#if defined(MCCINFO_UTF16_SSE2)
+    const __m128i non_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    while (((in + 16) <= src.size()) && ((out + 8) <= dst.size())) {
+        __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src.data() + in));
+        __m128i is_ascii = _mm_cmpeq_epi16(_mm_and_si128(units, non_ascii), zero);
+        __m128i is_null = _mm_cmpeq_epi16(units, zero);
+        if ((_mm_movemask_epi8(is_ascii) != 0xFFFF) || (_mm_movemask_epi8(is_null) != 0)) {
+            break;
+        }
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst.data() + out),
+                         _mm_packus_epi16(units, units));
+        in += 16;
+        out += 8;
+    }
+#else
+    (void)src;
+    (void)dst;
+    (void)in;
+    (void)out;
+#endif
+}
+
+} // namespace details
+
+/**
+ * @brief Transcodes null terminated (or `src`-bounded) UTF-16LE into `dst` without allocating.
+ * Unpaired surrogates become U+FFFD, and a code point that does not fit in the space left in
+ * `dst` ends the output instead of being split.
+ *
+ * @return The number of bytes written to `dst`.
+ */
+inline size_t TranscodeUTF16LEToUTF8(std::span<const std::byte> src, std::span<char> dst) {
+    size_t in = 0;
+    size_t out = 0;
+
+    while ((in + 1) < src.size()) {
+        details::TranscodeASCIIRun(src, dst, in, out);
+        if ((in + 1) >= src.size()) {
+            break;
+        }
+
+        uint32_t cp = details::LoadUTF16LE(src.data() + in);
+        if (cp == 0) {
+            break;
+        }
+        in += 2;
+
+        if ((cp >= 0xD800) && (cp <= 0xDBFF)) {
+            uint16_t low = ((in + 1) < src.size()) ? details::LoadUTF16LE(src.data() + in) : 0;
+            if ((low >= 0xDC00) && (low <= 0xDFFF)) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                in += 2;
+            } else {
+                cp = 0xFFFD;
+            }
+        } else if ((cp >= 0xDC00) && (cp <= 0xDFFF)) {
+            cp = 0xFFFD;
+        }
+
+        size_t length = (cp < 0x80) ? 1 : (cp < 0x800) ? 2 : (cp < 0x10000) ? 3 : 4;
+        if ((dst.size() - out) < length) {
+            break;
+        }
+
+        switch (length) {
+        case 1:
+            dst[out++] = static_cast<char>(cp);
+            break;
+        case 2:
+            dst[out++] = static_cast<char>(0xC0 | (cp >> 6));
+            dst[out++] = static_cast<char>(0x80 | (cp & 0x3F));
+            break;
+        case 3:
+            dst[out++] = static_cast<char>(0xE0 | (cp >> 12));
+            dst[out++] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            dst[out++] = static_cast<char>(0x80 | (cp & 0x3F));
+            break;
+        default:
+            dst[out++] = static_cast<char>(0xF0 | (cp >> 18));
+            dst[out++] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            dst[out++] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            dst[out++] = static_cast<char>(0x80 | (cp & 0x3F));
+            break;
+        }
+    }
+
+    return out;
+}
+
+template <size_t N>
+std::string_view TranscodeUTF16LEToUTF8(std::span<const std::byte> src, char (&dst)[N]) {
+    return std::string_view(dst, TranscodeUTF16LEToUTF8(src, std::span<char>(dst, N)));
+}
+
+} // namespace file_readers
+} // namespace mccinfo
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+
+#include "mccinfo/core/log.h"
+#include "mccinfo/file_readers/carnage_report.hpp"
+
+namespace mccinfo {
+namespace fsm {
+
+/**
+ * @brief Reads carnage reports on a worker thread. The trace callback hands over the report's path
+ * as soon as MCC starts writing it; the worker waits for the .xml to stop growing and parse as a
+ * whole document, then passes the result to the on_complete callback.
+ *
+ * Requests never wait on file I/O. At most max_pending reports are queued; past that the oldest
+ * request is dropped.
+ */
+class carnage_report_client {
+  public:
+    using report_ptr = std::shared_ptr<const file_readers::carnage_report>;
+
+    static constexpr size_t max_pending = 4;
+
+    carnage_report_client() = default;
+    carnage_report_client(const carnage_report_client &) = delete;
+    carnage_report_client &operator=(const carnage_report_client &) = delete;
+
+    ~carnage_report_client() {
+        stop();
+    }
+
+    void set_on_complete(
+        std::function<void(const std::filesystem::path &, report_ptr)> complete_callback) {
+        std::unique_lock<std::mutex> lock(mut_);
+        complete_callback_ = complete_callback;
+    }
+
+    void set_on_error(std::function<void(const std::filesystem::path &)> error_callback) {
+        std::unique_lock<std::mutex> lock(mut_);
+        error_callback_ = error_callback;
+    }
+
+    // How often the report is checked, and how long to wait for it before giving up
+    void set_settle_timing(std::chrono::milliseconds poll_interval,
+                           std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mut_);
+        poll_interval_ = poll_interval;
+        timeout_ = timeout;
+    }
+
+    void start() {
+        std::unique_lock<std::mutex> lock(mut_);
+        if (worker_.joinable()) {
+            return;
+        }
+        stop_ = false;
+        worker_ = std::thread([this] { run(); });
+    }
+
+    void stop() {
+        {
+            std::unique_lock<std::mutex> lock(mut_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        if (worker_.joinable() && (worker_.get_id() != std::this_thread::get_id())) {
+            worker_.join();
+        }
+    }
+
+    // Queues xml_file, the final .xml path of a report; false if an older request was dropped
+    bool request_ingest(const std::filesystem::path &xml_file) {
+        bool dropped = false;
+        {
+            std::unique_lock<std::mutex> lock(mut_);
+            if (pending_.size() == max_pending) {
+                pending_.pop_front();
+                dropped = true;
+            }
+            pending_.push_back(xml_file);
+        }
+        cv_.notify_one();
+        return !dropped;
+    }
+
+  private:
+    void run() {
+        while (true) {
+            std::filesystem::path xml_file;
+            {
+                std::unique_lock<std::mutex> lock(mut_);
+                cv_.wait(lock, [&] { return stop_ || !pending_.empty(); });
+                if (stop_) {
+                    MI_CORE_TRACE("carnage_report_client stopping ...");
+                    break;
+                }
+                xml_file = std::move(pending_.front());
+                pending_.pop_front();
+            }
+
+            MI_CORE_TRACE("carnage_report_client ingesting {0}", xml_file.generic_string().c_str());
+            auto report = ingest(xml_file);
+
+            std::unique_lock<std::mutex> lock(mut_);
+            auto complete_callback = complete_callback_;
+            auto error_callback = error_callback_;
+            lock.unlock();
+
+            if (report) {
+                MI_CORE_INFO("carnage_report_client parsed {0} ({1} players)",
+                             xml_file.generic_string().c_str(), report->PlayerCount());
+                if (complete_callback) {
+                    complete_callback(xml_file, std::move(report));
+                }
+            } else {
+                MI_CORE_WARN("carnage_report_client could not read {0}",
+                             xml_file.generic_string().c_str());
+                if (error_callback) {
+                    error_callback(xml_file);
+                }
+            }
+        }
+    }
+
+    // Polls until the report's size holds still between two polls and it parses, the timeout
+    // passes, or the client is stopped
+    report_ptr ingest(const std::filesystem::path &xml_file) {
+        std::unique_lock<std::mutex> lock(mut_);
+        auto poll_interval = poll_interval_;
+        auto deadline = std::chrono::steady_clock::now() + timeout_;
+        lock.unlock();
+
+        std::optional<uintmax_t> last_size;
+        while (true) {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(xml_file, ec);
+            if (!ec && (size > 0) && (last_size == size)) {
+                auto report = file_readers::LoadCarnageReport(xml_file);
+                if (report.has_value()) {
+                    return std::make_shared<const file_readers::carnage_report>(
+                        std::move(report.value()));
+                }
+            }
+            last_size = ec ? std::nullopt : std::optional<uintmax_t>(size);
+
+            auto wake = std::min(deadline, std::chrono::steady_clock::now() + poll_interval);
+            lock.lock();
+            bool stopped = cv_.wait_until(lock, wake, [&] { return stop_; });
+            lock.unlock();
+            if (stopped || (std::chrono::steady_clock::now() >= deadline)) {
+                return nullptr;
+            }
+        }
+    }
+
+    std::function<void(const std::filesystem::path &, report_ptr)> complete_callback_;
+    std::function<void(const std::filesystem::path &)> error_callback_;
+    std::chrono::milliseconds poll_interval_{100};
+    std::chrono::milliseconds timeout_{30000};
+
+    std::mutex mut_;
+    std::condition_variable cv_;
+    std::deque<std::filesystem::path> pending_;
+    std::thread worker_;
+    bool stop_ = false;
+};
+
+} // namespace fsm
+} // namespace mccinfo
@@ -29,7 +29,7 @@ class context {
         return std::nullopt;
     }
 
-    const extended_match_info &get_extended_match_info() const {
+    extended_match_info get_extended_match_info() const {
         return sm_.get_extended_match_info();
     }
 
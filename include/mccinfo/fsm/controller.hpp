@@ -6,8 +6,13 @@
 #define MCCFSM_STATIC \
     static constexpr auto
 
+#include "mccinfo/file_readers/film_index.hpp"
+#include "mccinfo/file_readers/stats_store.hpp"
 #include "mccinfo/fsm/autosave_client.hpp"
+#include "mccinfo/fsm/carnage_report_client.hpp"
+#include "mccinfo/fsm/diagnostics.hpp"
 #include "mccinfo/fsm/machines/machines.hpp"
+#include "mccinfo/fsm/theater_files.hpp"
 
 namespace mccinfo {
 namespace fsm {
@@ -114,28 +119,6 @@ inline void flush_leftover_autosave_files(const std::filesystem::path &src) {
     details::move_leftover_autosave_files(user_content, film_files, map_files, game_files);
 }
 
-inline std::optional<std::filesystem::path> find_first_theater_file(
-    const std::filesystem::path &root) {
-
-    if (std::filesystem::exists(root) && std::filesystem::is_directory(root)) {
-        for (const auto &entry : std::filesystem::directory_iterator(root)) {
-            const auto &file = entry.path();
-
-            MI_CORE_TRACE("Looking for theater file data: {0}", file.generic_string().c_str());
-
-            if (std::filesystem::is_regular_file(file)) {
-                auto extension = file.extension();
-                if ((extension.generic_string() == ".temp") ||
-                    (extension.generic_string() == ".film")) {
-                    return file;
-                }
-            }
-        }
-    }
-
-    return std::nullopt;
-}
-
 inline std::optional<std::filesystem::path> find_matching_carnage_report(const std::filesystem::path& from_root, 
     const std::filesystem::path& carnage_report) {
     for (const auto& file : std::filesystem::directory_iterator(from_root)) {
@@ -210,46 +193,16 @@ inline void copy_latest_carnage_report(const std::filesystem::path& from_root,
     }
 }
 
-inline std::optional<std::filesystem::path> find_matching_theater_file(
-    const std::filesystem::path &in,
-    const std::filesystem::path &theater_file) {
-    std::vector<std::filesystem::path> theater_files;
-    std::filesystem::recursive_directory_iterator begin(in), end;
-
-    std::copy_if(
-        begin, end, std::back_inserter(theater_files), 
-        [](const std::filesystem::directory_entry &entry) {
-            if (entry.is_regular_file() && entry.path().has_extension()) {
-                return (entry.path().extension() == ".film" || entry.path().extension() == ".mov");
-            }
-            return false;
-        });
-    auto found_it =
-        std::find_if(theater_files.begin(), theater_files.end(), [&](const std::filesystem::path &file) {
-            auto stem1 = file.stem().generic_string();
-            auto stem2 = theater_file.stem().generic_string();
-
-            std::transform(stem1.begin(), stem1.end(), stem1.begin(), ::toupper);
-            std::transform(stem2.begin(), stem2.end(), stem2.begin(), ::toupper);
-
-            return stem1.find(stem2) != std::string::npos;
-        });
-
-    if (found_it != theater_files.end()) {
-        return *found_it;
-    } else {
-        return std::nullopt;
-    }
-}
-
-inline bool copy_matching_theater_file(const std::filesystem::path &from,
+inline bool copy_matching_theater_file(file_readers::film_index &index,
+                                       const std::filesystem::path &theater_file,
                                        const std::filesystem::path &in,
                                        const std::filesystem::path &to) {
-    MI_CORE_TRACE("copy_matching_theater_file():\n\tfrom: {0}\n\tin: {1}\n\tto: {2}", from, in, to);
-    auto file = find_first_theater_file(from);
-    if (file.has_value()) {
-        MI_CORE_TRACE("match file: {0}", file.value());
-        auto match = find_matching_theater_file(in, file.value());
+    MI_CORE_TRACE("copy_matching_theater_file():\n\ttheater_file: {0}\n\tin: {1}\n\tto: {2}",
+                  theater_file, in, to);
+    // a missed create event leaves no entry and a missed delete or rename a stale one, so rescan
+    // once and retry if nothing indexed could be copied
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        auto match = index.FindMatchingFilm(theater_file);
         if (match.has_value()) {
             MI_CORE_TRACE("match found: {0}", match.value());
             auto match_to = to / match.value().filename();
@@ -261,6 +214,13 @@ inline bool copy_matching_theater_file(const std::filesystem::path &from,
             catch(const std::exception& e) {
                 MI_CORE_ERROR("Error occurred {0}", e.what());
             }
+            index.Remove(match.value());
+        }
+
+        if (attempt == 0) {
+            MI_CORE_WARN("No indexed film matching {0} could be copied, rescanning {1} ...",
+                         theater_file, in);
+            index.Scan(in);
         }
     }
     return false;
@@ -269,10 +229,9 @@ inline bool copy_matching_theater_file(const std::filesystem::path &from,
 class filtering_context {
   public:
 
-    bool should_handle_trace_event(const EVENT_RECORD &record,
-                                   const krabs::trace_context &trace_context) {
+    bool should_handle_trace_event(const normalized_event &event) {
         if ((mcc_pid == std::numeric_limits<uint32_t>::max()) || 
-            (mcc_pid == record.EventHeader.ProcessId)) {
+            (mcc_pid == event.pid_)) {
             return true;
         }
         return false;
@@ -281,23 +240,19 @@ class filtering_context {
     template <typename _Controller, typename _StateMachine>
     void mcc_sm_event_wrapper(_Controller& controller,
                               _StateMachine &mcc_sm,
-                              const EVENT_RECORD &record, 
-                              const krabs::trace_context &trace_context) {
+                              const normalized_event &event) {
         bool current_is_off = false;
         if (!mcc_on) {
             current_is_off = mcc_sm.is(boost::sml::state<states::off>);
         }
 
-        controller.handle_trace_event_impl(mcc_sm, record, trace_context);
+        controller.handle_trace_event_impl(mcc_sm, event);
 
         if (!mcc_on && mcc_sm.is(boost::sml::state<states::on>)) {
             if (current_is_off) {
-                krabs::schema schema(record, trace_context.schema_locator);
-                krabs::parser parser(schema);
-                std::uint32_t pid = parser.parse<std::uint32_t>(L"ProcessId");
-                mcc_pid = pid;
+                mcc_pid = event.process_id_;
             } else {
-                mcc_pid = record.EventHeader.ProcessId;
+                mcc_pid = event.pid_;
             }
             mcc_on = true;
         } else if (mcc_on && mcc_sm.is(boost::sml::state<states::off>)) {
@@ -311,9 +266,8 @@ class filtering_context {
     void user_sm_event_wrapper(_Controller &controller, 
                                _StateMachineUser &user_sm,
                                _StateMachineGameId &game_id_sm,
-                              const EVENT_RECORD &record,
-                              const krabs::trace_context &trace_context) {
-        controller.handle_trace_event_impl(user_sm, record, trace_context);
+                               const normalized_event &event) {
+        controller.handle_trace_event_impl(user_sm, event);
 
         if (user_sm.is(boost::sml::state<states::identifying_session>) && (!done_identification)) {
             using namespace constants::background_videos;
@@ -339,19 +293,15 @@ class filtering_context {
                     "Collection");
 
                 if (game_hint.has_value()) {
-                    std::wcout << L"\t\tSending Artificial match_found Event: " << L"\n";
-                    user_sm.process_event(events::match_found{});
-                    std::wcout << L"\t\tSending Artificial game_event Event: " << L"\n";
-                    std::visit([&](auto &&evt) { game_id_sm.process_event(evt); },
-                                events::GetGameEventFromHint(game_hint.value()));
+                    controller.send_event(user_sm, events::match_found{});
+                    controller.send_event(game_id_sm,
+                                          events::GetGameEventFromHint(game_hint.value()));
                 } else {
-                    std::wcout << L"\t\tSending Artificial launch_identified Event: " << L"\n";
-                    user_sm.process_event(events::launch_identified{});
+                    controller.send_event(user_sm, events::launch_identified{});
                 }
 
             } else {
-                std::wcout << L"\t\tSending Artificial in_menus_identified Event: " << L"\n";
-                user_sm.process_event(events::in_menus_identified{});
+                controller.send_event(user_sm, events::in_menus_identified{});
             }
 
             done_identification = true;
@@ -375,6 +325,7 @@ struct extended_match_info {
 
     std::optional<std::filesystem::path> base_map_;
     std::optional<std::filesystem::path> carnage_report_;
+    std::shared_ptr<const mccinfo::file_readers::carnage_report> carnage_report_data_;
     std::optional<mccinfo::file_readers::theater_file_data> theater_file_data_;
     std::optional<mccinfo::game_hint> game_hint_;
 
@@ -383,6 +334,7 @@ struct extended_match_info {
         theater_file_data_ = std::nullopt;
         game_hint_ = std::nullopt;
         carnage_report_ = std::nullopt;
+        carnage_report_data_ = nullptr;
     }
 };
 
@@ -420,28 +372,84 @@ template <class = class Dummy> class controller {
         autosave_root_ = cache_root_ / "autosave";
         matches_root_ = cache_root_ / "matches";
 
+        MI_CORE_TRACE("Opening stats store in {0} ...", cache_root_ / "stats");
+        if (!stats_store_.Open(cache_root_ / "stats")) {
+            MI_CORE_WARN("Could not open stats store; carnage reports won't be recorded");
+        }
+
+        MI_CORE_TRACE("Indexing theater files in {0} ...", mcc_temp_root_);
+        film_index_.Scan(mcc_temp_root_);
+
         MI_CORE_TRACE("Setting autosave destination to: {0}", autosave_root_);
         autosave_client_.set_copy_dst(autosave_root_);
 
         MI_CORE_TRACE("Starting autosave client ...");
         autosave_client_.start();
+
+        // Publish only if the report still belongs to the current match; it may have been reset
+        // while the report was being read. The first report published for a match is also
+        // recorded in the stats store, outside the lock since appending writes to disk.
+        carnage_report_client_.set_on_complete(
+            [this](const std::filesystem::path &xml_file,
+                   carnage_report_client::report_ptr report) {
+                bool first = false;
+                std::string map;
+                {
+                    std::unique_lock<std::mutex> lock(autosave_data_mut_);
+                    if (!emi_.carnage_report_.has_value() ||
+                        (emi_.carnage_report_.value().filename() != xml_file.filename())) {
+                        return;
+                    }
+                    first = (emi_.carnage_report_data_ == nullptr);
+                    if (emi_.base_map_.has_value()) {
+                        map = emi_.base_map_.value().stem().string();
+                    }
+                    emi_.carnage_report_data_ = report;
+                }
+                if (first && !stats_store_.Append(*report, map)) {
+                    MI_CORE_WARN("Could not record carnage report in stats store: {0}",
+                                 xml_file.generic_string().c_str());
+                }
+        });
+
+        MI_CORE_TRACE("Starting carnage report client ...");
+        carnage_report_client_.start();
     };
 
-    void handle_trace_event(const EVENT_RECORD &record, const krabs::trace_context &trace_context) {
+    void handle_trace_event(const normalized_event &event) {
         utility::atomic_guard lk(lock);
 
-        if (fc.should_handle_trace_event(record, trace_context)) {
-            fc.mcc_sm_event_wrapper(*this, mcc_sm, record, trace_context);
-            fc.user_sm_event_wrapper(*this, user_sm, game_id_sm, record, trace_context);
-            handle_trace_event_impl<decltype(game_id_sm)>(game_id_sm, record, trace_context);
+        if (dump_requested_.load(std::memory_order_relaxed) &&
+            dump_requested_.exchange(false, std::memory_order_relaxed)) {
+            log_diagnostics("Diagnostics dump", 0);
+        }
+
+        if (fc.should_handle_trace_event(event)) {
+            uint64_t event_id = diagnostics::this_thread_ring().push_event(event);
+            state_changed_ = false;
+
+            fc.mcc_sm_event_wrapper(*this, mcc_sm, event);
+            fc.user_sm_event_wrapper(*this, user_sm, game_id_sm, event);
+            handle_trace_event_impl<decltype(game_id_sm)>(game_id_sm, event);
 
-            if (predicates::events::non_generic_map_file_created(record, trace_context) && should_id_map) {
-                id_map(record, trace_context);
+            if (log_full || state_changed_) {
+                log_diagnostics("Handling kernel event", event_id);
+            }
+
+            if (predicates::events::non_generic_map_file_created(event) && should_id_map) {
+                id_map(event);
+            }
+
+            if (predicates::events::theater_file_created(event)) {
+                index_theater_file(event);
             }
 
             if (should_save_autosave) {
                 auto target_data = get_autosave_client_target_data();
-                emi_.game_hint_ = target_data.second;
+                {
+                    std::unique_lock<std::mutex> lock(autosave_data_mut_);
+                    emi_.game_hint_ = target_data.second;
+                }
 
                 autosave_client_.set_copy_src(target_data.first);
                 autosave_client_.set_flatten_on_write(true);
@@ -495,8 +503,8 @@ template <class = class Dummy> class controller {
 
             // catch the carnagereport
             if (user_sm.is(boost::sml::state<states::in_game>) && should_id_cr) {
-                if (predicates::events::temp_carnage_report_created(record, trace_context)) {
-                    id_carnage_report(record, trace_context);
+                if (predicates::events::temp_carnage_report_created(event)) {
+                    id_carnage_report(event);
                 }
             }
 
@@ -516,58 +524,89 @@ template <class = class Dummy> class controller {
         return installations;
     }
 
-    const extended_match_info& get_extended_match_info() const {
+    // A copy taken under the lock, as the trace thread and the clients' workers keep writing it
+    extended_match_info get_extended_match_info() const {
+        std::unique_lock<std::mutex> lock(autosave_data_mut_);
         return emi_;
     }
+
+    // Logs the diagnostics of the last events handled. May be called from any thread; the dump
+    // is written by the trace thread when it handles its next event.
+    void request_diagnostics_dump() {
+        dump_requested_.store(true, std::memory_order_relaxed);
+    }
     
   private:
     template <typename _StateMachine>
-    void handle_trace_event_impl(_StateMachine &sm, const EVENT_RECORD &record,
-                                 const krabs::trace_context &trace_context) {
+    void handle_trace_event_impl(_StateMachine &sm, const normalized_event &event) {
+        auto &sc = state_context_of(sm);
 
-        std::wostringstream woss;
-        utility::PrintTraceEvent(woss, record, trace_context);
-
-        auto visit = [&](auto state) {
-            states::BonusStateVisitor<_StateMachine> visitor(sm, record, trace_context, sc, woss);
-            sm.visit_current_states(visitor);
-        };
-        sm.visit_current_states(visit);
-
-        bool state_change = false;
-        auto _evts = sc.pop_event_from_queue();
-        while (_evts.has_value()) {
-            std::visit(
-                [&](auto &arg) {
-                    auto ws = utility::ConvertBytesToWString(
-                        std::string(utility::type_hash<decltype(arg)>::name));
-                    if (ws.has_value())
-                        woss << L"\t\tSending Event: " << ws.value() << L"\n";
-                    state_change = true;
-                    sm.process_event(arg);
-                },
-                _evts.value());
-            _evts = sc.pop_event_from_queue();
-        }
-
-        auto visit2 = [&](auto state) {
-            states::StatePrinter<_StateMachine> visitor(sm, woss);
-            sm.visit_current_states(visitor);
-        };
-        sm.visit_current_states(visit2);
-
-        if (log_full || state_change) {
-            auto bytes = utility::ConvertWStringToBytes(woss.str());
-            if (bytes.has_value())
-                MI_CORE_TRACE("Handling kernel event:\n{0}", bytes.value());
-            else
-            {
-                MI_CORE_WARN("Handling kernel event ... Error converting logging trace event");
+        diagnostics::recorder rec(diagnostics::this_thread_ring(), machine_id_of(sm));
+        sc.handle_trace_event(rec, event);
 
-            }
+        auto _evt = sc.pop_event_from_queue();
+        while (_evt.has_value()) {
+            send_event(sm, _evt.value());
+            _evt = sc.pop_event_from_queue();
+        }
+    }
+
+    // Sends evt to sm and points sm's state context at the state it ends up in
+    template <typename _StateMachine>
+    void send_event(_StateMachine &sm, const events::event_t &evt) {
+        auto &sc = state_context_of(sm);
+
+        diagnostics::recorder rec(diagnostics::this_thread_ring(), machine_id_of(sm));
+        rec.set_state(sc.current_state());
+        rec.record_sent(evt);
+
+        std::visit([&](const auto &arg) { sm.process_event(arg); }, evt);
+        sc.set_current_state(states::current_state_index(sm, sc));
+
+        rec.set_state(sc.current_state());
+        rec.record(diagnostics::record_kind::result_state);
+        state_changed_ = true;
+    }
+
+    // Formats the calling thread's diagnostics from first_event onward
+    void log_diagnostics(const char *heading, uint64_t first_event) const {
+        std::wostringstream woss;
+        diagnostics::format(woss, diagnostics::this_thread_ring(), first_event, machine_names_);
+        auto bytes = utility::ConvertWStringToBytes(woss.str());
+        if (bytes.has_value()) {
+            MI_CORE_TRACE("{0}:\n{1}", heading, bytes.value());
+        } else {
+            MI_CORE_WARN("{0} ... Error converting logging trace event", heading);
         }
     }
 
+    auto &state_context_of(boost::sml::sm<machines::mcc> &) {
+        return mcc_sc;
+    }
+    auto &state_context_of(boost::sml::sm<machines::user> &) {
+        return user_sc;
+    }
+    auto &state_context_of(boost::sml::sm<machines::game_id> &) {
+        return game_id_sc;
+    }
+
+    // Indexes machine_names_
+    static constexpr uint8_t machine_id_of(const boost::sml::sm<machines::mcc> &) {
+        return 0;
+    }
+    static constexpr uint8_t machine_id_of(const boost::sml::sm<machines::user> &) {
+        return 1;
+    }
+    static constexpr uint8_t machine_id_of(const boost::sml::sm<machines::game_id> &) {
+        return 2;
+    }
+
+    static constexpr std::array<diagnostics::machine_names, 3> machine_names_ = {{
+        { L"mcc", machines::mcc::state_context::state_names },
+        { L"user", machines::user::state_context::state_names },
+        { L"game_id", machines::game_id::state_context::state_names },
+    }};
+
     void find_mcc_installations() {
         auto sii = mccinfo::query::LookForSteamInstallInfo();
         if (sii.has_value()) {
@@ -649,15 +688,17 @@ template <class = class Dummy> class controller {
                         details::copy_latest_carnage_report(from, to);
                     }
 
-                    if (details::copy_matching_theater_file(autosave_root_, mcc_temp_root_,
-                                                            autosave_root_)) {
+                    if (autosave_theater_file_.has_value() &&
+                        details::copy_matching_theater_file(film_index_,
+                                                            autosave_theater_file_.value(),
+                                                            mcc_temp_root_, autosave_root_)) {
                         try {
-                            auto temp_file = details::find_first_theater_file(autosave_root_).value();
-                            std::filesystem::remove(temp_file);
+                            std::filesystem::remove(autosave_theater_file_.value());
                         }
                         catch(const std::exception& e) {
                             MI_CORE_ERROR("Error removing temp_film: {0}", e.what());
                         }
+                        autosave_theater_file_ = std::nullopt;
                     }
 
                     // here carnage reports are chronologically the last file related to the match written,
@@ -751,27 +792,40 @@ template <class = class Dummy> class controller {
         });
     }
 
-    void id_map(const EVENT_RECORD& record, const krabs::trace_context& trace_context) {
-        krabs::schema schema(record, trace_context.schema_locator);
-        krabs::parser parser(schema);
-        std::wstring filename = parser.parse<std::wstring>(L"OpenPath");
+    void id_map(const normalized_event& event) {
+        std::wstring filename(event_paths().path(event.path_));
         auto bytes = utility::ConvertWStringToBytes(filename);
         if (bytes.has_value()) {
             mi.map = bytes.value();
-            emi_.base_map_ = bytes.value();
             should_id_map = false;
+
+            std::unique_lock<std::mutex> lock(autosave_data_mut_);
+            emi_.base_map_ = bytes.value();
         }
     }
 
-    void id_carnage_report(const EVENT_RECORD& record, const krabs::trace_context& trace_context) {
-        krabs::schema schema(record, trace_context.schema_locator);
-        krabs::parser parser(schema);
-        std::wstring filename = parser.parse<std::wstring>(L"OpenPath");
+    void id_carnage_report(const normalized_event& event) {
+        std::wstring filename(event_paths().path(event.path_));
         auto bytes = utility::ConvertWStringToBytes(filename);
         if (bytes.has_value()) {
+            should_id_cr = false;
+
+            std::unique_lock<std::mutex> lock(autosave_data_mut_);
             emi_.carnage_report_ = bytes.value();
             emi_.carnage_report_.value().replace_extension();
-            should_id_cr = false;
+        }
+
+        // MCC writes the .xml.tmp and renames it when done; the worker waits for the .xml
+        auto tmp_file = rebase_temporary_path(mcc_temp_root_, filename);
+        if (tmp_file.has_value()) {
+            carnage_report_client_.request_ingest(tmp_file.value().replace_extension());
+        }
+    }
+
+    void index_theater_file(const normalized_event& event) {
+        auto file = fsm::index_theater_file(film_index_, mcc_temp_root_, event);
+        if (file.has_value()) {
+            MI_CORE_TRACE("Indexed theater file: {0}", file.value().generic_string().c_str());
         }
     }
 
@@ -797,7 +851,7 @@ template <class = class Dummy> class controller {
         }
         else if (game_id_sm.is(boost::sml::state<states::halo3odst>)) {
             autosave_root /= "Halo3ODST";
-            hint = mccinfo::game_hint::HALO3;
+            hint = mccinfo::game_hint::HALO3ODST;
         }
         else if (game_id_sm.is(boost::sml::state<states::haloreach>)) {
             autosave_root /= "HaloReach";
@@ -837,6 +891,7 @@ template <class = class Dummy> class controller {
                         );
 
                         found_theater_file = true;
+                        autosave_theater_file_ = file;
 
                         try {
                             this->emi_.theater_file_data_ = file_readers::ReadTheaterFile(std::filesystem::canonical(file), hint);
@@ -861,22 +916,38 @@ template <class = class Dummy> class controller {
   private:
     utility::atomic_mutex lock;
 
-    states::state_context sc{};
+    machines::mcc::state_context mcc_sc{};
+    machines::user::state_context user_sc{};
+    machines::game_id::state_context game_id_sc{};
     details::filtering_context fc{};
     boost::sml::sm<machines::mcc> mcc_sm;
     boost::sml::sm<machines::user> user_sm;
     boost::sml::sm<machines::game_id> game_id_sm;
 
+    static_assert(states::covers_machine_states<decltype(mcc_sm), machines::mcc::state_context>,
+                  "machines::mcc::state_context must list every state of its transition table");
+    static_assert(states::covers_machine_states<decltype(user_sm), machines::user::state_context>,
+                  "machines::user::state_context must list every state of its transition table");
+    static_assert(
+        states::covers_machine_states<decltype(game_id_sm), machines::game_id::state_context>,
+        "machines::game_id::state_context must list every state of its transition table");
+
     callback_table& cb_table_;
     std::thread autosave_thread_;
     std::mutex autosave_mut_;
-    std::mutex autosave_data_mut_;
+    mutable std::mutex autosave_data_mut_;
     bool stop_autosave_ = false;
 
     autosave_client autosave_client_;
     file_readers::theater_file_data file_data;
+    file_readers::film_index film_index_;
+    std::optional<std::filesystem::path> autosave_theater_file_;
 
     extended_match_info emi_;
+    // Fed by the carnage report client's callback, so it too must outlive the worker
+    file_readers::stats_store stats_store_;
+    // After emi_ so the worker is joined before what its callback writes to is destroyed
+    carnage_report_client carnage_report_client_;
     std::filesystem::path mcc_temp_root_;
     std::filesystem::path module_root_;
     std::filesystem::path cache_root_;
@@ -896,6 +967,8 @@ template <class = class Dummy> class controller {
     bool should_build_match = false;
 
   private: // filtering
+    std::atomic<bool> dump_requested_ = false;
+    bool state_changed_ = false;
     bool log_full = false;
     //bool log_full = true;
 };
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "mccinfo/fsm/events/events.hpp"
+#include "mccinfo/fsm/normalized_event.hpp"
+
+namespace mccinfo {
+namespace fsm {
+namespace diagnostics {
+
+// Unqualified name of T, taken from the compiler's signature of this function
+template <typename T>
+constexpr std::string_view type_name() {
+#ifdef _MSC_VER
+    std::string_view sig = __FUNCSIG__;
+    auto end = sig.rfind(">(void)");
+#else
+    std::string_view sig = __PRETTY_FUNCTION__;
+    auto end = sig.find_first_of(";]", sig.find("T = "));
+#endif
+    auto name = sig.substr(0, end);
+    auto start = name.find_last_of(": <");
+    return (start == std::string_view::npos) ? name : name.substr(start + 1);
+}
+
+namespace details {
+
+template <typename _Variant, size_t... _Is>
+constexpr auto alternative_names(std::index_sequence<_Is...>) {
+    return std::array<std::string_view, sizeof...(_Is)>{
+        type_name<std::variant_alternative_t<_Is, _Variant>>()...
+    };
+}
+
+} // details
+
+// Indexed by events::event_t::index()
+inline constexpr auto event_names = details::alternative_names<events::event_t>(
+    std::make_index_sequence<std::variant_size_v<events::event_t>>());
+
+enum class record_kind : uint8_t {
+    cache_hit,    // a state's edges were live when it saw the event
+    cache_miss,   // they were reset first
+    sequence,     // an edge's sequence saw the event; result_ is a sequence_result
+    sent,         // an edge's event went to the machine; index_ is its events::event_t index
+    result_state, // the machine's state once its events were sent
+};
+
+enum class sequence_result : uint8_t {
+    nil,
+    advanced,
+    complete,
+};
+
+/**
+ * @brief One step of handling an event, kept as numbers so recording it costs a 16 byte store.
+ * Names are only looked up when records are formatted.
+ */
+struct record {
+    uint64_t event_id_ = 0;
+    record_kind kind_ = record_kind::cache_hit;
+    uint8_t machine_ = 0;
+    uint8_t state_ = 0;
+    uint8_t index_ = 0; // the edge, or for sent records the event
+    uint8_t result_ = 0;
+};
+
+/**
+ * @brief The last events a thread handled and what its machines did with them, overwriting the
+ * oldest once full.
+ *
+ * Written and read only by the thread that owns it (see this_thread_ring), so it needs neither
+ * locks nor atomics; anything wanting a dump asks that thread for one. Both rings are allocated
+ * up front and pushing never allocates.
+ */
+class ring {
+  public:
+    static constexpr size_t event_capacity = size_t(1) << 12;
+    static constexpr size_t record_capacity = size_t(1) << 16;
+
+    ring() : events_(event_capacity), records_(record_capacity) {}
+
+    ring(const ring &) = delete;
+    ring &operator=(const ring &) = delete;
+
+    // Starts the records of a new event; returns its id
+    uint64_t push_event(const normalized_event &event) {
+        events_[event_count_ & (event_capacity - 1)] = event;
+        return event_count_++;
+    }
+
+    void push(const record &rec) {
+        records_[record_count_ & (record_capacity - 1)] = rec;
+        ++record_count_;
+    }
+
+    // Events pushed so far; the last one's id is event_count() - 1
+    uint64_t event_count() const {
+        return event_count_;
+    }
+
+    // Id of the oldest event still held
+    uint64_t first_event() const {
+        return (event_count_ > event_capacity) ? (event_count_ - event_capacity) : 0;
+    }
+
+    // Event id, or nullptr if it was overwritten or never pushed
+    const normalized_event *find_event(uint64_t id) const {
+        if ((id < first_event()) || (id >= event_count_)) {
+            return nullptr;
+        }
+        return &events_[id & (event_capacity - 1)];
+    }
+
+    // Calls visit(record) for every record held of events from first onward, oldest first.
+    // The records of the oldest held events may have been overwritten already.
+    template <typename Visit>
+    void for_each(uint64_t first, Visit &&visit) const {
+        uint64_t oldest = (record_count_ > record_capacity) ? (record_count_ - record_capacity) : 0;
+        uint64_t start = record_count_;
+        while ((start > oldest) && (at(start - 1).event_id_ >= first)) {
+            --start;
+        }
+        for (uint64_t i = start; i < record_count_; ++i) {
+            visit(at(i));
+        }
+    }
+
+  private:
+    const record &at(uint64_t i) const {
+        return records_[i & (record_capacity - 1)];
+    }
+
+    std::vector<normalized_event> events_;
+    std::vector<record> records_;
+    uint64_t event_count_ = 0;
+    uint64_t record_count_ = 0;
+};
+
+// The calling thread's ring
+inline ring &this_thread_ring() {
+    thread_local ring diagnostics;
+    return diagnostics;
+}
+
+/**
+ * @brief Records one machine's handling of the last event pushed to a ring. Whoever hands the
+ * event on sets the state and edge it reached, so each layer records only what it knows.
+ */
+class recorder {
+  public:
+    recorder(ring &ring, uint8_t machine)
+        : ring_(ring), event_id_(ring.event_count() - 1), machine_(machine) {
+    }
+
+    void set_state(size_t state) {
+        state_ = static_cast<uint8_t>(state);
+    }
+
+    void set_edge(size_t edge) {
+        edge_ = static_cast<uint8_t>(edge);
+    }
+
+    void record(record_kind kind, uint8_t result = 0) {
+        ring_.push({ event_id_, kind, machine_, state_, edge_, result });
+    }
+
+    void record_sequence(sequence_result result) {
+        record(record_kind::sequence, static_cast<uint8_t>(result));
+    }
+
+    void record_sent(const events::event_t &event) {
+        ring_.push({ event_id_, record_kind::sent, machine_, state_,
+                     static_cast<uint8_t>(event.index()), 0 });
+    }
+
+  private:
+    ring &ring_;
+    uint64_t event_id_;
+    uint8_t machine_;
+    uint8_t state_ = 0;
+    uint8_t edge_ = 0;
+};
+
+// Names a machine's records are formatted with; states are indexed like its state_context
+struct machine_names {
+    std::wstring_view name_;
+    std::span<const std::string_view> states_;
+};
+
+namespace details {
+
+inline void write_name(std::wostream &os, std::string_view name) {
+    for (char c : name) {
+        os << static_cast<wchar_t>(c);
+    }
+}
+
+inline void write_state(std::wostream &os, std::span<const machine_names> machines,
+                        const record &rec) {
+    if ((rec.machine_ < machines.size()) && (rec.state_ < machines[rec.machine_].states_.size())) {
+        write_name(os, machines[rec.machine_].states_[rec.state_]);
+    } else {
+        os << L"state " << static_cast<uint32_t>(rec.state_);
+    }
+}
+
+} // details
+
+// Writes the records of events from first onward that are still held, oldest first, in the
+// shape the controller used to log them in as they happened
+inline void format(std::wostream &os, const ring &ring, uint64_t first,
+                   std::span<const machine_names> machines) {
+    static constexpr std::array<std::wstring_view, 3> sequence_results = {
+        L"nil", L"advanced", L"complete"
+    };
+
+    const record *previous = nullptr;
+    ring.for_each(std::max(first, ring.first_event()), [&](const record &rec) {
+        if ((previous == nullptr) || (previous->event_id_ != rec.event_id_)) {
+            os << L"\tEvent " << rec.event_id_ << L": ";
+            if (auto event = ring.find_event(rec.event_id_)) {
+                os << *event;
+            }
+            os << L'\n';
+            previous = nullptr;
+        }
+        if ((previous == nullptr) || (previous->machine_ != rec.machine_) ||
+            (rec.kind_ == record_kind::cache_hit) || (rec.kind_ == record_kind::cache_miss)) {
+            os << L"\t\t";
+            if (rec.machine_ < machines.size()) {
+                os << machines[rec.machine_].name_;
+            } else {
+                os << L"machine " << static_cast<uint32_t>(rec.machine_);
+            }
+            os << L" Current State: ";
+            details::write_state(os, machines, rec);
+            os << L'\n';
+        }
+        previous = &rec;
+
+        switch (rec.kind_) {
+        case record_kind::cache_hit:
+            os << L"\t\t\tState Context Cache: hit\n";
+            break;
+        case record_kind::cache_miss:
+            os << L"\t\t\tState Context Cache: miss\n";
+            break;
+        case record_kind::sequence:
+            os << L"\t\t\tSequence Result (" << static_cast<uint32_t>(rec.index_) << L"): "
+               << ((rec.result_ < sequence_results.size()) ? sequence_results[rec.result_]
+                                                           : std::wstring_view(L"?"))
+               << L'\n';
+            break;
+        case record_kind::sent:
+            os << L"\t\t\tSending Event: ";
+            if (rec.index_ < event_names.size()) {
+                details::write_name(os, event_names[rec.index_]);
+            }
+            os << L'\n';
+            break;
+        case record_kind::result_state:
+            os << L"\t\t\tResult State: ";
+            details::write_state(os, machines, rec);
+            os << L'\n';
+            break;
+        }
+    });
+}
+
+} // namespace diagnostics
+} // namespace fsm
+} // namespace mccinfo
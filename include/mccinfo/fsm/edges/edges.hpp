@@ -5,10 +5,12 @@
 #include <any>
 #include <utility>
 #include <array>
+#include <optional>
 #include <ostream>
 
-#include "mccinfo/utility.hpp"
+#include "mccinfo/fsm/diagnostics.hpp"
 #include "mccinfo/fsm/events/events.hpp"
+#include "mccinfo/fsm/normalized_event.hpp"
 #include "sequences.hpp"
 
 namespace mccinfo {
@@ -26,7 +28,7 @@ class edge {
 
         template <typename _Sm> 
         void traverse(_Sm *sm) const {
-            std::visit([](auto &&evt) {
+            std::visit([sm](auto &&evt) {
                 auto new_evt = evt;
                 sm->process_event(new_evt); 
             }, edge_.second);
@@ -40,12 +42,14 @@ class edge {
             return edge_.second;
         }
 
-        virtual bool handle_trace_event(std::wostringstream& woss,
-                                        const EVENT_RECORD &record,
-                                        const krabs::trace_context &trace_context) {
-            bool result = edge_.first->try_advance(record, trace_context);
-            woss << L"\t\tSequence Result: " << ((result) ? L"advanced" : L"nil") << L'\n';
-            return edge_.first->is_complete();
+        virtual bool handle_trace_event(diagnostics::recorder& rec,
+                                        const normalized_event &event) {
+            bool result = edge_.first->try_advance(event);
+            bool complete = edge_.first->is_complete();
+            rec.record_sequence(complete ? diagnostics::sequence_result::complete
+                                : (result ? diagnostics::sequence_result::advanced
+                                          : diagnostics::sequence_result::nil));
+            return complete;
         }
 
         void reset() {
@@ -61,8 +65,8 @@ class edge {
 
 
 struct edge_container_base {
-    virtual std::optional<events::event_t> handle_trace_event(std::wostringstream& woss, const EVENT_RECORD &record,
-                               const krabs::trace_context &trace_context) = 0;
+    virtual std::optional<events::event_t> handle_trace_event(diagnostics::recorder& rec,
+                                                              const normalized_event &event) = 0;
         virtual void reset() = 0;
 };
 
@@ -81,21 +85,18 @@ struct edge_container : public edge_container_base {
         }
     }
 
-    virtual std::optional<events::event_t> handle_trace_event(std::wostringstream& woss, const EVENT_RECORD &record,
-                       const krabs::trace_context &trace_context) override final {        
-        std::vector<std::pair<edges::priority, events::event_t>> hot_events;
+    virtual std::optional<events::event_t> handle_trace_event(diagnostics::recorder& rec,
+                                                              const normalized_event &event) override final {
+        // every edge sees the event; the first to complete wins
+        std::optional<events::event_t> hot_event;
 
-        for (auto &edge_ : edges_) {
-            if (edge_.handle_trace_event(woss, record, trace_context)) {
-                hot_events.push_back({edge_.get_priority(), edge_.get_event()});
+        for (size_t i = 0; i < N; ++i) {
+            rec.set_edge(i);
+            if (edges_[i].handle_trace_event(rec, event) && !hot_event.has_value()) {
+                hot_event = edges_[i].get_event();
             }
         }
-        if (hot_events.size()) {
-            events::event_t new_event = hot_events[0].second;
-            return new_event;
-        }
-        else
-            return std::nullopt;
+        return hot_event;
     }
 
   private:
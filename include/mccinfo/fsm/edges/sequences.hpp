@@ -1,14 +1,11 @@
 #pragma once
 
-#ifndef NOMINMAX
-#define NOMINMAX
-#endif
-#include <krabs/krabs.hpp> //#include <windows.h>
-#undef NOMINMAX
-
 #include <array>
 #include <optional>
 
+#include "mccinfo/fsm/normalized_event.hpp"
+#include "mccinfo/fsm/predicates.hpp"
+
 namespace mccinfo {
 namespace fsm {
 namespace edges {
@@ -20,8 +17,7 @@ enum sequence_policy {
 };
 
 struct sequence_base {
-    virtual bool try_advance(const EVENT_RECORD &record,
-                             const krabs::trace_context &trace_context) const = 0;
+    virtual bool try_advance(const normalized_event &event) const = 0;
     virtual bool is_complete() const = 0;
     virtual void reset() = 0;
 };
@@ -30,12 +26,12 @@ template <std::size_t N> struct sequence : public sequence_base {
   public:
     template <typename... predicates>
     constexpr sequence(
-        const sequence_policy &pol, predicates... preds) : seq_{preds...}, pol_{pol} {
+        const sequence_policy &pol, predicates... preds) : pol_{pol}, seq_{preds...} {
         static_assert(sizeof...(preds) == N,
                       "The number of predicates must match the template parameter N.");
     }
 
-    sequence(const sequence &other) : current_(0), seq_(other.seq_), pol_(other.pol_) {
+    sequence(const sequence &other) : pol_(other.pol_), current_(0), seq_(other.seq_) {
     }
 
     sequence &operator=(const sequence &other) {
@@ -50,10 +46,9 @@ template <std::size_t N> struct sequence : public sequence_base {
     sequence(sequence &&) = delete;
     sequence &operator=(sequence &&) = delete;
 
-    virtual bool try_advance(const EVENT_RECORD &record,
-                             const krabs::trace_context &trace_context) const override {
+    virtual bool try_advance(const normalized_event &event) const override {
         if (!is_complete()) {
-            if ((*seq_[current_])(record, trace_context)) {
+            if ((*seq_[current_])(event)) {
                 current_ += 1;
                 return true;
             } 
@@ -75,7 +70,7 @@ template <std::size_t N> struct sequence : public sequence_base {
   private:
     sequence_policy pol_{};
     mutable size_t current_{0};
-    std::array<krabs::predicates::details::predicate_base *, N> seq_;
+    std::array<const predicates::details::predicate_base *, N> seq_;
 };
 template <typename... predicates> sequence(predicates...) -> sequence<sizeof...(predicates)>;
 
@@ -3,7 +3,10 @@
 #include "mccinfo/fsm/events/mcc_events.hpp"
 #include "mccinfo/fsm/events/user_events.hpp"
 #include "mccinfo/fsm/events/game_id_events.hpp"
+#include "mccinfo/game_hint.hpp"
 
+#include <filesystem>
+#include <stdexcept>
 #include <variant>
 
 namespace mccinfo {
@@ -37,13 +40,16 @@ namespace events {
 
 
 inline event_t GetGameEventFromPath(const std::filesystem::path &path) {
-    if      (utility::PathContains(path, "Halo1"))      return events::haloce_found{};
-    else if (utility::PathContains(path, "Halo2A"))     return events::halo2a_found{};
-    else if (utility::PathContains(path, "Halo2"))      return events::halo2_found{};
-    else if (utility::PathContains(path, "Halo3ODST"))  return events::halo3odst_found{};
-    else if (utility::PathContains(path, "Halo3"))      return events::halo3_found{};
-    else if (utility::PathContains(path, "Halo4"))      return events::halo4_found{};
-    else if (utility::PathContains(path, "HaloReach"))  return events::haloreach_found{};
+    auto generic = path.generic_string();
+    auto contains = [&](const char *game) { return generic.find(game) != std::string::npos; };
+
+    if      (contains("Halo1"))      return events::haloce_found{};
+    else if (contains("Halo2A"))     return events::halo2a_found{};
+    else if (contains("Halo2"))      return events::halo2_found{};
+    else if (contains("Halo3ODST"))  return events::halo3odst_found{};
+    else if (contains("Halo3"))      return events::halo3_found{};
+    else if (contains("Halo4"))      return events::halo4_found{};
+    else if (contains("HaloReach"))  return events::haloreach_found{};
     else throw std::runtime_error("GetGameEventFromPath(): game not found");
 }
 
@@ -7,6 +7,11 @@ namespace fsm {
 namespace machines {
 
 struct game_id {
+    // Every state in the transition table, each with its edges, the initial state first
+    using state_context = states::state_context<
+        states::none, states::haloce, states::halo2, states::halo2a, states::halo3,
+        states::halo3odst, states::halo4, states::haloreach>;
+
     auto operator()() const {
     using namespace boost::sml;
     using namespace states;
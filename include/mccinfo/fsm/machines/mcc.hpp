@@ -7,6 +7,9 @@ namespace fsm {
 namespace machines {
 
 struct mcc {
+    // Every state in the transition table, each with its edges, the initial state first
+    using state_context = states::state_context<states::off, states::launching, states::on>;
+
     auto operator()() const {
     using namespace boost::sml;
     using namespace states;
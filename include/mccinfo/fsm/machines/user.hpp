@@ -7,6 +7,11 @@ namespace fsm {
 namespace machines {
 
 struct user {
+    // Every state in the transition table, each with its edges, the initial state first
+    using state_context = states::state_context<
+        states::offline, states::waiting_on_launch, states::identifying_session, states::in_menus,
+        states::loading_in, states::in_game, states::loading_out>;
+
     auto operator()() const {
     using namespace boost::sml;
     using namespace states;
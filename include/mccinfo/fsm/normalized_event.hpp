@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "mccinfo/fsm/path_classifier.hpp"
+
+namespace mccinfo {
+namespace fsm {
+
+// The kernel provider an event came from; opcodes only mean something within one
+enum class event_source : uint8_t {
+    other,
+    process,
+    image,
+    file_io,
+    count,
+};
+
+using path_id = uint32_t;
+
+inline constexpr path_id no_path = 0;
+
+/**
+ * @brief Interns the paths and image names events refer to, so an event carries a 32 bit id and
+ * each distinct path is classified once rather than once per event.
+ *
+ * Ids stay valid for the table's lifetime; no_path is never a path. Not synchronized: the trace
+ * thread interns, and whatever reads ids back must run on it or after it has stopped.
+ */
+class path_table {
+  public:
+    path_table() {
+        paths_.emplace_back();
+        masks_.push_back(0);
+    }
+
+    path_table(const path_table &) = delete;
+    path_table &operator=(const path_table &) = delete;
+
+    path_id intern(std::wstring_view path) {
+        if (auto it = ids_.find(path); it != ids_.end()) {
+            return it->second;
+        }
+        return insert(path, mcc_path_classifier().classify(path));
+    }
+
+    // Narrow names (ImageFileName) are taken as Latin-1
+    path_id intern(std::string_view path) {
+        scratch_.assign(path.begin(), path.end());
+        for (size_t i = 0; i < path.size(); ++i) {
+            scratch_[i] = static_cast<wchar_t>(static_cast<unsigned char>(path[i]));
+        }
+        return intern(std::wstring_view(scratch_));
+    }
+
+    // Interns path only if it contains one of path_patterns; most paths an event names never
+    // match anything and would only grow the table
+    path_id intern_matching(std::wstring_view path) {
+        if (auto it = ids_.find(path); it != ids_.end()) {
+            return it->second;
+        }
+        path_mask mask = mcc_path_classifier().classify(path);
+        return (mask != 0) ? insert(path, mask) : no_path;
+    }
+
+    path_id find(std::wstring_view path) const {
+        auto it = ids_.find(path);
+        return (it != ids_.end()) ? it->second : no_path;
+    }
+
+    // Narrow names are taken as Latin-1, as by intern; never adds path
+    path_id find(std::string_view path) {
+        scratch_.assign(path.begin(), path.end());
+        for (size_t i = 0; i < path.size(); ++i) {
+            scratch_[i] = static_cast<wchar_t>(static_cast<unsigned char>(path[i]));
+        }
+        return find(std::wstring_view(scratch_));
+    }
+
+    std::wstring_view path(path_id id) const {
+        return (id < paths_.size()) ? std::wstring_view(paths_[id]) : std::wstring_view();
+    }
+
+    path_mask mask(path_id id) const {
+        return (id < masks_.size()) ? masks_[id] : 0;
+    }
+
+    size_t size() const {
+        return paths_.size() - 1;
+    }
+
+  private:
+    path_id insert(std::wstring_view path, path_mask mask) {
+        auto id = static_cast<path_id>(paths_.size());
+        const auto &stored = paths_.emplace_back(path); // a deque never moves its elements
+        masks_.push_back(mask);
+        ids_.emplace(std::wstring_view(stored), id);
+        return id;
+    }
+
+    std::deque<std::wstring> paths_;
+    std::vector<path_mask> masks_;
+    std::unordered_map<std::wstring_view, path_id> ids_;
+    std::wstring scratch_;
+};
+
+// The table events are normalized against, and predicates resolve their names in
+inline path_table &event_paths() {
+    static path_table paths;
+    return paths;
+}
+
+/**
+ * @brief What the fsm reads from a kernel event, parsed out of the EVENT_RECORD once by the
+ * provider. Plain data, so it queues and copies freely and can be built by hand in tests.
+ */
+struct normalized_event {
+    int64_t timestamp_ = 0;
+    uint32_t pid_ = 0; // the process raising the event
+    uint32_t tid_ = 0;
+    uint32_t process_id_ = 0; // process and image events: the process started, ended or loading
+    uint32_t io_size_ = 0;    // file reads
+    path_id path_ = no_path;  // file io: OpenPath, if it matches a path_pattern
+    path_id image_name_ = no_path; // process: ImageFileName; image: FileName, if it matches
+    path_mask path_mask_ = 0;
+    path_mask image_name_mask_ = 0;
+    event_source source_ = event_source::other;
+    uint8_t opcode_ = 0;
+};
+
+inline constexpr std::array<std::wstring_view, static_cast<size_t>(event_source::count)>
+    event_source_names = { L"Other", L"Process", L"Image", L"FileIo" };
+
+inline std::wostream &operator<<(std::wostream &os, const normalized_event &event) {
+    os << event_source_names[static_cast<size_t>(event.source_)] << L" ("
+       << static_cast<uint32_t>(event.opcode_) << L") pid=" << event.pid_
+       << L" tid=" << event.tid_;
+    if (event.process_id_ != 0) {
+        os << L" ProcessId=" << event.process_id_;
+    }
+    if (event.io_size_ != 0) {
+        os << L" IoSize=" << event.io_size_;
+    }
+    if (event.image_name_ != no_path) {
+        os << L" ImageFileName=" << event_paths().path(event.image_name_);
+    }
+    if (event.path_ != no_path) {
+        os << L" Path=" << event_paths().path(event.path_);
+    }
+    return os;
+}
+
+} // namespace fsm
+} // namespace mccinfo
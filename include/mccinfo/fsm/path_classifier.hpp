@@ -0,0 +1,280 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "mccinfo/constants.hpp"
+
+namespace mccinfo {
+namespace fsm {
+
+// Case insensitive substrings the predicates look for in OpenPath and FileName, one mask bit each
+enum class path_pattern : uint8_t {
+    // OpenPath
+    map_file,
+    map_info_file,
+    hdmu_map_file,
+    shared_map_file,
+    campaign_map_file,
+    mainmenu_map_file,
+    theater_file,
+    theater_film_file,
+    temp_carnage_report,
+    backup_carnage_report,
+    match_init_file,
+    match_launch_file,
+    sound_file,
+    hud_scoring_gfx_file,
+    loadingscreen_gfx_file,
+    restartscreen_gfx_file,
+    paused_game_gfx_file,
+    soundstream_pck_file,
+    match_temp_file,
+    halo2a_autosave_temp_file,
+    halo3_autosave_temp_file,
+    halo3odst_autosave_temp_file,
+    halo4_autosave_temp_file,
+    haloreach_autosave_temp_file,
+    halo2_autosave_bin_file,
+    halo3_autosave_bin_file,
+    haloce_lang_bin,
+    halo2_lang_bin,
+    halo2a_lang_bin,
+    halo3_lang_bin,
+    halo3odst_lang_bin,
+    halo4_lang_bin,
+    haloreach_lang_bin,
+    main_menu_background_video_file,
+    ms_logo_background_video_file,
+    background_video_file,
+    contains_halo1,
+    contains_halo2,
+    contains_mpcarnagereport,
+    contains_survivalcarnagereport,
+    contains_h2a_movie_path,
+    contains_h3_movie_path,
+    contains_h3odst_movie_path,
+    contains_h4_movie_path,
+    contains_reach_movie_path,
+    contains_ui_localization_path,
+    contains_shared,
+    contains_cache,
+    contains_campaign,
+
+    // FileName
+    launcher_image,
+    cryptui_image,
+    wininet_image,
+    winrnr_image,
+    wsock32_image,
+    partywin_image,
+    halo1_image,
+    halo2_image,
+    halo3_image,
+    halo3_odst_image,
+    halo4_image,
+    halo_reach_image,
+    groundhog_image,
+    count,
+};
+
+static_assert(static_cast<size_t>(path_pattern::count) <= 64, "path_pattern masks are 64 bits");
+
+using path_mask = uint64_t;
+
+constexpr path_mask to_mask(path_pattern pattern) {
+    return path_mask(1) << static_cast<uint8_t>(pattern);
+}
+
+constexpr path_mask to_mask(std::initializer_list<path_pattern> patterns) {
+    path_mask mask = 0;
+    for (auto pattern : patterns) {
+        mask |= to_mask(pattern);
+    }
+    return mask;
+}
+
+// Indexed by path_pattern
+inline constexpr std::array<std::string_view, static_cast<size_t>(path_pattern::count)>
+    path_patterns = {
+        ".map",
+        ".mapinfo",
+        "hdmu.map",
+        "shared.map",
+        "campaign.map",
+        "mainmenu.map",
+        ".mov",
+        ".film",
+        ".xml.tmp",
+        ".xml.bak",
+        "init.txt",
+        "launch.txt",
+        ".fsb",
+        "hud_scoring.gfx",
+        "loadingscreen.gfx",
+        "restartscreen.gfx",
+        "multiplayerpausedgame.gfx",
+        "soundstream.pck",
+        ".temp",
+        "MCC\\Temporary\\Halo2A\\autosave",
+        "MCC\\Temporary\\Halo3\\autosave",
+        "MCC\\Temporary\\Halo3ODST\\autosave",
+        "MCC\\Temporary\\Halo4\\autosave",
+        "MCC\\Temporary\\HaloReach\\autosave",
+        "MCC\\Config\\autosave_Halo2.bin",
+        "MCC\\Config\\autosave_Halo3.bin",
+        "_Halo1.bin",
+        "_Halo2.bin",
+        "_Halo2A.bin",
+        "_Halo3.bin",
+        "_Halo3ODST.bin",
+        "_Halo4.bin",
+        "_HaloReach.bin",
+        "FMS_MainMenu_v2.bk2",
+        "FMS_logo_microsoft_7_1_.bk2",
+        ".bk2",
+        "halo1",
+        "halo2",
+        "mpcarnagereport",
+        "survivalcarnagereport",
+        "MCC\\Temporary\\UserContent\\Halo2A\\Movie",
+        "MCC\\Temporary\\UserContent\\Halo3\\Movie",
+        "MCC\\Temporary\\UserContent\\Halo3ODST\\Movie",
+        "MCC\\Temporary\\UserContent\\Halo4\\Movie",
+        "MCC\\Temporary\\UserContent\\HaloReach\\Movie",
+        "data\\ui\\Localization",
+        "shared",
+        "cache",
+        "campaign",
+        constants::launcher_exe,
+        "cryptui.dll",
+        "wininet.dll",
+        "winrnr.dll",
+        "wsock32.dll",
+        "PartyWin.dll",
+        "halo1.dll",
+        "halo2.dll",
+        "halo3.dll",
+        "halo3odst.dll",
+        "halo4.dll",
+        "haloreach.dll",
+        "groundhog.dll",
+};
+
+/**
+ * @brief Finds every pattern in a path in one pass: an Aho-Corasick automaton over ASCII case
+ * folded characters, flattened into a transition table so each character costs a class lookup,
+ * a table load and an or. Characters outside the patterns' alphabet (including all non ASCII)
+ * share one class that leads back to the root.
+ *
+ * Built once; classify may be called from any thread.
+ */
+class path_classifier {
+  public:
+    explicit path_classifier(std::span<const std::string_view> patterns) {
+        for (const auto &pattern : patterns) {
+            for (char c : pattern) {
+                auto folded = static_cast<uint8_t>(fold(c));
+                if ((folded < 0x80) && (classes_[folded] == 0)) {
+                    classes_[folded] = static_cast<uint8_t>(++class_count_);
+                }
+            }
+        }
+        ++class_count_; // class 0, for everything else
+        for (size_t c = 'A'; c <= 'Z'; ++c) {
+            classes_[c] = classes_[c - 'A' + 'a'];
+        }
+        while ((size_t(1) << class_shift_) < class_count_) {
+            ++class_shift_;
+        }
+
+        // trie, with -1 for a missing edge
+        std::vector<std::vector<int32_t>> edges(1, std::vector<int32_t>(class_count_, -1));
+        outputs_.assign(1, 0);
+        for (size_t p = 0; p < patterns.size(); ++p) {
+            size_t state = 0;
+            for (char c : patterns[p]) {
+                auto cls = classes_[static_cast<uint8_t>(fold(c))];
+                if (edges[state][cls] < 0) {
+                    edges[state][cls] = static_cast<int32_t>(edges.size());
+                    edges.emplace_back(class_count_, -1);
+                    outputs_.push_back(0);
+                }
+                state = static_cast<size_t>(edges[state][cls]);
+            }
+            outputs_[state] |= path_mask(1) << p;
+        }
+
+        // breadth first, so a state's fail state is complete before the state itself. Rows are
+        // a power of two wide and transitions hold row offsets, keeping a step to a load and add.
+        next_.assign(edges.size() << class_shift_, 0);
+        std::vector<uint32_t> fail(edges.size(), 0);
+        std::deque<size_t> queue;
+        for (size_t cls = 0; cls < class_count_; ++cls) {
+            if (edges[0][cls] > 0) {
+                next_[cls] = static_cast<uint32_t>(edges[0][cls]) << class_shift_;
+                queue.push_back(static_cast<size_t>(edges[0][cls]));
+            }
+        }
+        while (!queue.empty()) {
+            size_t state = queue.front();
+            queue.pop_front();
+            outputs_[state] |= outputs_[fail[state] >> class_shift_];
+            for (size_t cls = 0; cls < class_count_; ++cls) {
+                uint32_t fallback = next_[fail[state] + cls];
+                if (edges[state][cls] < 0) {
+                    next_[(state << class_shift_) + cls] = fallback;
+                    continue;
+                }
+                auto child = static_cast<size_t>(edges[state][cls]);
+                next_[(state << class_shift_) + cls] = static_cast<uint32_t>(child) << class_shift_;
+                fail[child] = fallback;
+                queue.push_back(child);
+            }
+        }
+    }
+
+    // Mask of every pattern found in path, bit i for pattern i; Char is char or wchar_t
+    template <typename Char>
+    path_mask classify(std::basic_string_view<Char> path) const {
+        path_mask mask = 0;
+        uint32_t row = 0;
+        for (Char c : path) {
+            auto code = static_cast<std::make_unsigned_t<Char>>(c);
+            row = next_[row + ((code < 0x80) ? classes_[code] : 0)];
+            mask |= outputs_[row >> class_shift_];
+        }
+        return mask;
+    }
+
+    size_t state_count() const {
+        return outputs_.size();
+    }
+
+  private:
+    static constexpr char fold(char c) {
+        return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    std::array<uint8_t, 0x80> classes_ = {};
+    size_t class_count_ = 0;
+    size_t class_shift_ = 0;
+    std::vector<uint32_t> next_; // (state << class_shift_) + class -> next state << class_shift_
+    std::vector<path_mask> outputs_;
+};
+
+// The classifier for path_patterns, built on first use
+inline const path_classifier &mcc_path_classifier() {
+    static const path_classifier classifier(path_patterns);
+    return classifier;
+}
+
+} // namespace fsm
+} // namespace mccinfo
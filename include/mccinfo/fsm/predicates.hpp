@@ -1,17 +1,16 @@
 #pragma once
 
-#pragma once
-#ifndef NOMINMAX
-#define NOMINMAX
-#include <krabs/krabs.hpp> //#include <windows.h>
-#undef NOMINMAX
-#endif
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <vector>
 
-#include <string>
 #include "mccinfo/constants.hpp"
+#include "mccinfo/fsm/normalized_event.hpp"
+#include "mccinfo/fsm/path_classifier.hpp"
 
 #define CREATE_PREDICATE(condition, target) \
-inline krabs::predicates::all_of target ({\
+inline all_of target ({\
     &likely_is::target,\
     &condition});
 
@@ -63,248 +62,391 @@ enum class handle : uint8_t {
 
 } // opcodes
 
+namespace details {
+
+struct predicate_base {
+    virtual bool operator()(const normalized_event &event) const = 0;
+};
+
+enum class path_property : uint8_t {
+    open_path,
+    file_name,
+};
+
+/**
+ * @brief Matches events whose path contains any of a set of path_patterns. The event carries the
+ * path's classification, so this is a mask test however many patterns are asked about.
+ */
+class path_contains : public predicate_base {
+  public:
+    path_contains(path_property property, path_mask mask)
+        : property_(property), mask_(mask) {}
+
+    bool operator()(const normalized_event &event) const override {
+        auto mask = (property_ == path_property::open_path) ? event.path_mask_
+                                                             : event.image_name_mask_;
+        return (mask & mask_) != 0;
+    }
+
+  private:
+    path_property property_;
+    path_mask mask_;
+};
+
+inline path_contains open_path_contains(path_pattern pattern) {
+    return path_contains(path_property::open_path, to_mask(pattern));
+}
+
+inline path_contains open_path_contains(std::initializer_list<path_pattern> patterns) {
+    return path_contains(path_property::open_path, to_mask(patterns));
+}
+
+inline path_contains image_name_contains(path_pattern pattern) {
+    return path_contains(path_property::file_name, to_mask(pattern));
+}
+
+inline path_contains image_name_contains(std::initializer_list<path_pattern> patterns) {
+    return path_contains(path_property::file_name, to_mask(patterns));
+}
+
+// Holds its predicates by pointer; they must outlive it
+class predicate_list : public predicate_base {
+  public:
+    predicate_list(std::initializer_list<const predicate_base *> predicates)
+        : predicates_(predicates) {}
+
+  protected:
+    std::vector<const predicate_base *> predicates_;
+};
+
+} // details
+
+class opcode_is : public details::predicate_base {
+  public:
+    explicit opcode_is(uint8_t opcode) : opcode_(opcode) {}
+
+    bool operator()(const normalized_event &event) const override {
+        return event.opcode_ == opcode_;
+    }
+
+  private:
+    uint8_t opcode_;
+};
+
+// The whole ImageFileName of a process event; the name is interned up front so a match is an id
+// comparison
+class image_is : public details::predicate_base {
+  public:
+    explicit image_is(std::string_view image_name) : id_(event_paths().intern(image_name)) {}
+
+    bool operator()(const normalized_event &event) const override {
+        return event.image_name_ == id_;
+    }
+
+  private:
+    path_id id_;
+};
+
+class io_size_is : public details::predicate_base {
+  public:
+    explicit io_size_is(uint32_t io_size) : io_size_(io_size) {}
+
+    bool operator()(const normalized_event &event) const override {
+        return (event.source_ == event_source::file_io) && (event.io_size_ == io_size_);
+    }
+
+  private:
+    uint32_t io_size_;
+};
+
+class all_of : public details::predicate_list {
+  public:
+    using predicate_list::predicate_list;
+
+    bool operator()(const normalized_event &event) const override {
+        for (auto predicate : predicates_) {
+            if (!(*predicate)(event)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+class any_of : public details::predicate_list {
+  public:
+    using predicate_list::predicate_list;
+
+    bool operator()(const normalized_event &event) const override {
+        for (auto predicate : predicates_) {
+            if ((*predicate)(event)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+class none_of : public details::predicate_list {
+  public:
+    using predicate_list::predicate_list;
+
+    bool operator()(const normalized_event &event) const override {
+        for (auto predicate : predicates_) {
+            if ((*predicate)(event)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+
 namespace process {
 
-inline auto start                = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::process::start));
-inline auto end                  = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::process::end));
-inline auto alive_at_trace_start = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::process::dc_start));
-inline auto alive_at_trace_end   = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::process::dc_end));
+inline auto start                = opcode_is(static_cast<uint8_t>(opcodes::process::start));
+inline auto end                  = opcode_is(static_cast<uint8_t>(opcodes::process::end));
+inline auto alive_at_trace_start = opcode_is(static_cast<uint8_t>(opcodes::process::dc_start));
+inline auto alive_at_trace_end   = opcode_is(static_cast<uint8_t>(opcodes::process::dc_end));
 
 } // process
 
 namespace fio {
 
-inline auto file_name           = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::fio::file_name));
-inline auto file_name_create    = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::fio::file_name_create));
-inline auto file_name_delete    = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::fio::file_name_delete));
-inline auto file_name_rundown   = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::fio::file_name_rundown));
-inline auto file_create         = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::fio::file_create));
-inline auto file_read           = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::fio::file_read));
-inline auto file_write          = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::fio::file_write));
+inline auto file_name           = opcode_is(static_cast<uint8_t>(opcodes::fio::file_name));
+inline auto file_name_create    = opcode_is(static_cast<uint8_t>(opcodes::fio::file_name_create));
+inline auto file_name_delete    = opcode_is(static_cast<uint8_t>(opcodes::fio::file_name_delete));
+inline auto file_name_rundown   = opcode_is(static_cast<uint8_t>(opcodes::fio::file_name_rundown));
+inline auto file_create         = opcode_is(static_cast<uint8_t>(opcodes::fio::file_create));
+inline auto file_read           = opcode_is(static_cast<uint8_t>(opcodes::fio::file_read));
+inline auto file_write          = opcode_is(static_cast<uint8_t>(opcodes::fio::file_write));
 
 } // fio
 
 namespace image {
 
-inline auto load                  = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::image::load));
-inline auto unload                = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::image::unload));
-inline auto loaded_at_trace_start = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::image::dc_start));
-inline auto loaded_at_trace_end   = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::image::dc_end));
+inline auto load                  = opcode_is(static_cast<uint8_t>(opcodes::image::load));
+inline auto unload                = opcode_is(static_cast<uint8_t>(opcodes::image::unload));
+inline auto loaded_at_trace_start = opcode_is(static_cast<uint8_t>(opcodes::image::dc_start));
+inline auto loaded_at_trace_end   = opcode_is(static_cast<uint8_t>(opcodes::image::dc_end));
 
 } // image
 
 namespace handle {
 
-inline auto create                   = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::handle::create));
-inline auto close                    = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::handle::close));
-inline auto type_open_at_trace_start = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::handle::type_dc_start));
-inline auto type_open_at_trace_end   = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::handle::type_dc_end));
-inline auto open_at_trace_start      = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::handle::dc_start));
-inline auto open_at_trace_end        = krabs::predicates::opcode_is(static_cast<uint8_t>(opcodes::handle::dc_end));
+inline auto create                   = opcode_is(static_cast<uint8_t>(opcodes::handle::create));
+inline auto close                    = opcode_is(static_cast<uint8_t>(opcodes::handle::close));
+inline auto type_open_at_trace_start = opcode_is(static_cast<uint8_t>(opcodes::handle::type_dc_start));
+inline auto type_open_at_trace_end   = opcode_is(static_cast<uint8_t>(opcodes::handle::type_dc_end));
+inline auto open_at_trace_start      = opcode_is(static_cast<uint8_t>(opcodes::handle::dc_start));
+inline auto open_at_trace_end        = opcode_is(static_cast<uint8_t>(opcodes::handle::dc_end));
 
 } // handle
+
 namespace likely_is {
 
-inline auto launcher         = krabs::predicates::property_is(L"ImageFileName", std::string(constants::launcher_exe));
-inline auto eac              = krabs::predicates::property_is(L"ImageFileName", std::string(constants::eac_exe));
-inline auto steam_mcc        = krabs::predicates::property_is(L"ImageFileName", std::string(constants::mcc_steam_exe));
-inline auto msstore_mcc      = krabs::predicates::property_is(L"ImageFileName", std::string(constants::mcc_msstore_exe));
-inline auto mcc              = krabs::predicates::any_of({ &steam_mcc, &msstore_mcc});
-
-
-inline auto map_file = krabs::predicates::property_icontains(L"OpenPath", std::string(".map"));
-inline auto map_info_file = krabs::predicates::property_icontains(L"OpenPath", std::string(".mapinfo"));
-inline auto hdmu_map_file = krabs::predicates::property_icontains(L"OpenPath", std::string("hdmu.map"));
-inline auto shared_map_file = krabs::predicates::property_icontains(L"OpenPath", std::string("shared.map"));
-inline auto campaign_map_file = krabs::predicates::property_icontains(L"OpenPath", std::string("campaign.map"));
-inline auto mainmenu_map_file = krabs::predicates::property_icontains(L"OpenPath", std::string("mainmenu.map"));
-inline auto theater_file = krabs::predicates::property_icontains(L"OpenPath", std::string(".mov"));
-inline auto temp_carnage_report = krabs::predicates::property_icontains(L"OpenPath", std::string(".xml.tmp"));
-inline auto backup_carnage_report = krabs::predicates::property_icontains(L"OpenPath", std::string(".xml.bak"));
-inline auto match_init_file     = krabs::predicates::property_icontains(L"OpenPath", std::string("init.txt"));
-inline auto match_launch_file   = krabs::predicates::property_icontains(L"OpenPath", std::string("launch.txt"));
-inline auto sound_file          = krabs::predicates::property_icontains(L"OpenPath", std::string(".fsb"));
-inline auto hud_scoring_gfx_file = krabs::predicates::property_icontains(L"OpenPath", std::string("hud_scoring.gfx"));
-inline auto loadingscreen_gfx_file = krabs::predicates::property_icontains(L"OpenPath", std::string("loadingscreen.gfx"));
-inline auto restartscreen_gfx_file = krabs::predicates::property_icontains(L"OpenPath", std::string("restartscreen.gfx"));
-inline auto paused_game_gfx_file = krabs::predicates::property_icontains(L"OpenPath", std::string("multiplayerpausedgame.gfx"));
-inline auto soundstream_pck_file = krabs::predicates::property_icontains(L"OpenPath", std::string("soundstream.pck"));
-inline auto match_temp_file = krabs::predicates::property_icontains(L"OpenPath", std::string(".temp"));
-
-inline auto halo2a_autosave_temp_file = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\Halo2A\\autosave"));
-inline auto halo3_autosave_temp_file = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\Halo3\\autosave"));
-inline auto halo3odst_autosave_temp_file = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\Halo3ODST\\autosave"));
-inline auto halo4_autosave_temp_file = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\Halo4\\autosave"));
-inline auto haloreach_autosave_temp_file = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\HaloReach\\autosave"));
-
-inline auto halo2_autosave_bin_file = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Config\\autosave_Halo2.bin"));
-inline auto halo3_autosave_bin_file = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Config\\autosave_Halo3.bin"));
-
-inline auto haloce_lang_bin = krabs::predicates::property_icontains(L"OpenPath", std::string("_Halo1.bin"));
-inline auto halo2_lang_bin = krabs::predicates::property_icontains(L"OpenPath", std::string("_Halo2.bin"));
-inline auto halo2a_lang_bin = krabs::predicates::property_icontains(L"OpenPath", std::string("_Halo2A.bin"));
-inline auto halo3_lang_bin = krabs::predicates::property_icontains(L"OpenPath", std::string("_Halo3.bin"));
-inline auto halo3odst_lang_bin = krabs::predicates::property_icontains(L"OpenPath", std::string("_Halo3ODST.bin"));
-inline auto halo4_lang_bin = krabs::predicates::property_icontains(L"OpenPath", std::string("_Halo4.bin"));
-inline auto haloreach_lang_bin = krabs::predicates::property_icontains(L"OpenPath", std::string("_HaloReach.bin"));
-
-
-inline auto main_menu_background_video_file = krabs::predicates::property_icontains(L"OpenPath", std::string("FMS_MainMenu_v2.bk2"));
-inline auto ms_logo_background_video_file = krabs::predicates::property_icontains(L"OpenPath", std::string("FMS_logo_microsoft_7_1_.bk2"));
-
-
-inline auto background_video_file = krabs::predicates::property_icontains(L"OpenPath", std::string(".bk2"));
-inline auto sound_file_read = krabs::predicates::property_is(L"IoSize", static_cast<uint32_t>(constants::fsb_fio_read_size));
-inline auto halo1_initial_sound_file_read = krabs::predicates::property_is(L"IoSize", static_cast<uint32_t>(constants::halo1_initial_fsb_read_size));
-
-inline auto pak_file_read = krabs::predicates::property_is(L"IoSize", static_cast<uint32_t>(constants::pak_fio_read_size));
-inline auto bk2_file_read = krabs::predicates::property_is(L"IoSize", static_cast<uint32_t>(constants::bk2_fio_read_size));
-inline auto font_package_file_read = krabs::predicates::property_is(L"IoSize", static_cast<uint32_t>(constants::font_package_read_size));
-
-inline auto launcher_image = krabs::predicates::property_icontains(L"FileName", std::string(constants::launcher_exe));
-inline auto cryptui_image = krabs::predicates::property_icontains(L"FileName", std::string("cryptui.dll"));
-inline auto wininet_image = krabs::predicates::property_icontains(L"FileName", std::string("wininet.dll"));
-inline auto winrnr_image = krabs::predicates::property_icontains(L"FileName", std::string("winrnr.dll"));
-inline auto wsock32_image = krabs::predicates::property_icontains(L"FileName", std::string("wsock32.dll"));
-inline auto partywin_image = krabs::predicates::property_icontains(L"FileName", std::string("PartyWin.dll"));
-
-inline auto halo1_image = krabs::predicates::property_icontains(L"FileName", std::string("halo1.dll"));
-inline auto halo2_image = krabs::predicates::property_icontains(L"FileName", std::string("halo2.dll"));
-inline auto halo3_image = krabs::predicates::property_icontains(L"FileName", std::string("halo3.dll"));
-inline auto halo3_odst_image = krabs::predicates::property_icontains(L"FileName", std::string("halo3odst.dll"));
-inline auto halo4_image = krabs::predicates::property_icontains(L"FileName", std::string("halo4.dll"));
-inline auto halo_reach_image = krabs::predicates::property_icontains(L"FileName", std::string("haloreach.dll"));
-inline auto groundhog_image = krabs::predicates::property_icontains(L"FileName", std::string("groundhog.dll"));
+inline auto launcher         = image_is(constants::launcher_exe);
+inline auto eac              = image_is(constants::eac_exe);
+inline auto steam_mcc        = image_is(constants::mcc_steam_exe);
+inline auto msstore_mcc      = image_is(constants::mcc_msstore_exe);
+inline auto mcc              = any_of({ &steam_mcc, &msstore_mcc});
+
+
+inline auto map_file = details::open_path_contains(path_pattern::map_file);
+inline auto map_info_file = details::open_path_contains(path_pattern::map_info_file);
+inline auto hdmu_map_file = details::open_path_contains(path_pattern::hdmu_map_file);
+inline auto shared_map_file = details::open_path_contains(path_pattern::shared_map_file);
+inline auto campaign_map_file = details::open_path_contains(path_pattern::campaign_map_file);
+inline auto mainmenu_map_file = details::open_path_contains(path_pattern::mainmenu_map_file);
+// .mov films, and the .film films Halo 3 and ODST save
+inline auto theater_file = details::open_path_contains({path_pattern::theater_file,
+                                                        path_pattern::theater_film_file});
+inline auto temp_carnage_report = details::open_path_contains(path_pattern::temp_carnage_report);
+inline auto backup_carnage_report = details::open_path_contains(path_pattern::backup_carnage_report);
+inline auto match_init_file     = details::open_path_contains(path_pattern::match_init_file);
+inline auto match_launch_file   = details::open_path_contains(path_pattern::match_launch_file);
+inline auto sound_file          = details::open_path_contains(path_pattern::sound_file);
+inline auto hud_scoring_gfx_file = details::open_path_contains(path_pattern::hud_scoring_gfx_file);
+inline auto loadingscreen_gfx_file = details::open_path_contains(path_pattern::loadingscreen_gfx_file);
+inline auto restartscreen_gfx_file = details::open_path_contains(path_pattern::restartscreen_gfx_file);
+inline auto paused_game_gfx_file = details::open_path_contains(path_pattern::paused_game_gfx_file);
+inline auto soundstream_pck_file = details::open_path_contains(path_pattern::soundstream_pck_file);
+inline auto match_temp_file = details::open_path_contains(path_pattern::match_temp_file);
+
+inline auto halo2a_autosave_temp_file = details::open_path_contains(path_pattern::halo2a_autosave_temp_file);
+inline auto halo3_autosave_temp_file = details::open_path_contains(path_pattern::halo3_autosave_temp_file);
+inline auto halo3odst_autosave_temp_file = details::open_path_contains(path_pattern::halo3odst_autosave_temp_file);
+inline auto halo4_autosave_temp_file = details::open_path_contains(path_pattern::halo4_autosave_temp_file);
+inline auto haloreach_autosave_temp_file = details::open_path_contains(path_pattern::haloreach_autosave_temp_file);
+
+inline auto halo2_autosave_bin_file = details::open_path_contains(path_pattern::halo2_autosave_bin_file);
+inline auto halo3_autosave_bin_file = details::open_path_contains(path_pattern::halo3_autosave_bin_file);
+
+inline auto haloce_lang_bin = details::open_path_contains(path_pattern::haloce_lang_bin);
+inline auto halo2_lang_bin = details::open_path_contains(path_pattern::halo2_lang_bin);
+inline auto halo2a_lang_bin = details::open_path_contains(path_pattern::halo2a_lang_bin);
+inline auto halo3_lang_bin = details::open_path_contains(path_pattern::halo3_lang_bin);
+inline auto halo3odst_lang_bin = details::open_path_contains(path_pattern::halo3odst_lang_bin);
+inline auto halo4_lang_bin = details::open_path_contains(path_pattern::halo4_lang_bin);
+inline auto haloreach_lang_bin = details::open_path_contains(path_pattern::haloreach_lang_bin);
+
+
+inline auto main_menu_background_video_file = details::open_path_contains(path_pattern::main_menu_background_video_file);
+inline auto ms_logo_background_video_file = details::open_path_contains(path_pattern::ms_logo_background_video_file);
+
+
+inline auto background_video_file = details::open_path_contains(path_pattern::background_video_file);
+inline auto sound_file_read = io_size_is(static_cast<uint32_t>(constants::fsb_fio_read_size));
+inline auto halo1_initial_sound_file_read = io_size_is(static_cast<uint32_t>(constants::halo1_initial_fsb_read_size));
+
+inline auto pak_file_read = io_size_is(static_cast<uint32_t>(constants::pak_fio_read_size));
+inline auto bk2_file_read = io_size_is(static_cast<uint32_t>(constants::bk2_fio_read_size));
+inline auto font_package_file_read = io_size_is(static_cast<uint32_t>(constants::font_package_read_size));
+
+inline auto launcher_image = details::image_name_contains(path_pattern::launcher_image);
+inline auto cryptui_image = details::image_name_contains(path_pattern::cryptui_image);
+inline auto wininet_image = details::image_name_contains(path_pattern::wininet_image);
+inline auto winrnr_image = details::image_name_contains(path_pattern::winrnr_image);
+inline auto wsock32_image = details::image_name_contains(path_pattern::wsock32_image);
+inline auto partywin_image = details::image_name_contains(path_pattern::partywin_image);
+
+inline auto halo1_image = details::image_name_contains(path_pattern::halo1_image);
+inline auto halo2_image = details::image_name_contains(path_pattern::halo2_image);
+inline auto halo3_image = details::image_name_contains(path_pattern::halo3_image);
+inline auto halo3_odst_image = details::image_name_contains(path_pattern::halo3_odst_image);
+inline auto halo4_image = details::image_name_contains(path_pattern::halo4_image);
+inline auto halo_reach_image = details::image_name_contains(path_pattern::halo_reach_image);
+inline auto groundhog_image = details::image_name_contains(path_pattern::groundhog_image);
 
 } // likely_is
 
 namespace contains {
-    inline auto halo1 = krabs::predicates::property_icontains(L"OpenPath", std::string("halo1"));
-    inline auto halo2 = krabs::predicates::property_icontains(L"OpenPath", std::string("halo2"));
-    inline auto mpcarnagereport = krabs::predicates::property_icontains(L"OpenPath", std::string("mpcarnagereport"));
-    inline auto survivalcarnagereport = krabs::predicates::property_icontains(L"OpenPath", std::string("survivalcarnagereport"));
-    inline auto h2a_movie_path = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\UserContent\\Halo2A\\Movie"));
-    inline auto h3_movie_path = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\UserContent\\Halo3\\Movie"));
-    inline auto h3odst_movie_path = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\UserContent\\Halo3ODST\\Movie"));
-    inline auto h4_movie_path = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\UserContent\\Halo4\\Movie"));
-    inline auto reach_movie_path = krabs::predicates::property_icontains(L"OpenPath", std::string("MCC\\Temporary\\UserContent\\HaloReach\\Movie"));
-    inline auto ui_localization_path = krabs::predicates::property_icontains(L"OpenPath", std::string("data\\ui\\Localization"));
-    inline auto shared = krabs::predicates::property_icontains(L"OpenPath", std::string("shared"));
-    inline auto cache = krabs::predicates::property_icontains(L"OpenPath", std::string("cache"));
-    inline auto campaign = krabs::predicates::property_icontains(L"OpenPath", std::string("campaign"));
+    inline auto halo1 = details::open_path_contains(path_pattern::contains_halo1);
+    inline auto halo2 = details::open_path_contains(path_pattern::contains_halo2);
+    inline auto mpcarnagereport = details::open_path_contains(path_pattern::contains_mpcarnagereport);
+    inline auto survivalcarnagereport = details::open_path_contains(path_pattern::contains_survivalcarnagereport);
+    inline auto h2a_movie_path = details::open_path_contains(path_pattern::contains_h2a_movie_path);
+    inline auto h3_movie_path = details::open_path_contains(path_pattern::contains_h3_movie_path);
+    inline auto h3odst_movie_path = details::open_path_contains(path_pattern::contains_h3odst_movie_path);
+    inline auto h4_movie_path = details::open_path_contains(path_pattern::contains_h4_movie_path);
+    inline auto reach_movie_path = details::open_path_contains(path_pattern::contains_reach_movie_path);
+    inline auto ui_localization_path = details::open_path_contains(path_pattern::contains_ui_localization_path);
+    inline auto shared = details::open_path_contains(path_pattern::contains_shared);
+    inline auto cache = details::open_path_contains(path_pattern::contains_cache);
+    inline auto campaign = details::open_path_contains(path_pattern::contains_campaign);
 }
 
 namespace certainly_not {
 
-inline krabs::predicates::none_of wininet_image({
+inline none_of wininet_image({
     &likely_is::wininet_image,
 });
 
-inline krabs::predicates::none_of map_info_file({
+inline none_of map_info_file({
     &likely_is::map_info_file,
 });
 
-inline krabs::predicates::none_of shared_map_file({
+inline none_of shared_map_file({
     &likely_is::shared_map_file,
 });
 
-inline krabs::predicates::none_of cache_map_file({
+inline none_of cache_map_file({
     &contains::cache,
 });
 
-inline krabs::predicates::none_of campaign_map_file({
+inline none_of campaign_map_file({
     &likely_is::campaign_map_file,
 });
 
-inline krabs::predicates::none_of hdmu_map_file({
+inline none_of hdmu_map_file({
     &likely_is::hdmu_map_file,
 });
 
-inline krabs::predicates::none_of mainmenu_map_file({
+inline none_of mainmenu_map_file({
     &likely_is::mainmenu_map_file,
 });
 
-inline krabs::predicates::none_of backup_carnage_report({
+inline none_of backup_carnage_report({
     &likely_is::backup_carnage_report,
 });
 
-inline krabs::predicates::none_of temp_carnage_report({
+inline none_of temp_carnage_report({
     &likely_is::temp_carnage_report,
 });
 
 } // certainly_not
 namespace events {
 
-inline krabs::predicates::all_of launcher_started({
+inline all_of launcher_started({
     &likely_is::launcher,
     &process::start,
 });
 
-inline krabs::predicates::all_of launcher_terminated({
+inline all_of launcher_terminated({
     &likely_is::launcher,
     &process::end,
 });
 
-inline krabs::predicates::all_of launcher_found({
+inline all_of launcher_found({
     &likely_is::launcher,
     &process::alive_at_trace_start
 });
 
-inline krabs::predicates::all_of eac_started({
+inline all_of eac_started({
     &likely_is::eac,
     &process::start,
 });
 
-inline krabs::predicates::all_of mcc_started({
+inline all_of mcc_started({
     &likely_is::mcc,
     &process::start,
 });
 
-inline krabs::predicates::all_of mcc_terminated({
+inline all_of mcc_terminated({
     &likely_is::mcc,
     &process::end,
 });
 
-inline krabs::predicates::all_of mcc_found({
+inline all_of mcc_found({
     &likely_is::mcc,
     &process::alive_at_trace_start,
 });
 
-inline krabs::predicates::all_of sound_file_read({
+inline all_of sound_file_read({
     &likely_is::sound_file_read,
     &fio::file_read
 });
 
-inline krabs::predicates::all_of halo1_initial_sound_file_read({
+inline all_of halo1_initial_sound_file_read({
     &likely_is::halo1_initial_sound_file_read,
     &fio::file_read
 });
 
-inline krabs::predicates::all_of bg_video_file_read({
+inline all_of bg_video_file_read({
     &likely_is::bk2_file_read,
     &fio::file_read
 });
 
-inline krabs::predicates::all_of font_package_file_read({
+inline all_of font_package_file_read({
     &likely_is::font_package_file_read,
     &fio::file_read
 });
 
-inline krabs::predicates::none_of not_ms_logo_video_file({
+inline none_of not_ms_logo_video_file({
     &likely_is::ms_logo_background_video_file,
 });
 
-inline krabs::predicates::all_of in_menus_video_file_read({
+inline all_of in_menus_video_file_read({
     &not_ms_logo_video_file,
     &bg_video_file_read
 });
 
-inline krabs::predicates::all_of main_menu_background_video_file_created({
+inline all_of main_menu_background_video_file_created({
     &likely_is::main_menu_background_video_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of non_generic_map_file_created({
+inline all_of non_generic_map_file_created({
     &likely_is::map_file,
     &certainly_not::map_info_file,
     &certainly_not::cache_map_file,
@@ -315,183 +457,188 @@ inline krabs::predicates::all_of non_generic_map_file_created({
     &fio::file_create
 });
 
-inline krabs::predicates::all_of match_init_file_created({
+inline all_of match_init_file_created({
     &likely_is::match_init_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of hud_scoring_gfx_file_created({
+inline all_of hud_scoring_gfx_file_created({
     &likely_is::hud_scoring_gfx_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of restartscreen_gfx_file_created({
+inline all_of restartscreen_gfx_file_created({
     &likely_is::restartscreen_gfx_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of loadingscreen_gfx_file_created({
+inline all_of loadingscreen_gfx_file_created({
     &likely_is::loadingscreen_gfx_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of paused_game_gfx_file_created({
+inline all_of paused_game_gfx_file_created({
     &likely_is::paused_game_gfx_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of temp_carnage_report_created({
+inline all_of temp_carnage_report_created({
     &likely_is::temp_carnage_report,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of mp_temp_carnage_report_created({
+inline all_of mp_temp_carnage_report_created({
     &likely_is::temp_carnage_report,
     &contains::mpcarnagereport,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of survival_temp_carnage_report_created({
+inline all_of survival_temp_carnage_report_created({
     &likely_is::temp_carnage_report,
     &contains::survivalcarnagereport,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of backup_temp_carnage_report_created({
+inline all_of backup_temp_carnage_report_created({
     &likely_is::backup_carnage_report,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of soundstream_pck_file_created({
+inline all_of soundstream_pck_file_created({
     &likely_is::soundstream_pck_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo1_match_init_file_created({
+inline all_of halo1_match_init_file_created({
     &likely_is::match_init_file,
     &contains::halo1,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo2_match_launch_file_created({
+inline all_of halo2_match_launch_file_created({
     &likely_is::match_launch_file,
     &contains::halo2,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of match_temp_file_created({
+inline all_of match_temp_file_created({
     &likely_is::match_temp_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo2a_autosave_temp_file_created({
+inline all_of halo2a_autosave_temp_file_created({
     &likely_is::halo2a_autosave_temp_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo3_autosave_temp_file_created({
+inline all_of halo3_autosave_temp_file_created({
     &likely_is::halo3_autosave_temp_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo3odst_autosave_temp_file_created({
+inline all_of halo3odst_autosave_temp_file_created({
     &likely_is::halo3odst_autosave_temp_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo4_autosave_temp_file_created({
+inline all_of halo4_autosave_temp_file_created({
     &likely_is::halo4_autosave_temp_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of haloreach_autosave_temp_file_created({
+inline all_of haloreach_autosave_temp_file_created({
     &likely_is::haloreach_autosave_temp_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo2a_theater_file_created({
+inline all_of theater_file_created({
+    &likely_is::theater_file,
+    &fio::file_create
+});
+
+inline all_of halo2a_theater_file_created({
     &likely_is::theater_file,
     &contains::h2a_movie_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo3_theater_file_created({
+inline all_of halo3_theater_file_created({
     &likely_is::theater_file,
     &contains::h3_movie_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo3odst_theater_file_created({
+inline all_of halo3odst_theater_file_created({
     &likely_is::theater_file,
     &contains::h3odst_movie_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo4_theater_file_created({
+inline all_of halo4_theater_file_created({
     &likely_is::theater_file,
     &contains::h4_movie_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of haloreach_theater_file_created({
+inline all_of haloreach_theater_file_created({
     &likely_is::theater_file,
     &contains::reach_movie_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo2_autosave_bin_file_created({
+inline all_of halo2_autosave_bin_file_created({
     &likely_is::halo2_autosave_bin_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo3_autosave_bin_file_created({
+inline all_of halo3_autosave_bin_file_created({
     &likely_is::halo3_autosave_bin_file,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of haloce_lang_bin_file_created({
+inline all_of haloce_lang_bin_file_created({
     &likely_is::haloce_lang_bin,
     &contains::ui_localization_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo2_lang_bin_file_created({
+inline all_of halo2_lang_bin_file_created({
     &likely_is::halo2_lang_bin,
     &contains::ui_localization_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo2a_lang_bin_file_created({
+inline all_of halo2a_lang_bin_file_created({
     &likely_is::halo2a_lang_bin,
     &contains::ui_localization_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo3_lang_bin_file_created({
+inline all_of halo3_lang_bin_file_created({
     &likely_is::halo3_lang_bin,
     &contains::ui_localization_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo3odst_lang_bin_file_created({
+inline all_of halo3odst_lang_bin_file_created({
     &likely_is::halo3odst_lang_bin,
     &contains::ui_localization_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of halo4_lang_bin_file_created({
+inline all_of halo4_lang_bin_file_created({
     &likely_is::halo4_lang_bin,
     &contains::ui_localization_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of haloreach_lang_bin_file_created({
+inline all_of haloreach_lang_bin_file_created({
     &likely_is::haloreach_lang_bin,
     &contains::ui_localization_path,
     &fio::file_create
 });
 
-inline krabs::predicates::all_of mcc_launcher_loaded({
+inline all_of mcc_launcher_loaded({
     &likely_is::launcher_image,
     &image::load,
 });
@@ -510,48 +657,49 @@ CREATE_PREDICATE(image::loaded_at_trace_start, partywin_image)
 
 namespace filters {
 
-inline krabs::predicates::any_of file_create_targets({
-    &likely_is::main_menu_background_video_file,
-    &likely_is::background_video_file,
-    &likely_is::match_init_file,
-    &likely_is::match_launch_file,
-    &likely_is::hud_scoring_gfx_file,
-    &likely_is::restartscreen_gfx_file,
-    &likely_is::loadingscreen_gfx_file,
-    &likely_is::temp_carnage_report,
-    &likely_is::backup_carnage_report,
-    &likely_is::soundstream_pck_file,
-    &likely_is::sound_file,
-    &likely_is::map_file,
-    &likely_is::map_info_file,
-    &likely_is::match_temp_file,
-    &likely_is::halo3_autosave_bin_file,
-    &likely_is::halo2a_autosave_temp_file,
-    &likely_is::halo3_autosave_temp_file,
-    &likely_is::halo3odst_autosave_temp_file,
-    &likely_is::halo4_autosave_temp_file,
-    &likely_is::haloreach_autosave_temp_file,
-    &likely_is::theater_file,
-    &likely_is::haloce_lang_bin,
-    &likely_is::halo2_lang_bin,
-    &likely_is::halo2a_lang_bin,
-    &likely_is::halo3_lang_bin,
-    &likely_is::halo3odst_lang_bin,
-    &likely_is::halo4_lang_bin,
-    &likely_is::haloreach_lang_bin
-});
-
-inline krabs::predicates::all_of accepted_file_creates({
+inline auto file_create_targets = details::open_path_contains({
+    path_pattern::main_menu_background_video_file,
+    path_pattern::background_video_file,
+    path_pattern::match_init_file,
+    path_pattern::match_launch_file,
+    path_pattern::hud_scoring_gfx_file,
+    path_pattern::restartscreen_gfx_file,
+    path_pattern::loadingscreen_gfx_file,
+    path_pattern::temp_carnage_report,
+    path_pattern::backup_carnage_report,
+    path_pattern::soundstream_pck_file,
+    path_pattern::sound_file,
+    path_pattern::map_file,
+    path_pattern::map_info_file,
+    path_pattern::match_temp_file,
+    path_pattern::halo3_autosave_bin_file,
+    path_pattern::halo2a_autosave_temp_file,
+    path_pattern::halo3_autosave_temp_file,
+    path_pattern::halo3odst_autosave_temp_file,
+    path_pattern::halo4_autosave_temp_file,
+    path_pattern::haloreach_autosave_temp_file,
+    path_pattern::theater_file,
+    path_pattern::theater_film_file,
+    path_pattern::haloce_lang_bin,
+    path_pattern::halo2_lang_bin,
+    path_pattern::halo2a_lang_bin,
+    path_pattern::halo3_lang_bin,
+    path_pattern::halo3odst_lang_bin,
+    path_pattern::halo4_lang_bin,
+    path_pattern::haloreach_lang_bin
+});
+
+inline all_of accepted_file_creates({
     &fio::file_create,
     &file_create_targets
 });
 
-inline krabs::predicates::all_of accepted_file_deletes({
+inline all_of accepted_file_deletes({
     &fio::file_name_delete,
     &likely_is::backup_carnage_report
 });
 
-inline krabs::predicates::any_of file_io_sizes({
+inline any_of file_io_sizes({
     &likely_is::sound_file_read,
     //&likely_is::pak_file_read,
     //&likely_is::bk2_file_read,
@@ -559,68 +707,52 @@ inline krabs::predicates::any_of file_io_sizes({
     &likely_is::halo1_initial_sound_file_read
 });
 
-inline krabs::predicates::all_of accepted_file_reads({
+inline all_of accepted_file_reads({
     &fio::file_read,
     &file_io_sizes
 });
 
-inline krabs::predicates::any_of image_load_targets({
-    &likely_is::wininet_image,
-    &likely_is::wsock32_image,
-    &likely_is::cryptui_image,
-    &likely_is::winrnr_image,
-    &likely_is::halo1_image,
-    &likely_is::halo2_image,
-    &likely_is::halo3_image,
-    &likely_is::halo3_odst_image,
-    &likely_is::halo4_image,
-    &likely_is::halo_reach_image,
-    &likely_is::groundhog_image,
-    &likely_is::partywin_image,
-});
-
-inline krabs::predicates::all_of accepted_image_loads({
+inline auto image_load_targets = details::image_name_contains({
+    path_pattern::wininet_image,
+    path_pattern::wsock32_image,
+    path_pattern::cryptui_image,
+    path_pattern::winrnr_image,
+    path_pattern::halo1_image,
+    path_pattern::halo2_image,
+    path_pattern::halo3_image,
+    path_pattern::halo3_odst_image,
+    path_pattern::halo4_image,
+    path_pattern::halo_reach_image,
+    path_pattern::groundhog_image,
+    path_pattern::partywin_image
+});
+
+inline all_of accepted_image_loads({
     &image_load_targets,
     &image::loaded_at_trace_start
 });
 
-inline constexpr auto make_process_filter = []() {
-    return krabs::event_filter{
-        krabs::predicates::any_of({
-            &likely_is::launcher,
-            &likely_is::eac,
-            &likely_is::mcc
-        })
-    };
-};
+// What the provider lets through to the fsm, per kernel provider
+inline any_of process_targets({
+    &likely_is::launcher,
+    &likely_is::eac,
+    &likely_is::mcc
+});
 
-inline constexpr auto make_fiio_filter = []() {
-    return krabs::event_filter{
-        krabs::predicates::any_of({
-            &accepted_file_creates,
-            &accepted_file_reads
-        })
-    };
-};
+inline any_of file_io_targets({
+    &accepted_file_creates,
+    &accepted_file_reads
+});
 
-inline constexpr auto make_dummy_image_filter = []() {
-    return krabs::event_filter{
-        krabs::predicates::no_event
-    };
-};
+inline any_of handle_targets({
+    //&handle::create,
+    //&handle::close,
+    //&handle::type_open_at_trace_start,
+    //&handle::type_open_at_trace_end,
+    &handle::open_at_trace_start,
+    &handle::open_at_trace_end
+});
 
-inline constexpr auto make_handle_filter = []() {
-    return krabs::event_filter{
-        krabs::predicates::any_of({
-            //&handle::create,
-            //&handle::close,
-            //&handle::type_open_at_trace_start,
-            //&handle::type_open_at_trace_end,
-            &handle::open_at_trace_start,
-            &handle::open_at_trace_end
-        })
-    };
-};
 } // namespace filters
 } // namespace predicates
 } // namespace fsm
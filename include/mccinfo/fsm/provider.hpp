@@ -1,7 +1,14 @@
 #pragma once
 
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <krabs/krabs.hpp> //#include <windows.h>
+#undef NOMINMAX
+
 #include "mccinfo/query.hpp"
 #include "mccinfo/fsm/controller.hpp"
+#include "mccinfo/fsm/normalized_event.hpp"
 #include "mccinfo/fsm/predicates.hpp"
 #include "lockfree/lockfree.hpp"
 #include <iostream>
@@ -20,11 +27,11 @@ class event_dispatcher {
                 if (stop_)
                     break;
 
-                EVENT_RECORD record;
-                bool read_success = queue_.Pop(record);
+                normalized_event event;
+                bool read_success = queue_.Pop(event);
                 if (read_success) {
                     try {
-                        sm_controller.handle_trace_event(record, *trace_context_);
+                        sm_controller.handle_trace_event(event);
                     }
                     catch (const std::exception& exc) {
                         std::cerr << exc.what();
@@ -39,12 +46,8 @@ class event_dispatcher {
         dispatch_thread_ = std::thread(dispatch);
     }
 
-    void enqueue(const EVENT_RECORD &record) {
-        queue_.Push(record);
-    }
-
-    void set_trace_context(const krabs::trace_context* trace_context) {
-        trace_context_ = const_cast<krabs::trace_context*>(trace_context);
+    void enqueue(const normalized_event &event) {
+        queue_.Push(event);
     }
     
     void stop() {
@@ -59,16 +62,114 @@ class event_dispatcher {
     bool stop_ = false;
     std::mutex mut_;
     std::condition_variable cv_;
-    lockfree::spsc::Queue<EVENT_RECORD, 1000> queue_;
-    krabs::trace_context* trace_context_;
+    lockfree::spsc::Queue<normalized_event, 1000> queue_;
     std::thread dispatch_thread_;
 };
 
 namespace details {
 
-inline bool concrete_image_filter(const EVENT_RECORD& record, const krabs::trace_context& trace_context) {
-    return (*static_cast<krabs::predicates::details::predicate_base *>(
-        &predicates::filters::accepted_image_loads))(record, trace_context);
+inline event_source source_of(const EVENT_RECORD &record) {
+    const GUID &provider = record.EventHeader.ProviderId;
+    if (provider == krabs::guids::process) {
+        return event_source::process;
+    }
+    if (provider == krabs::guids::image_load) {
+        return event_source::image;
+    }
+    if (provider == krabs::guids::file_io) {
+        return event_source::file_io;
+    }
+    return event_source::other;
+}
+
+// Parses what the fsm reads from record; paths are interned in event_paths()
+inline normalized_event normalize(const EVENT_RECORD &record,
+                                  const krabs::trace_context &trace_context) {
+    normalized_event event;
+    event.timestamp_ = record.EventHeader.TimeStamp.QuadPart;
+    event.pid_ = record.EventHeader.ProcessId;
+    event.tid_ = record.EventHeader.ThreadId;
+    event.opcode_ = record.EventHeader.EventDescriptor.Opcode;
+    event.source_ = source_of(record);
+    if (event.source_ == event_source::other) {
+        return event;
+    }
+
+    auto &paths = event_paths();
+    try {
+        krabs::schema schema(record, trace_context.schema_locator);
+        krabs::parser parser(schema);
+        switch (event.source_) {
+        case event_source::process: {
+            std::string image_name;
+            // the predicates intern the names they compare against, so a name never interned
+            // can't match and needn't be kept
+            if (parser.try_parse(L"ImageFileName", image_name)) {
+                event.image_name_ = paths.find(image_name);
+            }
+            parser.try_parse(L"ProcessId", event.process_id_);
+            break;
+        }
+        case event_source::image: {
+            std::wstring file_name;
+            if (parser.try_parse(L"FileName", file_name)) {
+                event.image_name_ = paths.intern_matching(file_name);
+            }
+            parser.try_parse(L"ProcessId", event.process_id_);
+            break;
+        }
+        case event_source::file_io: {
+            std::wstring open_path;
+            if (parser.try_parse(L"OpenPath", open_path)) {
+                event.path_ = paths.intern_matching(open_path);
+            }
+            parser.try_parse(L"IoSize", event.io_size_);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    catch (const std::exception &e) {
+        // no schema for the event; it keeps its header fields and matches no path
+        MI_CORE_TRACE("Could not parse kernel event (opcode {0}): {1}",
+                      static_cast<uint32_t>(event.opcode_), e.what());
+    }
+    event.path_mask_ = paths.mask(event.path_);
+    event.image_name_mask_ = paths.mask(event.image_name_);
+    return event;
+}
+
+/**
+ * @brief The record's normalized_event, parsed on the first call for a record and returned from
+ * a per thread slot after. krabs runs a provider's filter predicate and then its callbacks on the
+ * same record, so both see one parse.
+ */
+inline const normalized_event &normalize_once(const EVENT_RECORD &record,
+                                              const krabs::trace_context &trace_context) {
+    struct slot {
+        const EVENT_RECORD *record = nullptr;
+        normalized_event event;
+    };
+    thread_local slot last;
+
+    // records are reused by the trace session, so the address alone doesn't identify one
+    const auto &header = record.EventHeader;
+    if ((last.record != &record) || (last.event.timestamp_ != header.TimeStamp.QuadPart) ||
+        (last.event.tid_ != header.ThreadId) || (last.event.pid_ != header.ProcessId) ||
+        (last.event.opcode_ != header.EventDescriptor.Opcode)) {
+        last.event = normalize(record, trace_context);
+        last.record = &record;
+    }
+    return last.event;
+}
+
+// A krabs filter that normalizes the record and tests it against an fsm predicate
+inline krabs::event_filter make_filter(const predicates::details::predicate_base &predicate) {
+    return krabs::event_filter(
+        [&predicate](const EVENT_RECORD &record, const krabs::trace_context &trace_context) {
+            return predicate(normalize_once(record, trace_context));
+        });
 }
 
 } // details
@@ -85,13 +186,15 @@ class event_provider {
     void enable_dispatch_to(T* sm) {
         MI_CORE_TRACE("Enabling kernel event dispatch fsm controller ...");
 
-        static krabs::event_filter process_filter = predicates::filters::make_process_filter();
-        static krabs::event_filter fiio_filter = predicates::filters::make_fiio_filter();
+        static krabs::event_filter process_filter =
+            details::make_filter(predicates::filters::process_targets);
+        static krabs::event_filter fiio_filter =
+            details::make_filter(predicates::filters::file_io_targets);
 
         static auto dispatch_event = 
             [=] (const EVENT_RECORD &record, const krabs::trace_context &trace_context) {
                 try {
-                    sm->handle_trace_event(record, trace_context);
+                    sm->handle_trace_event(details::normalize_once(record, trace_context));
                 }
                 catch (const std::exception& e) {
                     std::cerr << e.what() << std::endl;
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "mccinfo/fsm/diagnostics.hpp"
+#include "mccinfo/fsm/edges/edges.hpp"
+#include "mccinfo/fsm/events/events.hpp"
+#include "mccinfo/fsm/normalized_event.hpp"
+
+namespace mccinfo {
+namespace fsm {
+namespace states {
+namespace details {
+
+// Position of _State in _States, or sizeof...(_States) if it isn't one
+template <typename _State, typename... _States>
+constexpr size_t state_index_of() {
+    constexpr std::array<bool, sizeof...(_States)> matches = { std::is_same_v<_State, _States>... };
+    for (size_t i = 0; i < matches.size(); ++i) {
+        if (matches[i]) {
+            return i;
+        }
+    }
+    return sizeof...(_States);
+}
+
+} // details
+
+/**
+ * @brief The edges of every state of one machine, held in place and indexed by the state's
+ * position in _States.
+ *
+ * A state's edges are reset the first time it handles an event after one of them fired, much as
+ * a freshly cloned set would be, so handling events never allocates. The context also tracks
+ * which state its machine is in, so an event is handed to that state's edges with one indexed
+ * call rather than by visiting the machine's current states.
+ */
+template <typename... _States>
+class state_context {
+  public:
+    static constexpr size_t state_count = sizeof...(_States);
+
+    template <typename _State>
+    static constexpr size_t index_of = details::state_index_of<_State, _States...>();
+
+    static constexpr std::array<std::string_view, state_count> state_names = {
+        diagnostics::type_name<_States>()...
+    };
+
+    state_context() : edges_{ _States::edges... } {}
+
+    // The machine's current state, or state_count if it is in none of _States (e.g. terminated)
+    size_t current_state() const {
+        return current_;
+    }
+
+    // Must be called whenever the machine may have changed state, e.g. after process_event
+    void set_current_state(size_t index) {
+        current_ = index;
+    }
+
+    // Hands event to the current state's edges
+    void handle_trace_event(diagnostics::recorder &rec, const normalized_event &event) {
+        using handler = void (state_context::*)(diagnostics::recorder &, const normalized_event &);
+        static constexpr std::array<handler, state_count> handlers = {
+            &state_context::template handle_trace_event<_States>...
+        };
+        if (current_ < state_count) {
+            (this->*handlers[current_])(rec, event);
+        }
+    }
+
+    template <typename _State>
+    void handle_trace_event(diagnostics::recorder &rec, const normalized_event &event) {
+        constexpr size_t index = index_of<_State>;
+        static_assert(index < state_count, "_State is not one of this context's states");
+
+        auto &edges = std::get<index>(edges_);
+        rec.set_state(index);
+        if (live_[index]) {
+            rec.record(diagnostics::record_kind::cache_hit);
+        } else {
+            rec.record(diagnostics::record_kind::cache_miss);
+            edges.reset();
+            live_[index] = true;
+        }
+
+        auto _evt = edges.handle_trace_event(rec, event);
+        if (_evt.has_value()) {
+            push_event(_evt.value(), index);
+        }
+    }
+
+    std::optional<events::event_t> pop_event_from_queue() {
+        if (queued_ == 0) {
+            return std::nullopt;
+        }
+        const auto &_evt_pair = queue_[head_];
+        head_ = (head_ + 1) % queue_.size();
+        queued_ -= 1;
+        live_[_evt_pair.second] = false;
+
+        return _evt_pair.first;
+    }
+
+    size_t event_queue_size() const {
+        return queued_;
+    }
+
+  private:
+    // A machine visits each current state once per event and the queue is drained after, so it
+    // holds at most one event per state; if it ever fills, the oldest event is dropped
+    void push_event(const events::event_t &_evt, size_t index) {
+        if (queued_ == queue_.size()) {
+            pop_event_from_queue();
+        }
+        queue_[(head_ + queued_) % queue_.size()] = { _evt, index };
+        queued_ += 1;
+    }
+
+    std::tuple<std::remove_cv_t<decltype(_States::edges)>...> edges_;
+    std::array<bool, state_count> live_ = {};
+    std::array<std::pair<events::event_t, size_t>, state_count> queue_ = {};
+    size_t head_ = 0;
+    size_t queued_ = 0;
+    size_t current_ = 0; // every machine starts in its first state
+};
+
+namespace details {
+
+// One of this library's states, as opposed to one of sml's own (e.g. its terminate state)
+template <typename _State>
+concept machine_state = requires { _State::edges; };
+
+template <typename _Context, typename _StateList>
+struct covers_states : std::false_type {};
+
+template <typename... _States, template <typename...> class _StateList, typename... _Used>
+struct covers_states<state_context<_States...>, _StateList<_Used...>> {
+    static constexpr size_t used = (size_t(0) + ... + (machine_state<_Used> ? 1 : 0));
+    static constexpr bool value =
+        (used == sizeof...(_States)) &&
+        ((!machine_state<_Used> || (state_index_of<_Used, _States...>() < sizeof...(_States))) &&
+         ...);
+};
+
+} // details
+
+// True if the states in _StateMachine's transition table (_StateMachine::states, the unique list
+// boost::sml::sm builds from it) are exactly _Context's. A state the context lacks would leave
+// current_state() at state_count once entered, and the machine would stop handling events.
+template <typename _StateMachine, typename _Context>
+inline constexpr bool covers_machine_states =
+    details::covers_states<_Context, typename _StateMachine::states>::value;
+
+} // namespace states
+} // namespace fsm
+} // namespace mccinfo
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+#include "mccinfo/file_readers/film_index.hpp"
+#include "mccinfo/fsm/normalized_event.hpp"
+#include "mccinfo/fsm/predicates.hpp"
+
+namespace mccinfo {
+namespace fsm {
+
+// OpenPath is a device path (\Device\HarddiskVolumeN\...); rebase it onto the temp root. The
+// \MCC\Temporary\ part is matched in any case, like the path classifier matches its patterns.
+inline std::optional<std::filesystem::path> rebase_temporary_path(
+    const std::filesystem::path &mcc_temp_root, std::wstring_view open_path) {
+    constexpr std::wstring_view temporary = L"\\MCC\\Temporary\\";
+    auto fold = [](wchar_t c) {
+        return ((c >= L'A') && (c <= L'Z')) ? static_cast<wchar_t>(c - L'A' + L'a') : c;
+    };
+    auto it = std::search(open_path.begin(), open_path.end(), temporary.begin(), temporary.end(),
+                          [&](wchar_t a, wchar_t b) { return fold(a) == fold(b); });
+    if (it == open_path.end()) {
+        return std::nullopt;
+    }
+    auto rest = open_path.substr(static_cast<size_t>(it - open_path.begin()) + temporary.size());
+    return mcc_temp_root / "Temporary" / rest;
+}
+
+// Adds the theater file a create event names to index; the path it was indexed under, if any
+inline std::optional<std::filesystem::path> index_theater_file(
+    file_readers::film_index &index, const std::filesystem::path &mcc_temp_root,
+    const normalized_event &event) {
+    if (!predicates::events::theater_file_created(event)) {
+        return std::nullopt;
+    }
+    auto file = rebase_temporary_path(mcc_temp_root, event_paths().path(event.path_));
+    if (!file.has_value() || !index.Add(file.value())) {
+        return std::nullopt;
+    }
+    return file;
+}
+
+} // namespace fsm
+} // namespace mccinfo
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace mccinfo {
+
+enum class game_hint {
+    HALO1,
+    HALO2,
+    HALO3,
+    HALO3ODST,
+    HALOREACH,
+    HALO4,
+    HALO2A
+};
+
+} // namespace mccinfo
@@ -471,62 +471,6 @@ inline bool by_last_file_write_time(const std::filesystem::path &left,
     return std::filesystem::last_write_time(left) < std::filesystem::last_write_time(right);
 }
 
-inline void PrintTraceEvent(std::wostringstream &woss, const EVENT_RECORD &record,
-                            const krabs::trace_context &trace_context) {
-    woss << L"\t";
-    krabs::schema schema(record, trace_context.schema_locator);
-    krabs::parser parser(schema);
-
-    try {
-        if (schema.event_opcode() != 11) { // Prevent Process_Terminate (Event Version(2))
-            if (schema.event_opcode() != 64) {
-                if (schema.event_opcode() != 67) {
-                    if ((schema.event_opcode() == 3) &&
-                        ((std::wstring(schema.task_name()).find(L"Process") ==
-                          std::wstring::npos))) {
-
-                        std::wstring imagefilename = parser.parse<std::wstring>(L"FileName");
-                        std::uint32_t pid = parser.parse<std::uint32_t>(L"ProcessId");
-
-                        woss << schema.task_name() << L"_" << schema.opcode_name();
-                        woss << L" (" << schema.event_opcode() << L") ";
-                        woss << L" ProcessId=" << pid;
-                        woss << L" ImageFileName=" << imagefilename;
-
-                    } else {
-                        std::string imagefilename = parser.parse<std::string>(L"ImageFileName");
-                        std::uint32_t pid = parser.parse<std::uint32_t>(L"ProcessId");
-                        woss << schema.task_name() << L"_" << schema.opcode_name();
-                        woss << L" (" << schema.event_opcode() << L") ";
-                        woss << L" ProcessId=" << pid;
-                        auto ws = utility::ConvertBytesToWString(imagefilename);
-                        if (ws.has_value())
-                            woss << L" ImageFileName=" << ws.value();
-                    }
-                } else {
-                    uint32_t ttid = parser.parse<uint32_t>(L"TTID");
-                    uint32_t io_size = parser.parse<uint32_t>(L"IoSize");
-
-                    woss << schema.task_name() << L"_" << schema.opcode_name();
-                    woss << L" (" << schema.event_opcode() << L") ";
-                    woss << L" pid=" << std::to_wstring(record.EventHeader.ProcessId);
-                    woss << L" ttid=" << std::to_wstring(ttid);
-                    woss << L" IoSize=" << std::to_wstring(io_size);
-                }
-            } else {
-                std::wstring imagefilename = parser.parse<std::wstring>(L"OpenPath");
-                woss << schema.task_name() << L"_" << schema.opcode_name();
-                woss << L" (" << schema.event_opcode() << L") ";
-                woss << " Path=" << imagefilename;
-            }
-            woss << std::endl;
-        }
-    } catch (const std::exception &exc) {
-        std::cerr << exc.what();
-        throw std::runtime_error("hi :)))))))))))");
-    }
-}
-
 
 } // namespace utility
 } // namespace mccinfo
\ No newline at end of file
@@ -156,9 +156,10 @@ uint32_t GetColorFromTeam(int team, mccinfo::game_hint hint) {
 
 void Monitor::DoTheaterFileInfo() {
 
-    auto emi = context_->get_extended_match_info();
+    // one locked snapshot per frame; the trace thread keeps updating the controller's copy
+    const auto &emi = context_->get_extended_match_info();
     if (emi.theater_file_data_.has_value() ) {
-        auto file_data = emi.theater_file_data_.value();
+        const auto &file_data = emi.theater_file_data_.value();
         
         if (emi.carnage_report_.has_value()) {
             ImGui::Text("Carnage Report:");
@@ -192,7 +193,7 @@ void Monitor::DoTheaterFileInfo() {
             ImGui::TableNextRow();
 
             
-            uint32_t col = GetColorFromTeam(p.first, emi.game_hint_.value());
+            uint32_t col = GetColorFromTeam(p.team_, emi.game_hint_.value());
 
             ImColor imcol = ImColor(
                 (int)((col & 0xFF000000) >> 24), 
@@ -205,7 +206,7 @@ void Monitor::DoTheaterFileInfo() {
             ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg0, row_bg_color);
             
             ImGui::TableSetColumnIndex(0);
-            ImGui::Text("%s", p.second.c_str());
+            ImGui::Text("%s", p.name_.c_str());
             ++i;
         }
         ImGui::EndTable();
@@ -0,0 +1,273 @@
+// Times every title's theater reader over the corpus (default ../test_files) and prints one JSON
+// object per benchmark, so runs can be diffed between releases:
+//
+//   bench_theater_readers [corpus] [iterations]
+//
+// allocs_per_file counts global operator new calls. io_syscalls_per_file counts read and write
+// system calls (/proc/self/io on Linux) or I/O operations (GetProcessIoCounters on Windows);
+// opens, stats and closes are not included. mb_per_s is over the header bytes each read decodes.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#undef NOMINMAX
+#endif
+
+#include "mccinfo/file_readers.hpp"
+
+using namespace mccinfo::file_readers;
+
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept {
+    return operator new(size, tag);
+}
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, size_t) noexcept {
+    std::free(p);
+}
+
+struct io_counters {
+    uint64_t syscalls_ = 0;
+    uint64_t bytes_read_ = 0;
+};
+
+static std::optional<io_counters> ReadIOCounters() {
+    io_counters counters;
+#if defined(_WIN32)
+    IO_COUNTERS io = {};
+    if (!GetProcessIoCounters(GetCurrentProcess(), &io)) {
+        return std::nullopt;
+    }
+    counters.syscalls_ = io.ReadOperationCount + io.WriteOperationCount + io.OtherOperationCount;
+    counters.bytes_read_ = io.ReadTransferCount;
+#else
+    std::ifstream ifs("/proc/self/io");
+    if (!ifs) {
+        return std::nullopt;
+    }
+    std::string key;
+    uint64_t value;
+    while (ifs >> key >> value) {
+        if ((key == "syscr:") || (key == "syscw:")) {
+            counters.syscalls_ += value;
+        } else if (key == "rchar:") {
+            counters.bytes_read_ = value;
+        }
+    }
+#endif
+    return counters;
+}
+
+struct corpus_file {
+    std::filesystem::path path_;
+    uintmax_t size_ = 0;
+};
+
+struct benchmark_result {
+    std::string name_;
+    std::string fields_;
+    size_t files_ = 0;
+    size_t iterations_ = 0;
+    double ns_per_file_ = 0;
+    double mb_per_s_ = 0;
+    double allocs_per_file_ = 0;
+    std::optional<double> io_syscalls_per_file_;
+    std::optional<double> io_bytes_per_file_;
+};
+
+static std::string ToJSON(const benchmark_result &result) {
+    auto optional = [](const std::optional<double> &value) {
+        std::ostringstream oss;
+        if (value.has_value()) {
+            oss << std::fixed << std::setprecision(2) << value.value();
+        } else {
+            oss << "null";
+        }
+        return oss.str();
+    };
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << "{\"benchmark\":\"" << result.name_
+        << "\",\"fields\":\"" << result.fields_ << "\",\"files\":" << result.files_
+        << ",\"iterations\":" << result.iterations_ << ",\"ns_per_file\":" << result.ns_per_file_
+        << ",\"mb_per_s\":" << result.mb_per_s_ << ",\"allocs_per_file\":"
+        << result.allocs_per_file_
+        << ",\"io_syscalls_per_file\":" << optional(result.io_syscalls_per_file_)
+        << ",\"io_bytes_per_file\":" << optional(result.io_bytes_per_file_) << "}";
+    return oss.str();
+}
+
+// Runs read over every file once to warm the page cache, then iterations more times measured
+static benchmark_result Measure(const std::string &name, const std::string &fields,
+                                const std::vector<corpus_file> &files, size_t iterations,
+                                size_t region_size,
+                                const std::function<bool(const std::filesystem::path &)> &read) {
+    benchmark_result result;
+    result.name_ = name;
+    result.fields_ = fields;
+    result.files_ = files.size();
+    result.iterations_ = iterations;
+    if (files.empty()) {
+        return result;
+    }
+
+    for (const auto &file : files) {
+        read(file.path_);
+    }
+
+    // reading the counters costs syscalls of its own; measure that once and take it back out
+    auto overhead_start = ReadIOCounters();
+    auto overhead_end = ReadIOCounters();
+
+    uint64_t region_bytes = 0;
+    auto io_start = ReadIOCounters();
+    uint64_t allocs_start = allocations.load();
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        for (const auto &file : files) {
+            read(file.path_);
+            region_bytes += std::min<uintmax_t>(file.size_, region_size);
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t allocs = allocations.load() - allocs_start;
+    auto io_end = ReadIOCounters();
+
+    double reads = static_cast<double>(iterations * files.size());
+    result.ns_per_file_ = (elapsed.count() * 1e9) / reads;
+    result.mb_per_s_ = (static_cast<double>(region_bytes) / (1024.0 * 1024.0)) / elapsed.count();
+    result.allocs_per_file_ = static_cast<double>(allocs) / reads;
+
+    if (io_start && io_end && overhead_start && overhead_end) {
+        uint64_t syscall_overhead = overhead_end->syscalls_ - overhead_start->syscalls_;
+        uint64_t byte_overhead = overhead_end->bytes_read_ - overhead_start->bytes_read_;
+        result.io_syscalls_per_file_ =
+            static_cast<double>(io_end->syscalls_ - io_start->syscalls_ - syscall_overhead) /
+            reads;
+        result.io_bytes_per_file_ =
+            static_cast<double>(io_end->bytes_read_ - io_start->bytes_read_ - byte_overhead) /
+            reads;
+    }
+    return result;
+}
+
+template <theater_file_layout Layout>
+static void BenchmarkReader(const std::string &name, const std::vector<corpus_file> &files,
+                            size_t iterations) {
+    using reader = theater_file_reader<Layout>;
+
+    static const clock_context clock{};
+    const std::pair<const char *, uint32_t> field_sets[] = {
+        {"all", FIELD_ALL},
+        {"header", FIELD_GAMETYPE | FIELD_DESC | FIELD_AUTHOR_XUID},
+    };
+
+    for (const auto &[label, fields] : field_sets) {
+        auto result = Measure(name, label, files, iterations, reader::GetRegionSize(fields),
+                              [fields](const std::filesystem::path &path) {
+                                  return reader::Read(path, fields, clock).has_value();
+                              });
+        std::cout << ToJSON(result) << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    std::filesystem::path corpus = (argc > 1) ? argv[1] : "../test_files";
+    size_t iterations = (argc > 2) ? std::stoul(argv[2]) : 200;
+
+    std::vector<corpus_file> all, halo3, haloreach, halo4, halo2a;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(corpus)) {
+        auto extension = entry.path().extension();
+        if ((extension != ".film") && (extension != ".mov") && (extension != ".temp")) {
+            continue;
+        }
+
+        std::ifstream ifs(entry.path(), std::ios::binary);
+        std::vector<std::byte> header(theater_file_signature_size);
+        ifs.read(reinterpret_cast<char *>(header.data()),
+                 static_cast<std::streamsize>(header.size()));
+        header.resize(static_cast<size_t>(ifs.gcount()));
+
+        corpus_file file = {entry.path(), entry.file_size()};
+        all.push_back(file);
+
+        auto signature = ClassifyTheaterFile(header);
+        if (!signature.has_value()) {
+            continue;
+        }
+        switch (signature->title_) {
+        case mccinfo::game_hint::HALO3:
+        case mccinfo::game_hint::HALO3ODST:
+            halo3.push_back(file);
+            break;
+        case mccinfo::game_hint::HALOREACH:
+            haloreach.push_back(file);
+            break;
+        case mccinfo::game_hint::HALO4:
+            halo4.push_back(file);
+            break;
+        case mccinfo::game_hint::HALO2A:
+            halo2a.push_back(file);
+            break;
+        default:
+            break;
+        }
+    }
+
+    BenchmarkReader<layouts::halo3>("halo3_theater_file_reader", halo3, iterations);
+    BenchmarkReader<layouts::haloreach>("haloreach_theater_file_reader", haloreach, iterations);
+    BenchmarkReader<layouts::halo4>("halo4_theater_file_reader", halo4, iterations);
+    BenchmarkReader<layouts::halo2a>("halo2a_theater_file_reader", halo2a, iterations);
+
+    // the probe is the smallest read, so it stands in for the bytes of a detected read
+    auto detected = Measure("ReadAnyTheaterFile", "all", all, iterations,
+                            details::theater_file_probe_size,
+                            [](const std::filesystem::path &path) {
+                                return ReadAnyTheaterFile(path).has_value();
+                            });
+    std::cout << ToJSON(detected) << std::endl;
+
+    return all.empty() ? 1 : 0;
+}
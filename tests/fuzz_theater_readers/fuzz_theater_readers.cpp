@@ -0,0 +1,154 @@
+// Feeds theater file headers through the classifier and every title's decoder.
+//
+// libFuzzer:  clang++ -std=c++20 -O1 -g -fsanitize=fuzzer,address -DMCCINFO_LIBFUZZER ...
+//             ./fuzz_theater_readers ../test_files
+// Standalone: mutates each file under the seed directory (default ../test_files) and reports the
+//             slowest decode per seed; exits nonzero if any input exceeds the latency budget.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "mccinfo/file_readers.hpp"
+
+using namespace mccinfo::file_readers;
+
+static volatile size_t sink = 0;
+
+template <theater_file_layout Layout>
+static void DecodeAs(std::span<const std::byte> input) {
+    static const clock_context clock{};
+
+    theater_file_data file_data;
+    theater_file_reader<Layout>::Decode("fuzz.film", input, file_data, FIELD_ALL, clock);
+    sink = sink + file_data.gametype_.size() + file_data.desc_.size() +
+           file_data.player_set_.size();
+}
+
+static void DecodeAll(std::span<const std::byte> input) {
+    auto signature = ClassifyTheaterFile(input);
+    sink = sink + (signature.has_value() ? signature->chdr_version_ : 0);
+
+    DecodeAs<layouts::halo3>(input);
+    DecodeAs<layouts::haloreach>(input);
+    DecodeAs<layouts::halo4>(input);
+    DecodeAs<layouts::halo2a>(input);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    DecodeAll(std::as_bytes(std::span(data, size)));
+    return 0;
+}
+
+#if !defined(MCCINFO_LIBFUZZER)
+
+constexpr uint8_t align = 60;
+constexpr size_t mutations_per_seed = 512;
+
+struct latency_report {
+    size_t inputs_ = 0;
+    std::chrono::nanoseconds max_{0};
+    std::chrono::nanoseconds total_{0};
+    std::string slowest_;
+};
+
+static void Run(std::span<const std::byte> input, const std::string &what,
+                latency_report &report) {
+    auto start = std::chrono::steady_clock::now();
+    DecodeAll(input);
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+
+    ++report.inputs_;
+    report.total_ += elapsed;
+    if (elapsed > report.max_) {
+        report.max_ = elapsed;
+        report.slowest_ = what;
+    }
+}
+
+// Truncations, uniform fills and random byte corruption of one seed
+static latency_report FuzzSeed(std::vector<std::byte> seed, std::mt19937_64 &rng) {
+    latency_report report;
+    Run(seed, "seed", report);
+
+    for (size_t size = 0; size < seed.size(); size += 0x100) {
+        Run(std::span(seed).first(size), "truncated to " + std::to_string(size), report);
+    }
+
+    for (uint8_t fill : {0x00, 0x01, 0xFF}) {
+        std::vector<std::byte> filled(seed.size(), std::byte{fill});
+        Run(filled, "filled with " + std::to_string(fill), report);
+    }
+
+    // most of the decoded fields live in the first 0x2000 bytes, so aim most corruption there
+    std::uniform_int_distribution<size_t> count(1, 32);
+    std::uniform_int_distribution<int> value(0, 0xFF);
+    for (size_t i = 0; i < mutations_per_seed; ++i) {
+        auto mutated = seed;
+        size_t limit = ((i % 4) == 0) ? mutated.size() : std::min<size_t>(mutated.size(), 0x2000);
+        if (limit == 0) {
+            break;
+        }
+        std::uniform_int_distribution<size_t> offset(0, limit - 1);
+        for (size_t n = count(rng); n > 0; --n) {
+            mutated[offset(rng)] = static_cast<std::byte>(value(rng));
+        }
+        Run(mutated, "mutation " + std::to_string(i), report);
+    }
+
+    return report;
+}
+
+int main(int argc, char **argv) {
+    std::filesystem::path corpus = (argc > 1) ? argv[1] : "../test_files";
+    auto budget = std::chrono::microseconds((argc > 2) ? std::stoll(argv[2]) : 5000);
+
+    std::mt19937_64 rng(0x6D6363696E666FULL);
+    latency_report overall;
+
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(corpus)) {
+        auto extension = entry.path().extension();
+        if ((extension != ".film") && (extension != ".mov") && (extension != ".temp")) {
+            continue;
+        }
+
+        std::ifstream ifs(entry.path(), std::ios::binary);
+        std::vector<std::byte> seed(halo4_theater_file_reader::GetRegionSize());
+        ifs.read(reinterpret_cast<char *>(seed.data()), static_cast<std::streamsize>(seed.size()));
+        seed.resize(static_cast<size_t>(ifs.gcount()));
+
+        auto report = FuzzSeed(std::move(seed), rng);
+        auto name = std::filesystem::relative(entry.path(), corpus).generic_string();
+        std::cout << std::left << std::setw(align) << name << report.inputs_ << " inputs, max "
+                  << std::chrono::duration_cast<std::chrono::microseconds>(report.max_).count()
+                  << " us (" << report.slowest_ << "), mean "
+                  << (report.total_.count() / static_cast<long long>(report.inputs_)) << " ns"
+                  << std::endl;
+
+        overall.inputs_ += report.inputs_;
+        overall.total_ += report.total_;
+        if (report.max_ > overall.max_) {
+            overall.max_ = report.max_;
+            overall.slowest_ = name + ", " + report.slowest_;
+        }
+    }
+
+    std::cout << std::left << std::setw(align) << "overall: " << overall.inputs_
+              << " inputs, max "
+              << std::chrono::duration_cast<std::chrono::microseconds>(overall.max_).count()
+              << " us (" << overall.slowest_ << ")" << std::endl;
+
+    bool passed = (overall.inputs_ > 0) && (overall.max_ <= budget);
+    std::cout << (passed ? "PASSED" : "FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
+
+#endif
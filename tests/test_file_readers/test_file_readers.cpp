@@ -0,0 +1,1451 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mccinfo/core/hash.hpp"
+#include "mccinfo/file_readers.hpp"
+#include "mccinfo/file_readers/byte_source.hpp"
+#include "mccinfo/file_readers/carnage_report.hpp"
+#include "mccinfo/file_readers/film_index.hpp"
+#include "mccinfo/file_readers/incremental.hpp"
+#include "mccinfo/file_readers/indexer.hpp"
+#include "mccinfo/file_readers/medal_vector.hpp"
+#include "mccinfo/file_readers/parse_cache.hpp"
+#include "mccinfo/file_readers/stats_store.hpp"
+#include "mccinfo/file_readers/theater_file_data.hpp"
+#include "mccinfo/file_readers/timestamp.hpp"
+#include "mccinfo/file_readers/utf16.hpp"
+#include "mccinfo/fsm/path_classifier.hpp"
+
+using namespace mccinfo::file_readers;
+
+constexpr uint8_t align = 28;
+
+static int failures = 0;
+
+static void Check(bool condition, const std::string &what) {
+    if (!condition) {
+        ++failures;
+        std::cout << "FAILED: " << what << std::endl;
+    }
+}
+
+// Straightforward reference, one code point at a time
+static std::string ReferenceUTF16LEToUTF8(std::span<const std::byte> src, size_t capacity) {
+    std::string out;
+    for (size_t i = 0; (i + 1) < src.size();) {
+        uint32_t cp = std::to_integer<uint32_t>(src[i]) | (std::to_integer<uint32_t>(src[i + 1]) << 8);
+        if (cp == 0) {
+            break;
+        }
+        i += 2;
+        if ((cp >= 0xD800) && (cp < 0xDC00)) {
+            uint32_t low = ((i + 1) < src.size()) ? (std::to_integer<uint32_t>(src[i]) |
+                                                      (std::to_integer<uint32_t>(src[i + 1]) << 8))
+                                                   : 0;
+            if ((low >= 0xDC00) && (low < 0xE000)) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                i += 2;
+            } else {
+                cp = 0xFFFD;
+            }
+        } else if ((cp >= 0xDC00) && (cp < 0xE000)) {
+            cp = 0xFFFD;
+        }
+
+        std::string encoded;
+        if (cp < 0x80) {
+            encoded += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            encoded += static_cast<char>(0xC0 | (cp >> 6));
+            encoded += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            encoded += static_cast<char>(0xE0 | (cp >> 12));
+            encoded += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            encoded += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            encoded += static_cast<char>(0xF0 | (cp >> 18));
+            encoded += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            encoded += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            encoded += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        if ((out.size() + encoded.size()) > capacity) {
+            break;
+        }
+        out += encoded;
+    }
+    return out;
+}
+
+static std::vector<std::byte> ToUTF16LE(std::u16string_view str) {
+    std::vector<std::byte> bytes;
+    for (char16_t c : str) {
+        bytes.push_back(static_cast<std::byte>(c & 0xFF));
+        bytes.push_back(static_cast<std::byte>(c >> 8));
+    }
+    return bytes;
+}
+
+static std::string Transcode(std::span<const std::byte> src, size_t capacity) {
+    std::vector<char> buffer(capacity);
+    return std::string(buffer.data(), TranscodeUTF16LEToUTF8(src, buffer));
+}
+
+static void TestTranscoderCases() {
+    struct test_case {
+        std::u16string input;
+        std::string expected;
+    };
+    const test_case cases[] = {
+        {u"Stehfyn", "Stehfyn"},
+        {u"Mega Bus  discord.gg/MfTucgcJ47", "Mega Bus  discord.gg/MfTucgcJ47"},
+        {std::u16string(u"Free For All\0garbage", 20), "Free For All"},
+        {u"Café über", "Caf\xC3\xA9 \xC3\xBC" "ber"},
+        {u"ハロ", "\xE3\x83\x8F\xE3\x83\xAD"},
+        {u"\U0001F480 skull", "\xF0\x9F\x92\x80 skull"},
+        {std::u16string(1, char16_t(0xD800)) + u"x", "\xEF\xBF\xBDx"},
+        {std::u16string(1, char16_t(0xDC00)), "\xEF\xBF\xBD"},
+    };
+
+    for (const auto &c : cases) {
+        auto bytes = ToUTF16LE(c.input);
+        Check(Transcode(bytes, UTF8CapacityFor(bytes.size())) == c.expected,
+              "transcode \"" + c.expected + "\"");
+    }
+
+    // a code point that does not fit is dropped whole
+    auto bytes = ToUTF16LE(u"abé");
+    Check(Transcode(bytes, 3) == "ab", "truncate before a partial code point");
+    Check(Transcode(std::span(bytes).first(3), 8) == "a", "odd source length");
+}
+
+// Compares every 2 byte aligned window of the corpus headers against the reference, which covers
+// names, descriptions and plenty of non-text bytes that must still decode identically
+static void TestTranscoderCorpus(const std::filesystem::path &root) {
+    size_t files = 0;
+    size_t windows = 0;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(root)) {
+        auto extension = entry.path().extension();
+        if ((extension != ".film") && (extension != ".mov") && (extension != ".temp")) {
+            continue;
+        }
+
+        std::ifstream ifs(entry.path(), std::ios::binary);
+        std::vector<char> raw(0x2000);
+        ifs.read(raw.data(), raw.size());
+        raw.resize(static_cast<size_t>(ifs.gcount()));
+        std::span<const std::byte> header(reinterpret_cast<const std::byte *>(raw.data()),
+                                          raw.size());
+
+        for (size_t offset = 0; (offset + 2) <= header.size(); offset += 2) {
+            for (size_t length : {32, 184, 256}) {
+                auto window = header.subspan(offset, std::min(length, header.size() - offset));
+                for (size_t capacity : {UTF8CapacityFor(window.size()), size_t(21)}) {
+                    if (Transcode(window, capacity) != ReferenceUTF16LEToUTF8(window, capacity)) {
+                        Check(false, entry.path().generic_string() + " @ " +
+                                         std::to_string(offset));
+                    }
+                    ++windows;
+                }
+            }
+        }
+        ++files;
+    }
+
+    std::cout << std::left << std::setw(align) << "corpus files: " << files << std::endl;
+    std::cout << std::left << std::setw(align) << "corpus windows: " << windows << std::endl;
+    Check(files > 0, "corpus at " + root.generic_string() + " is empty");
+}
+
+static void TestPlayerRoster() {
+    player_roster roster;
+    Check(roster.insert(2, "Stehfyn"), "insert");
+    Check(roster.insert(-1, "Stehfyn"), "insert author");
+    Check(roster.insert(0, "Zeta"), "insert");
+    Check(roster.insert(0, "Alpha"), "insert");
+    Check(!roster.insert(2, "Stehfyn"), "duplicate rejected");
+
+    std::vector<std::pair<int, std::string>> order;
+    for (const auto &p : roster) {
+        order.emplace_back(p.team_, p.name_.c_str());
+    }
+    Check(order == std::vector<std::pair<int, std::string>>{
+                       {-1, "Stehfyn"}, {0, "Alpha"}, {0, "Zeta"}, {2, "Stehfyn"}},
+          "roster ordered by team, then name");
+
+    for (int i = 0; i < 64; ++i) {
+        roster.insert(i, "filler");
+    }
+    Check(roster.size() == player_roster::capacity, "roster capped at capacity");
+
+    fixed_string<8> str("caf\xC3\xA9 bar");
+    Check(str.view() == "caf\xC3\xA9 b", "fixed_string truncates");
+    fixed_string<5> cut("caf\xC3\xA9");
+    Check(cut.view() == "caf", "fixed_string keeps whole code points");
+
+    static_assert(std::is_trivially_copyable_v<theater_file_data>);
+}
+
+static void TestTimestamps() {
+    using namespace std::chrono;
+
+    auto parsed = ParseTheaterTimestamp("Friday February 16, 2024 17:02:42");
+    Check(parsed == sys_days(year(2024) / 2 / 16) + hours(17) + minutes(2) + seconds(42),
+          "parse timestamp");
+    Check(ParseTheaterTimestamp("Sunday December 1, 1999 00:00:00") ==
+              sys_days(year(1999) / 12 / 1),
+          "parse single digit day");
+    Check(!ParseTheaterTimestamp("Friday Smarch 16, 2024 17:02:42"), "reject month");
+    Check(!ParseTheaterTimestamp("Friday February 16 2024 17:02:42"), "reject missing comma");
+    Check(!ParseTheaterTimestamp("Friday February 16, 2024 25:02:42"), "reject hour");
+    Check(!ParseTheaterTimestamp("Friday February 16, 9999 17:02:42"), "reject year");
+
+    // commas in the gametype or map must not derail the search
+    auto found =
+        FindTheaterTimestamp("Slayer, Pro on The Pit, Friday February 16, 2024 17:02:42");
+    Check(found == parsed, "find timestamp in description");
+    Check(!FindTheaterTimestamp("Forge film on Bloodline"), "no timestamp in description");
+
+    // 17:02:42 PST + 33s of match is the 0x65D005D4 written into the film's name
+    clock_context pst;
+    pst.utc_offset_ = hours(-8);
+    auto file_time = pst.ToFileTime(parsed.value() + seconds(33));
+    Check(time_point_cast<seconds>(file_clock::to_sys(file_time)).time_since_epoch().count() ==
+              0x65D005D3,
+          "timestamp to file time");
+
+#if !defined(_WIN32)
+    // a captured context uses the offset in effect at each film's own time, whatever it is now
+    const char *tz = std::getenv("TZ");
+    std::string previous_tz = (tz != nullptr) ? tz : "";
+    setenv("TZ", "PST8PDT", 1);
+    tzset();
+    auto pacific = clock_context::Capture();
+    auto utc_of = [&pacific](sys_seconds local_time) {
+        return time_point_cast<seconds>(file_clock::to_sys(pacific.ToFileTime(local_time)));
+    };
+    Check(utc_of(parsed.value()) == parsed.value() + hours(8), "standard time offset");
+    auto summer = sys_days(year(2024) / 7 / 4) + hours(12);
+    Check(utc_of(summer) == summer + hours(7), "daylight saving offset");
+    if (tz != nullptr) {
+        setenv("TZ", previous_tz.c_str(), 1);
+    } else {
+        unsetenv("TZ");
+    }
+    tzset();
+#endif
+}
+
+static void TestHash() {
+    auto hash = [](std::string_view str) {
+        return mccinfo::core::Hash64(std::as_bytes(std::span(str.data(), str.size())));
+    };
+    Check(hash("") == 0xEF46DB3751D8E999ull, "hash empty");
+    Check(hash("abc") == 0x44BC2CF5AD770999ull, "hash short");
+    Check(hash("Nobody inspects the spammish repetition") == 0xFBCEA83C8A378BF1ull,
+          "hash stripes");
+}
+
+static void TestParseCache() {
+    auto dir = std::filesystem::temp_directory_path() / "mccinfo_test_parse_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    auto film = dir / "asq_chill_10DB95E8_65D005D4.film";
+    std::ofstream(film, std::ios::binary) << "film header v1";
+    auto id = file_identity::Of(film);
+    Check(id.has_value(), "identify film");
+
+    theater_file_data data;
+    data.gametype_.assign("Free For All");
+    data.player_set_.insert(0, "Stehfyn");
+    {
+        theater_parse_cache cache;
+        Check(cache.Open(dir / "theater.cache"), "create cache");
+        Check(!cache.Find(*id), "empty cache misses");
+        Check(cache.Store(*id, data, FIELD_GAMETYPE | FIELD_PLAYER_SET), "store");
+    }
+
+    theater_parse_cache cache;
+    Check(cache.Open(dir / "theater.cache") && (cache.Size() == 1), "reopen cache");
+    auto hit = cache.Find(*id, FIELD_GAMETYPE);
+    Check(hit.has_value() && (hit->gametype_.view() == "Free For All") &&
+              (hit->player_set_.size() == 1),
+          "hit after reopen");
+    Check(!cache.Find(*id, FIELD_DESC), "miss on fields not stored");
+
+    // same size, rewritten content: the header hash has to catch it even if the mtime doesn't
+    std::ofstream(film, std::ios::binary) << "film header v2";
+    auto changed = file_identity::Of(film);
+    Check(changed.has_value() && !cache.Find(*changed), "miss after rewrite");
+    Check(!cache.Find(*file_identity::Of(film, 1)), "miss with another seed");
+
+    // enough entries to grow the table a few times
+    for (uint64_t i = 0; i < 5000; ++i) {
+        file_identity fake = *id;
+        fake.path_hash_ = i * 0x9E3779B97F4A7C15ull;
+        cache.Store(fake, data);
+    }
+    cache.Close();
+    Check(cache.Open(dir / "theater.cache") && (cache.Size() == 5001), "grown cache reopens");
+    size_t found = 0;
+    for (uint64_t i = 0; i < 5000; ++i) {
+        file_identity fake = *id;
+        fake.path_hash_ = i * 0x9E3779B97F4A7C15ull;
+        found += cache.Find(fake).has_value() ? 1 : 0;
+    }
+    Check(found == 5000, "every entry survives growing");
+    cache.Close();
+
+    // garbage where the cache should be is replaced, not trusted
+    std::ofstream(dir / "theater.cache", std::ios::binary | std::ios::trunc) << "not a cache";
+    Check(cache.Open(dir / "theater.cache") && (cache.Size() == 0), "corrupt cache recreated");
+    cache.Close();
+
+    std::filesystem::remove_all(dir);
+}
+
+static void TestMedalVector(const std::filesystem::path &root) {
+    auto report = ReadCarnageReport(root / "discrep" / "mpcarnagereport1_3385_0_0.xml");
+    if (!report.has_value()) {
+        Check(false, "medal vector report");
+        return;
+    }
+
+    medal_vector medals;
+    medals.Append(*report);
+    auto view = medals.View();
+
+    bool decoded = (view.PlayerCount() == report->PlayerCount());
+    std::vector<int64_t> totals(400);
+    view.ForEach([&](size_t player, uint16_t id, int32_t count) {
+        decoded &= (count != 0) && (report->MedalCount(player, id) == count);
+        totals[id] += count;
+    });
+    bool sums = true;
+    for (uint16_t id = 0; id < totals.size(); ++id) {
+        sums &= (view.Sum(id) == totals[id]);
+    }
+    Check(decoded && sums, "medal vector round trip");
+
+    // unsorted ids, zero counts dropped, large ids and negative counts, players with no medals
+    medal_vector odd;
+    std::array<uint16_t, 5> ids = {300, 7, 65535, 7000, 2};
+    std::array<int32_t, 5> counts = {1, 0, -5, 200000, 3};
+    odd.Append(ids, counts);
+    odd.Append({}, {});
+    odd.Append(ids, counts);
+    Check((odd.View().Sum(65535) == -10) && (odd.View().Sum(7000) == 400000) &&
+              (odd.View().Sum(7) == 0) && (odd.View().Sum(2) == 6) && (odd.View().Sum(1) == 0),
+          "medal vector odd entries");
+
+    // a dense count per id would be 400 ids x 4 bytes per player
+    Check(medals.Bytes().size() * 20 < (report->PlayerCount() * 400 * sizeof(int32_t)),
+          "medal vector size");
+}
+
+// Paths of the kind FileIo and Image events carry
+static const std::vector<std::wstring> &ClassifierPaths() {
+    static const std::vector<std::wstring> paths = {
+        L"C:\\Program Files (x86)\\Steam\\steamapps\\common\\Halo The Master Chief Collection\\"
+        L"halo3\\maps\\shared.map",
+        L"C:\\Users\\someone\\AppData\\LocalLow\\MCC\\Temporary\\mpcarnagereport1_3385_0_0.xml.tmp",
+        L"C:\\Users\\someone\\AppData\\LocalLow\\MCC\\Temporary\\UserContent\\HaloReach\\Movie\\"
+        L"asq_forge_1234ABCD.mov",
+        L"C:\\Users\\someone\\AppData\\LocalLow\\MCC\\Config\\autosave_Halo3.bin",
+        L"C:\\XboxGames\\Halo The Master Chief Collection\\Content\\data\\ui\\Localization\\"
+        L"en_us_HaloReach.bin",
+        L"\\Device\\HarddiskVolume3\\Windows\\System32\\WININET.dll",
+        L"D:\\MCC\\haloreach\\haloreach.dll",
+        L"D:\\MCC\\MCC\\Content\\Movies\\FMS_MainMenu_v2.bk2",
+        L"D:\\MCC\\halo1\\fmod\\pc\\sfx.FSB",
+        L"D:\\MCC\\CAMPAIGN\\Halo2\\soundstream.pck",
+        L"D:\\MCC\\caché\\ünïcode\\halo4.dll",
+        L"C:\\Windows\\System32\\kernel32.dll",
+        L"",
+        L"halo",
+    };
+    return paths;
+}
+
+static void TestPathClassifier() {
+    using namespace mccinfo::fsm;
+    auto lower = [](wchar_t c) { return ((c >= L'A') && (c <= L'Z')) ? wchar_t(c - L'A' + L'a') : c; };
+    auto contains = [&](std::wstring_view path, std::string_view pattern) {
+        return std::search(path.begin(), path.end(), pattern.begin(), pattern.end(),
+                           [&](wchar_t a, char b) { return lower(a) == lower(wchar_t(b)); }) !=
+               path.end();
+    };
+
+    const auto &classifier = mcc_path_classifier();
+    bool matches = true;
+    for (const auto &path : ClassifierPaths()) {
+        path_mask expected = 0;
+        for (size_t p = 0; p < path_patterns.size(); ++p) {
+            expected |= contains(path, path_patterns[p]) ? (path_mask(1) << p) : 0;
+        }
+        matches &= (classifier.classify(std::wstring_view(path)) == expected);
+    }
+    Check(matches, "path classifier matches substring search");
+
+    auto mask = classifier.classify(std::string_view("X:\\MCC\\TEMPORARY\\HALO4\\AUTOSAVE\\a.TEMP"));
+    Check(mask == to_mask({path_pattern::halo4_autosave_temp_file, path_pattern::match_temp_file}),
+          "path classifier overlapping patterns");
+}
+
+static void TestStatsStore(const std::filesystem::path &root) {
+    auto dir = std::filesystem::temp_directory_path() / "mccinfo_test_stats_store";
+    std::filesystem::remove_all(dir);
+
+    auto discrep = ReadCarnageReport(root / "discrep" / "mpcarnagereport1_3385_0_0.xml");
+    auto quitted = ReadCarnageReport(root / "quittedplayers" / "mpcarnagereport1_3385_0_0.xml");
+    if (!discrep.has_value() || !quitted.has_value()) {
+        Check(false, "stats store reports");
+        return;
+    }
+
+    int64_t kills = 0;
+    int64_t medal8 = 0; // a second discrep is appended below, hence doubled
+    for (const auto *report : {&*discrep, &*quitted}) {
+        for (int32_t k : report->Stat(carnage_player_stat::KILLS)) {
+            kills += k;
+        }
+        for (size_t i = 0; i < report->PlayerCount(); ++i) {
+            medal8 += report->MedalCount(i, 8) * ((report == &*discrep) ? 2 : 1);
+        }
+    }
+
+    {
+        stats_store store;
+        Check(store.Open(dir), "create stats store");
+        Check(store.Append(*discrep, "Lockout") && store.Append(*quitted, "Zanzibar") &&
+                  store.Append(*discrep, "Zanzibar"),
+              "stats store append");
+    }
+
+    stats_store store;
+    Check(store.Open(dir) && (store.RowCount() == 13 + 16 + 13) && (store.MatchCount() == 3),
+          "stats store reopen");
+    auto view = store.View();
+    auto kills_column = StatsColumn(carnage_player_stat::KILLS);
+    Check((view.Count() == 42) &&
+              (view.Sum(kills_column) == kills + view.Sum(kills_column, std::array{stats_range{
+                                                                 stats_column::MATCH, 2, 2}})),
+          "stats store count and sum");
+
+    auto gamertag = store.StringId("CheckMate240hz");
+    auto zanzibar = store.StringId("Zanzibar");
+    Check(gamertag.has_value() && zanzibar.has_value() &&
+              (store.String(*zanzibar) == "Zanzibar") && !store.StringId("Valhalla"),
+          "stats store dictionary");
+
+    // kills and deaths per gamertag per map, then one gamertag's row of that
+    std::array keys = {stats_column::GAMERTAG, stats_column::MAP};
+    std::array values = {kills_column, StatsColumn(carnage_player_stat::DEATHS)};
+    auto groups = view.GroupBy(keys, values);
+    auto group = std::find_if(groups.begin(), groups.end(), [&](const stats_group &g) {
+        return (g.keys_[0] == *gamertag) && (g.keys_[1] == *zanzibar);
+    });
+    Check(std::is_sorted(groups.begin(), groups.end(),
+                         [](const auto &a, const auto &b) { return a.keys_ < b.keys_; }) &&
+              (group != groups.end()) && (group->rows_ == 1) && (group->sums_[0] == 22),
+          "stats store group by");
+
+    std::array filter = {stats_range{stats_column::GAMERTAG, *gamertag, *gamertag}};
+    Check((view.Count(filter) == 2) && (view.Sum(kills_column, filter) == 44),
+          "stats store filter");
+    Check((view.SumMedal(8, filter) == 12) && (view.SumMedal(8) == medal8),
+          "stats store medals");
+
+    // enough rows to seal segments; zone maps then rule whole segments in or out
+    auto big = std::move(*discrep);
+    for (size_t c = 0; c < static_cast<size_t>(carnage_player_stat::COUNT); ++c) {
+        auto &column = big.stats_[c];
+        for (size_t i = column.size(); i < 10000; ++i) {
+            column.push_back(column[i % 13]);
+        }
+    }
+    for (auto &column : big.texts_) {
+        column.resize(10000, column[0]);
+    }
+    big.xbox_user_id_.resize(10000);
+    big.medals_begin_.resize(10000, static_cast<uint32_t>(big.medal_ids_.size()));
+    big.custom_stats_begin_.resize(10000, static_cast<uint32_t>(big.custom_stat_names_.size()));
+    for (int i = 0; i < 20; ++i) {
+        store.Append(big, "Ascension");
+    }
+    view = store.View();
+    std::array late = {stats_range{stats_column::MATCH, 13, 22}};
+    Check((view.MatchCount() == 23) &&
+              (view.SumMedal(8, late) == 10 * view.Medals(3).Sum(8)) &&
+              (view.SumMedal(8) == view.SumMedal(8, std::array{stats_range{stats_column::MATCH,
+                                                                            0, 22}})),
+          "stats store segment medals");
+    Check((view.Zones().size() == 4) && (view.Count() == 200042) &&
+              (view.Count(late) == 100000) &&
+              (view.Sum(kills_column, late) == 10 * view.Sum(kills_column, std::array{stats_range{
+                                                                 stats_column::MATCH, 3, 3}})),
+          "stats store segments");
+
+    // bytes past the manifest, as an interrupted append leaves them, are dropped on open
+    store.Close();
+    std::ofstream(dir / "column_0.i32", std::ios::binary | std::ios::app) << "torn";
+    Check(store.Open(dir) && (store.RowCount() == 200042) &&
+              (store.View().Count(late) == 100000),
+          "stats store torn append");
+    store.Close();
+
+    std::filesystem::remove_all(dir);
+}
+
+static void TestCarnageParseCache(const std::filesystem::path &root) {
+    auto dir = std::filesystem::temp_directory_path() / "mccinfo_test_carnage_parse_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+
+    auto xml = dir / "mpcarnagereport1_3385_0_0.xml";
+    std::filesystem::copy_file(root / "quittedplayers" / "mpcarnagereport1_3385_0_0.xml", xml);
+
+    auto report = LoadCarnageReport(xml);
+    auto uncached = ReadCarnageReportRows(xml);
+    Check(report.has_value() && uncached.has_value() && (uncached->player_count_ == 16) &&
+              (uncached->gamertag_[0].view() ==
+               UnescapeXML(report->Text(carnage_player_text::GAMERTAG, 0))) &&
+              (uncached->xbox_user_id_[15] == report->xbox_user_id_[15]) &&
+              (uncached->Stat(carnage_player_stat::KILLS, 15) ==
+               report->Stat(carnage_player_stat::KILLS, 15)),
+          "carnage rows");
+
+    carnage_parse_cache cache;
+    Check(cache.Open(dir / "carnage.cache"), "create carnage cache");
+    auto stored = ReadCarnageReportRows(xml, &cache);
+    Check(stored.has_value() && (cache.Size() == 1), "carnage rows stored");
+
+    // a hit doesn't parse, so one that differs from the file can only have come from the cache
+    auto id = file_identity::Of(xml);
+    auto marked = stored.value();
+    marked.game_enum_ = -1;
+    cache.Store(*id, marked);
+    auto hit = ReadCarnageReportRows(xml, &cache);
+    Check(hit.has_value() && (hit->game_enum_ == -1) &&
+              (std::memcmp(&hit->stats_, &uncached->stats_, sizeof(hit->stats_)) == 0),
+          "carnage rows from cache");
+
+    std::filesystem::copy_file(root / "discrep" / "mpcarnagereport1_3385_0_0.xml", xml,
+                               std::filesystem::copy_options::overwrite_existing);
+    auto changed = ReadCarnageReportRows(xml, &cache);
+    Check(changed.has_value() && (changed->player_count_ == 13) && (changed->game_enum_ == 2),
+          "carnage rows after the report changed");
+
+    Check(!ReadCarnageReportRows(dir / "missing.xml", &cache), "carnage rows missing report");
+    cache.Close();
+
+    std::filesystem::remove_all(dir);
+}
+
+static void TestByteSources() {
+    std::vector<std::byte> bytes(100);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = static_cast<std::byte>(i);
+    }
+    auto all = std::span<const std::byte>(bytes);
+
+    buffer_source buffer(all);
+    Check(buffer.View(90, 20).value().size() == 10, "buffer view clipped to the end");
+    Check(buffer.View(200, 1).value().empty(), "buffer view past the end");
+
+    // the empty chunk must not confuse the chunk lookup
+    chunked_source chunked({all.subspan(0, 30), all.subspan(30, 0), all.subspan(30, 70)});
+    Check(chunked.size() == 100, "chunked size");
+    auto inside = chunked.View(30, 20);
+    Check(inside.has_value() && (inside->data() == bytes.data() + 30), "chunked view in place");
+    Check(!chunked.View(20, 20).has_value(), "chunked view across chunks");
+
+    std::vector<std::byte> copy(40);
+    Check((chunked.Read(10, copy) == 40) &&
+              std::equal(copy.begin(), copy.end(), bytes.begin() + 10),
+          "chunked read across chunks");
+    Check(chunked.Read(80, copy) == 20, "chunked read clipped to the end");
+
+    std::vector<std::byte> scratch;
+    auto region = details::SourceRegion(chunked, 64, scratch);
+    Check((region.size() == 64) && (region.data() == scratch.data()) &&
+              std::equal(region.begin(), region.end(), bytes.begin()),
+          "region copied out of chunks");
+    Check(details::SourceRegion(buffer, 64, scratch).data() == bytes.data(),
+          "region in place from a buffer");
+}
+
+static void TestFilmIndex(const std::filesystem::path &root) {
+    Check(ParseFilmId("asq_chill_10db95e8.temp") == 0x10DB95E8, "film id of an autosave");
+    Check(ParseFilmId("asq_chill_10DB95E8_65D005D4.film") == 0x10DB95E8, "film id of a film");
+    Check(ParseFilmId("asq_mglo-1_ca_blood__EF1D6BDB_65CD5EA3.mov") == 0xEF1D6BDB,
+          "film id after an empty token");
+    Check(!ParseFilmId("asq_chill_10db95e8.xml").has_value(), "film id of a non theater file");
+    Check(!ParseFilmId("asq_chill_65D005D4.film").has_value(), "film id of a film without one");
+    Check(!ParseFilmId("asq_chill_10dbx5e8.temp").has_value(), "film id with a non hex digit");
+
+    film_index index;
+    Check(index.Scan(root) > 0, "film index scan");
+
+    auto match = index.FindMatchingFilm("autosave/asq_chill_10db95e8.temp");
+    Check(match.has_value() && (match->filename() == "asq_chill_10DB95E8_65D005D4.film"),
+          "film index matches autosave to film");
+    Check(!index.FindMatchingFilm("asq_fortres_4adf5ce9.temp").has_value(),
+          "film index without a saved film");
+
+    index.Remove(match.value());
+    Check(!index.FindMatchingFilm("asq_chill_10db95e8.temp").has_value(), "film index remove");
+    Check(index.Add(match.value()) && index.FindMatchingFilm("asq_chill_10db95e8.temp"),
+          "film index add");
+
+    Check((GetFilmKind("asq_chill_10db95e8.TEMP") == film_kind::AUTOSAVE) &&
+              (GetFilmKind("asq_chill_10DB95E8_65D005D4.Film") == film_kind::FILM) &&
+              (ParseFilmId("ASQ_MGLO-1_CA_BLOOD__EF1D6BDB_65CD5EA3.MOV") == 0xEF1D6BDB),
+          "film extensions ignore case");
+
+    // a film moved away without a delete event is replaced by rescanning, as the controller does
+    // when copying the stale entry fails
+    auto moved = std::filesystem::path("moved") / match->filename();
+    index.Add(moved);
+    Check(index.FindMatchingFilm("asq_chill_10db95e8.temp") == moved, "film index stale entry");
+    index.Remove(moved);
+    index.Scan(root);
+    Check(index.FindMatchingFilm("asq_chill_10db95e8.temp") == match, "film index rescanned");
+}
+
+static std::string ReadWholeFile(const std::filesystem::path &path) {
+    std::ifstream ifs(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+// What each corpus film decodes to, as the original stream readers read it
+struct expected_film {
+    std::string_view path_;
+    mccinfo::game_hint title_;
+    std::string_view gametype_;
+    std::string_view desc_;
+    std::string_view xuid_;
+    int64_t utc_seconds_; // the description's time (plus Halo 3's match length) at UTC+0
+    std::string_view author_;
+    std::vector<std::pair<int, std::string_view>> players_; // by team, then name
+    bool autosave_ = false; // Reach autosaves don't hold the author or players where films do
+};
+
+static const std::vector<expected_film> &ExpectedFilms() {
+    static const std::vector<expected_film> films = {
+        { "asq_mglo-0_forge_hal_D17604F4_65D2F98A.film", mccinfo::game_hint::HALOREACH,
+          "Mega Bus  discord.gg/MfTucgcJ47",
+          "Mega Bus  discord.gg/MfTucgcJ47 on Mega Gulch v5.9, Sunday February 18, 2024 22:46:30",
+          "0x00090000014CBF3B", 0x65D288C6, "Stehfyn",
+          {
+            { -1, "Stehfyn" }, { 1, "ObjOriented" }
+          } },
+        { "asq_mglo-12_forge_hal_a9de860a.temp", mccinfo::game_hint::HALOREACH,
+          "Death trap Race (Warthog)", "Warthog Race", "0x00090000021D9434", 0, "", {}, true },
+        { "asq_mglo-7_forge_hal_8CBF3A80_65D2F931.film", mccinfo::game_hint::HALOREACH,
+          "Kill Zeus", "Kill Zeus on Pluto's Rings, Sunday February 18, 2024 22:45:41",
+          "0x00090000014CBF3B", 0x65D28895, "Stehfyn",
+          {
+            { -1, "Stehfyn" }, { 0, "NukeOhio2024" }, { 1, "Honor Da Reefer" },
+            { 2, "I DarkNix I" }, { 3, "MonkeyShrapnel" }, { 4, "SchJedi4" }, { 5, "SlumplordxTV" },
+            { 6, "DiamondGamerPJ" }, { 8, "connn911" }, { 9, "Dragneel5910" }, { 10, "Failburger" },
+            { 11, "Stylisttt" }, { 12, "DJJOKER1275" }, { 13, "TrickishInk1179" },
+            { 15, "RealTuxedoMask" }
+          } },
+        { "asq_mglo-9_70_boneya_15a78ff0.temp", mccinfo::game_hint::HALOREACH,
+          "Warzone: Boneyard",
+          "To change teams, open the menu, then press \"X\" to open the roster, then select "
+          "your name, then select \"change teams\".",
+          "0x000900000456D2C0", 0, "", {}, true },
+        { "discrep/asq_chill_10DB95E8_65D005D4.film", mccinfo::game_hint::HALO3, "Free For All",
+          "Free For All on Narrows, Friday February 16, 2024 17:02:42", "0x00090000014CBF3B",
+          0x65CF9553, "",
+          {
+            { 0, "CTR typcalsaus" }, { 1, "GamepassTrashh" }, { 2, "I PizzaKat I" },
+            { 6, "Eulersgold8697" }, { 8, "JebusFonYT" }, { 9, "NicKnack37" }, { 10, "Maj3va" },
+            { 14, "SmittenAtol5998" }, { 15, "Red H3" }
+          } },
+        { "discrep/asq_chill_10db95e8.temp", mccinfo::game_hint::HALO3, "Free For All",
+          "Free For All on Narrows, Friday February 16, 2024 17:02:42", "0x00090000014CBF3B",
+          0x65CF9532, "",
+          {
+            { 0, "CTR typcalsaus" }, { 1, "GamepassTrashh" }, { 2, "I PizzaKat I" },
+            { 6, "Eulersgold8697" }, { 8, "JebusFonYT" }, { 9, "NicKnack37" }, { 10, "Maj3va" },
+            { 14, "SmittenAtol5998" }, { 15, "Red H3" }
+          } },
+        { "quittedplayers/asq_constru_16E9C67D_65D0095E.film", mccinfo::game_hint::HALO3,
+          "HIDE N' SEEK", "HIDE N' SEEK on Construct, Friday February 16, 2024 17:16:57",
+          "0x00090000014CBF3B", 0x65CF98DD, "",
+          {
+            { 0, "CheezyDude117" }, { 1, "Memphos" }, { 2, "Lykenator7036" },
+            { 4, "MasteRxChieF337" }, { 5, "Kihhj" }, { 6, "JarheadXCIX" }, { 7, "CosmicBitFlp" },
+            { 8, "Western yeet183" }, { 9, "MoistGranny9139" }, { 10, "Fasty9257" },
+            { 12, "jake136929" }, { 13, "Phoenix50503420" }, { 14, "champion00921" },
+            { 15, "FungousCaake345" }
+          } },
+        { "quittedplayers/asq_constru_16e9c67d.temp", mccinfo::game_hint::HALO3, "HIDE N' SEEK",
+          "HIDE N' SEEK on Construct, Friday February 16, 2024 17:16:57", "0x00090000014CBF3B",
+          0x65CF9889, "",
+          {
+            { 0, "CheezyDude117" }, { 1, "Memphos" }, { 2, "Lykenator7036" },
+            { 4, "MasteRxChieF337" }, { 5, "Kihhj" }, { 6, "JarheadXCIX" }, { 7, "CosmicBitFlp" },
+            { 8, "Western yeet183" }, { 9, "MoistGranny9139" }, { 10, "Fasty9257" },
+            { 12, "jake136929" }, { 13, "Phoenix50503420" }, { 14, "champion00921" },
+            { 15, "FungousCaake345" }
+          } },
+        { "quittedplayers2/asq_bunkerw_f8eb030c.temp", mccinfo::game_hint::HALO3,
+          "FatKid S.castle", "FatKid S.castle on HolyCastle, Friday February 16, 2024 17:20:45",
+          "0x00090000014CBF3B", 0x65CF996D, "",
+          {
+            { 0, "selfishturtle32" }, { 1, "SilverLugia3" }, { 2, "SpacedZed" }, { 3, "Cod roby" },
+            { 4, "SnippyGeoduck81" }, { 5, "DrinkableColt97" }, { 6, "KaizerUnlimited" },
+            { 7, "Papacurrier" }, { 8, "Bluecarpet11257" }, { 9, "TrevWoo" },
+            { 10, "BobaFentanoI" }, { 11, "a Tiger Woods" }, { 12, "Perry7527" },
+            { 13, "xXBigBrouXx" }
+          } },
+        { "quittedplayers3/asq_fortres_4adf5ce9.temp", mccinfo::game_hint::HALO3, "Free For All",
+          "Free For All on Citadel, Friday February 16, 2024 17:35:38", "0x00090000014CBF3B",
+          0x65CF9CEA, "",
+          {
+            { 0, "CTR typcalsaus" }, { 1, "Ardmanuk" }, { 2, "PrettyCalf35321" }, { 3, "Monarch" },
+            { 4, "Saandow" }, { 5, "Doership" }, { 6, "Gravity Quiet" }, { 7, "Fozzz" },
+            { 8, "JebusFonYT" }, { 9, "Your Sick Kicks" }, { 10, "Cfalcone1337" },
+            { 11, "lTwotrainzl" }, { 15, "Red H3" }
+          } },
+        { "theater/asq_chill_2F9617DA_65CD4817.mov", mccinfo::game_hint::HALO3, "2V2 HARDCORE TS",
+          "2V2 HARDCORE TS on Narrows, Wednesday February 14, 2024 15:08:53",
+          "0x00090000014CBF3B", 0x65CCD794, "", { { 2, "Stehfyn" } } },
+        { "theater/asq_cyberdy_76983873_65CD4A34.mov", mccinfo::game_hint::HALO3,
+          "2V2 HARDCORE TS", "2V2 HARDCORE TS on The Pit, Wednesday February 14, 2024 15:17:58",
+          "0x00090000014CBF3B", 0x65CCD9B0, "", { { 7, "Stehfyn" } } },
+        { "theater/asq_deadloc_D334F66F_65CD3B9A.mov", mccinfo::game_hint::HALO3,
+          "2V2 HARDCORE TS",
+          "2V2 HARDCORE TS on High Ground, Wednesday February 14, 2024 14:15:27",
+          "0x00090000014CBF3B", 0x65CCCB18, "", { { 2, "Stehfyn" } } },
+        { "theater/asq_mglo--1_ca_coagul_9B64410D_65CC5BEC.mov", mccinfo::game_hint::HALO2A,
+          "Forge", "Forge film on Bloodline, Tuesday February 13, 2024 22:21:09",
+          "0x00090000014CBF3B", 0x65CBEB55, "Stehfyn", { { -1, "Stehfyn" }, { 0, "Stehfyn" } } },
+        { "theater/asq_mglo-1_30_settle_473F3AE8_65CD604A.mov", mccinfo::game_hint::HALOREACH,
+          "TU TEAM SLAYER DMR",
+          "TU TEAM SLAYER DMR on Powerhouse, Wednesday February 14, 2024 16:51:30",
+          "0x00090000014CBF3B", 0x65CCEF92, "Stehfyn", { { -1, "Stehfyn" }, { 2, "Stehfyn" } } },
+        { "theater/asq_mglo-1_50_panopt_0833D7C9_65CD6095.mov", mccinfo::game_hint::HALOREACH,
+          "TU TEAM SLAYER DMR",
+          "TU TEAM SLAYER DMR on Boardwalk, Wednesday February 14, 2024 16:53:04",
+          "0x00090000014CBF3B", 0x65CCEFF0, "Stehfyn", { { -1, "Stehfyn" }, { 3, "Stehfyn" } } },
+        { "theater/asq_mglo-1_ca_blood__EF1D6BDB_65CD5EA3.mov", mccinfo::game_hint::HALO4,
+          "Infinity Slayer", "Infinity Slayer on Exile, Wednesday February 14, 2024 16:44:46",
+          "0x00090000014CBF3B", 0x65CCEDFE, "Stehfyn", { { -1, "Stehfyn" }, { 7, "Stehfyn" } } },
+        { "theater/asq_mglo-1_ca_lockou_1D8C84F5_65CD4FD6.mov", mccinfo::game_hint::HALO2A,
+          "Slayer", "Slayer on Lockdown, Wednesday February 14, 2024 15:41:34",
+          "0x00090000014CBF3B", 0x65CCDF2E, "Stehfyn", { { -1, "Stehfyn" }, { 0, "Stehfyn" } } },
+        { "theater/asq_mglo-1_ca_zanzib_C547D1C2_65CD5BDC.mov", mccinfo::game_hint::HALO2A,
+          "Team Slayer", "Team Slayer on Stonetown, Wednesday February 14, 2024 16:33:02",
+          "0x00090000014CBF3B", 0x65CCEB3E, "Stehfyn", { { -1, "Stehfyn" }, { 5, "Stehfyn" } } },
+        { "theater/asq_mglo-1_z05_cliff_BB68C6C9_65CD5EEE.mov", mccinfo::game_hint::HALO4,
+          "Infinity Slayer", "Infinity Slayer on Complex, Wednesday February 14, 2024 16:45:58",
+          "0x00090000014CBF3B", 0x65CCEE46, "Stehfyn", { { -1, "Stehfyn" }, { 5, "Stehfyn" } } },
+        { "theater/asq_mglo-8_ca_warloc_21CB8CB4_65CC5C51.mov", mccinfo::game_hint::HALO2A,
+          "3 Plots", "3 Plots on Warlord, Tuesday February 13, 2024 22:22:47",
+          "0x00090000014CBF3B", 0x65CBEBB7, "Stehfyn", { { -1, "Stehfyn" }, { 0, "Stehfyn" } } },
+        { "theater/asq_riverwo_B0C30266_65CD4B72.mov", mccinfo::game_hint::HALO3,
+          "2V2 HARDCORE TS", "2V2 HARDCORE TS on Valhalla, Wednesday February 14, 2024 15:23:16",
+          "0x00090000014CBF3B", 0x65CCDAEF, "", { { 4, "Stehfyn" } } },
+        { "theater/asq_shrine_2B3D4DE9_65CD4B10.mov", mccinfo::game_hint::HALO3,
+          "2V2 HARDCORE TS", "2V2 HARDCORE TS on Sandtrap, Wednesday February 14, 2024 15:21:28",
+          "0x00090000014CBF3B", 0x65CCDA88, "", { { 5, "Stehfyn" } } },
+        { "theater/asq_sidewin_F631A42E.temp", mccinfo::game_hint::HALO3, "Fat Kid 8 Level",
+          "Fat Kid 8 Level on 5 LEVELS CREAM, Thursday February 15, 2024 17:03:15",
+          "0x00090000014CBF3B", 0x65CE43D3, "",
+          {
+            { 0, "ShamedSalmon" }, { 2, "Utahn" }, { 3, "terminalsnow" }, { 4, "NeoJynn" },
+            { 5, "Locky qubit" }, { 6, "Virul4ntKman" }, { 7, "JCPenny2121" },
+            { 8, "DustierCastle5" }, { 9, "farethdow19" }, { 10, "KhakiMule10597" },
+            { 11, "StephNuggz8444" }, { 12, "INs0mNIac02" }, { 13, "a PHD in Halo 3" },
+            { 14, "PAODEQUEIJO6816" }, { 15, "BIG10football99" }
+          } },
+        { "theater/asq_snowbou_3887A139_65CD4AB7.mov", mccinfo::game_hint::HALO3,
+          "2V2 HARDCORE TS", "2V2 HARDCORE TS on Snowbound, Wednesday February 14, 2024 15:20:03",
+          "0x00090000014CBF3B", 0x65CCDA30, "", { { 6, "Stehfyn" } } },
+        { "theater/asq_zanziba_025B3045_65CD3BE0.mov", mccinfo::game_hint::HALO3,
+          "2V2 HARDCORE TS",
+          "2V2 HARDCORE TS on Last Resort, Wednesday February 14, 2024 14:16:41",
+          "0x00090000014CBF3B", 0x65CCCB5E, "", { { 3, "Stehfyn" } } },
+    };
+    return films;
+}
+
+static int64_t UTCSeconds(const theater_file_data &file_data) {
+    using namespace std::chrono;
+    if (file_data.utc_timestamp_ == 0) {
+        return 0;
+    }
+    return time_point_cast<seconds>(file_clock::to_sys(file_data.UTCTimestamp()))
+        .time_since_epoch()
+        .count();
+}
+
+static void CheckFilm(const expected_film &film, const std::optional<theater_file_data> &file_data,
+                      const std::string &how) {
+    std::string what = std::string(film.path_) + " (" + how + ")";
+    Check(file_data.has_value(), what + " read");
+    if (!file_data.has_value()) {
+        return;
+    }
+    Check(file_data->gametype_.view() == film.gametype_, what + " gametype");
+    Check(file_data->desc_.view() == film.desc_, what + " description");
+    Check(file_data->author_xuid_.view() == film.xuid_, what + " xuid");
+    Check(UTCSeconds(file_data.value()) == film.utc_seconds_, what + " timestamp");
+    if (!film.autosave_) {
+        Check(file_data->author_.view() == film.author_, what + " author");
+        Check(std::equal(file_data->player_set_.begin(), file_data->player_set_.end(),
+                         film.players_.begin(), film.players_.end(),
+                         [](const player_info &player, const auto &expected) {
+                             return (player.team_ == expected.first) &&
+                                    (player.name_.view() == expected.second);
+                         }),
+              what + " players");
+    }
+}
+
+// Reads with the title's own layout, skipping the header classifier
+static std::optional<theater_file_data> ReadTitle(mccinfo::game_hint title,
+                                                  const std::filesystem::path &theater_file,
+                                                  const clock_context &clock) {
+    switch (title) {
+    case mccinfo::game_hint::HALO3:
+        return halo3_theater_file_reader::Read(theater_file, FIELD_ALL, clock);
+    case mccinfo::game_hint::HALOREACH:
+        return haloreach_theater_file_reader::Read(theater_file, FIELD_ALL, clock);
+    case mccinfo::game_hint::HALO4:
+        return halo4_theater_file_reader::Read(theater_file, FIELD_ALL, clock);
+    case mccinfo::game_hint::HALO2A:
+        return halo2a_theater_file_reader::Read(theater_file, FIELD_ALL, clock);
+    default:
+        return std::nullopt;
+    }
+}
+
+static void TestTheaterFiles(const std::filesystem::path &root) {
+    static const clock_context utc{};
+
+    for (const auto &film : ExpectedFilms()) {
+        auto path = root / film.path_;
+        CheckFilm(film, ReadAnyTheaterFile(path, FIELD_ALL, utc), "file");
+        CheckFilm(film, ReadTitle(film.title_, path, utc), "layout");
+        if (film.title_ == mccinfo::game_hint::HALO3) {
+            // ODST films share the Halo 3 layout
+            CheckFilm(film, halo3odst_theater_file_reader::Read(path, FIELD_ALL, utc), "odst");
+        }
+
+        auto contents = ReadWholeFile(path);
+        auto bytes = std::as_bytes(std::span(contents.data(), contents.size()));
+        CheckFilm(film, ReadAnyTheaterFile(path, buffer_source(bytes), FIELD_ALL, utc), "buffer");
+
+        mapped_source mapped;
+        Check(mapped.Open(path), std::string(film.path_) + " map");
+        CheckFilm(film, ReadAnyTheaterFile(path, mapped, FIELD_ALL, utc), "mapped");
+
+        // odd chunk sizes put every field across a chunk boundary at least once
+        std::vector<std::span<const std::byte>> chunks;
+        for (size_t offset = 0; offset < bytes.size(); offset += 0x3FF) {
+            chunks.push_back(bytes.subspan(offset, std::min<size_t>(0x3FF, bytes.size() - offset)));
+        }
+        CheckFilm(film, ReadAnyTheaterFile(path, chunked_source(std::move(chunks)), FIELD_ALL, utc),
+                  "chunks");
+
+        // a narrow read decodes only what it asked for
+        auto header = ReadAnyTheaterFile(path, FIELD_GAMETYPE | FIELD_UTC_TIMESTAMP, utc);
+        Check(header.has_value() && (header->gametype_.view() == film.gametype_) &&
+                  (UTCSeconds(header.value()) == film.utc_seconds_) && header->desc_.empty() &&
+                  header->author_xuid_.empty() && header->player_set_.empty(),
+              std::string(film.path_) + " narrow read");
+
+        // the author only joins the players when both are asked for
+        auto players = ReadAnyTheaterFile(path, FIELD_PLAYER_SET, utc);
+        size_t authors = film.author_.empty() ? 0 : 1;
+        Check(film.autosave_ ||
+                  (players.has_value() && (players->player_set_.size() + authors ==
+                                           film.players_.size()) &&
+                   std::none_of(players->player_set_.begin(), players->player_set_.end(),
+                                [](const player_info &player) { return player.team_ < 0; })),
+              std::string(film.path_) + " players without author");
+    }
+
+    // Halo 4 campaign films are named by their path; Halo 2A has no such rule
+    auto halo4 = ReadWholeFile(root / "theater" / "asq_mglo-1_ca_blood__EF1D6BDB_65CD5EA3.mov");
+    auto halo4_bytes = std::as_bytes(std::span(halo4.data(), halo4.size()));
+    auto campaign = halo4_theater_file_reader::Read("campaign/asq_m10.mov", halo4_bytes);
+    Check(campaign.has_value() && (campaign->gametype_.view() == "Campaign"), "halo4 campaign");
+    auto not_campaign = halo2a_theater_file_reader::Read("campaign/asq_m10.mov", halo4_bytes);
+    Check(not_campaign.has_value() && (not_campaign->gametype_.view() == "Infinity Slayer"),
+          "halo2a ignores the path");
+
+    // fields past the end of a short region are left empty
+    auto reach = ReadWholeFile(root / "asq_mglo-7_forge_hal_8CBF3A80_65D2F931.film");
+    auto header = haloreach_theater_file_reader::Read(
+        "short.film", std::as_bytes(std::span(reach.data(), 0x1C0)), FIELD_ALL, utc);
+    Check(header.has_value() && (header->gametype_.view() == "Kill Zeus") &&
+              header->desc_.empty() && (header->utc_timestamp_ == 0) &&
+              (header->author_.view() == "Stehfyn") && (header->player_set_.size() == 1),
+          "short region");
+
+    Check(!ReadAnyTheaterFile(root / "discrep" / "mpcarnagereport1_3385_0_0.xml"),
+          "not a theater file");
+    Check(!ReadAnyTheaterFile(root / "missing.film"), "missing theater file");
+}
+
+static void TestTheaterFileClassifier(const std::filesystem::path &root) {
+    auto header_of = [](const std::filesystem::path &path) {
+        std::vector<std::byte> header(theater_file_signature_size);
+        std::ifstream ifs(path, std::ios::binary);
+        ifs.read(reinterpret_cast<char *>(header.data()),
+                 static_cast<std::streamsize>(header.size()));
+        header.resize(static_cast<size_t>(ifs.gcount()));
+        return header;
+    };
+
+    for (const auto &film : ExpectedFilms()) {
+        auto signature = ClassifyTheaterFile(header_of(root / film.path_));
+        uint16_t version = (film.title_ == mccinfo::game_hint::HALO3) ? 0x0009 : 0x000A;
+        Check(signature.has_value() && (signature->title_ == film.title_) &&
+                  (signature->chdr_version_ == version),
+              std::string(film.path_) + " classified");
+    }
+
+    // every file in the corpus is either a film above or not a film at all
+    size_t films = 0;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(root)) {
+        if (entry.is_regular_file() && ClassifyTheaterFile(header_of(entry.path()))) {
+            ++films;
+        }
+    }
+    Check(films == ExpectedFilms().size(), "corpus films classified");
+
+    // a Halo 2A film with a blank build name, as autosaves have, can only be told as Halo 4
+    auto header = header_of(root / "theater" / "asq_mglo-1_ca_lockou_1D8C84F5_65CD4FD6.mov");
+    std::fill(header.begin() + 0x0E, header.begin() + 0x2E, std::byte{0});
+    auto blank = ClassifyTheaterFile(header);
+    Check(blank.has_value() && (blank->title_ == mccinfo::game_hint::HALO4), "blank build name");
+
+    header[0x39] = std::byte{0x0B};
+    Check(!ClassifyTheaterFile(header), "unknown chdr version");
+    header[0x30] = std::byte{'x'};
+    Check(!ClassifyTheaterFile(header), "missing chdr chunk");
+    header.pop_back();
+    Check(!ClassifyTheaterFile(header), "short header");
+}
+
+static void TestThreadPool() {
+    mccinfo::core::thread_pool pool(4);
+    Check(pool.size() == 4, "thread pool size");
+
+    // tasks submitted by tasks are waited for too
+    std::vector<std::atomic<int>> runs(256);
+    for (size_t i = 0; i < runs.size(); i += 2) {
+        pool.submit([&pool, &runs, i] {
+            ++runs[i];
+            pool.submit([&runs, i] { ++runs[i + 1]; });
+        });
+    }
+    pool.wait();
+    Check(std::all_of(runs.begin(), runs.end(), [](const auto &run) { return run == 1; }),
+          "thread pool runs every task once");
+
+    // the last task queues on the same worker as the first, which waits for it to run
+    mccinfo::core::thread_pool pair(2);
+    std::atomic<bool> stolen = false;
+    pair.submit([&stolen] {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!stolen && (std::chrono::steady_clock::now() < deadline)) {
+            std::this_thread::yield();
+        }
+    });
+    pair.submit([] {});
+    pair.submit([&stolen] { stolen = true; });
+    pair.wait();
+    Check(stolen, "thread pool runs queued tasks past a busy worker");
+}
+
+static void TestIndexer(const std::filesystem::path &root) {
+    auto theater = root / "theater";
+    auto paths = CollectTheaterFiles(theater);
+    Check(std::is_sorted(paths.begin(), paths.end()) && (paths.size() == 16),
+          "collect theater files");
+
+    uintmax_t bytes = 0;
+    for (const auto &path : paths) {
+        bytes += std::filesystem::file_size(path);
+    }
+
+    auto serial = IndexTheaterFiles(theater, std::nullopt, 1);
+    for (size_t thread_count : {size_t(1), size_t(4), size_t(0)}) {
+        auto index = IndexTheaterFiles(theater, std::nullopt, thread_count);
+        std::string what = "index with " + std::to_string(index.report_.threads_) + " workers";
+
+        Check((thread_count == 0) || (index.report_.threads_ == thread_count), what + " size");
+        Check((index.report_.files_ == paths.size()) && (index.report_.parsed_ == paths.size()) &&
+                  (index.report_.cached_ == 0) && (index.report_.bytes_ == bytes),
+              what + " report");
+        Check(index.files_.size() == paths.size(), what + " files");
+        for (size_t i = 0; i < std::min(index.files_.size(), paths.size()); ++i) {
+            const auto &entry = index.files_[i];
+            const auto &expected = serial.files_[i];
+            Check((entry.path_ == paths[i]) &&
+                      (entry.size_ == std::filesystem::file_size(paths[i])) &&
+                      entry.data_.has_value() && expected.data_.has_value() &&
+                      (entry.data_->desc_.view() == expected.data_->desc_.view()) &&
+                      std::equal(entry.data_->player_set_.begin(), entry.data_->player_set_.end(),
+                                 expected.data_->player_set_.begin(),
+                                 expected.data_->player_set_.end()),
+                  what + " " + paths[i].filename().string());
+        }
+    }
+
+    // a hint skips the classifier; the carnage report is not a theater file
+    auto discrep = IndexTheaterFiles(root / "discrep", mccinfo::game_hint::HALO3, 2);
+    Check((discrep.report_.files_ == 2) && (discrep.report_.parsed_ == 2) &&
+              (discrep.files_[0].data_->gametype_.view() == "Free For All"),
+          "index with a hint");
+
+    // the second run is served from the cache the first one filled
+    auto dir = std::filesystem::temp_directory_path() / "mccinfo_test_indexer";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    {
+        theater_parse_cache cache;
+        Check(cache.Open(dir / "theater.cache"), "index cache");
+        auto first = IndexTheaterFiles(theater, std::nullopt, 4, FIELD_ALL, &cache);
+        auto second = IndexTheaterFiles(theater, std::nullopt, 4, FIELD_ALL, &cache);
+        Check((first.report_.cached_ == 0) && (first.report_.parsed_ == paths.size()) &&
+                  (second.report_.cached_ == paths.size()) &&
+                  (second.report_.bytes_ == bytes) && (cache.Size() == paths.size()),
+              "index with a cache");
+
+        cache.Close();
+        auto closed = IndexTheaterFiles(theater, std::nullopt, 4, FIELD_ALL, &cache);
+        Check((closed.report_.cached_ == 0) && (closed.report_.parsed_ == paths.size()),
+              "index with a closed cache");
+    }
+    std::filesystem::remove_all(dir);
+}
+
+// Players in a but not in b
+static player_roster RosterDifference(const player_roster &a, const player_roster &b) {
+    player_roster difference;
+    for (const auto &player : a) {
+        if (!std::binary_search(b.begin(), b.end(), player)) {
+            difference.insert(player);
+        }
+    }
+    return difference;
+}
+
+static bool SameRoster(const player_roster &a, const player_roster &b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+static void TestLiveTheaterFile(const std::filesystem::path &root) {
+    static const clock_context utc{};
+
+    auto dir = std::filesystem::temp_directory_path() / "mccinfo_test_live_theater_file";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto path = dir / "asq_sidewin_F631A42E.temp";
+
+    halo3_live_theater_file_reader live(path, FIELD_ALL, utc);
+    Check(!live.Poll().has_value(), "live film missing");
+
+    // the game appends to the film as the match goes on
+    auto film = ReadWholeFile(root / "theater" / "asq_sidewin_F631A42E.temp");
+    auto film_bytes = std::as_bytes(std::span(film.data(), film.size()));
+    size_t written = 0;
+    theater_file_data last;
+    auto append = [&](size_t size) {
+        std::ofstream ofs(path, std::ios::binary | std::ios::app);
+        ofs.write(film.data() + written, static_cast<std::streamsize>(size - written));
+        written = size;
+    };
+    for (size_t size : {size_t(0x100), size_t(0x800), size_t(0x1000), size_t(0x2000)}) {
+        append(size);
+
+        auto expected =
+            halo3_theater_file_reader::Read(path, film_bytes.first(size), FIELD_ALL, utc);
+        auto delta = live.Poll();
+        std::string what = "live film at " + std::to_string(size) + " bytes";
+        if (!expected.has_value() || !delta.has_value()) {
+            Check(false, what + " poll");
+            continue;
+        }
+        Check(SameRoster(delta->joined_,
+                         RosterDifference(expected->player_set_, last.player_set_)) &&
+                  SameRoster(delta->left_,
+                             RosterDifference(last.player_set_, expected->player_set_)),
+              what + " roster delta");
+        Check((live.GetData().gametype_ == expected->gametype_) &&
+                  (live.GetData().desc_ == expected->desc_) &&
+                  (live.GetData().utc_timestamp_ == expected->utc_timestamp_) &&
+                  SameRoster(live.GetData().player_set_, expected->player_set_),
+              what + " data");
+        last = expected.value();
+    }
+    Check(live.GetData().player_set_.size() == 15, "live film complete roster");
+
+    // the rest of the film is past every field, so there is nothing to decode
+    append(film.size());
+    Check(!live.Poll().has_value(), "live film unchanged");
+
+    // a player slot rewritten in place is one player leaving and another joining
+    {
+        std::fstream fs(path, std::ios::binary | std::ios::in | std::ios::out);
+        fs.seekp(0x4B0);
+        fs.put('X');
+    }
+    auto renamed = live.Poll();
+    Check(renamed.has_value() && (renamed->changed_fields_ == FIELD_PLAYER_SET) &&
+              (renamed->left_.size() == 1) &&
+              (renamed->left_.begin()->name_.view() == "ShamedSalmon") &&
+              (renamed->joined_.size() == 1) &&
+              (renamed->joined_.begin()->name_.view() == "XhamedSalmon"),
+          "live film player renamed");
+
+    // a shorter file is another film saved over the name; every old player leaves
+    std::filesystem::copy_file(root / "discrep" / "asq_chill_10db95e8.temp", path,
+                               std::filesystem::copy_options::overwrite_existing);
+    auto replaced = live.Poll();
+    Check(replaced.has_value() && (replaced->changed_fields_ & FIELD_GAMETYPE) &&
+              (replaced->changed_fields_ & FIELD_DESC) && (replaced->left_.size() == 15) &&
+              (replaced->joined_.size() == 9) &&
+              (live.GetData().gametype_.view() == "Free For All"),
+          "live film replaced");
+
+    live.Reset();
+    auto reset = live.Poll();
+    Check(reset.has_value() && reset->left_.empty() && (reset->joined_.size() == 9),
+          "live film reset");
+
+    // a film that can't be read keeps what was decoded last
+    std::filesystem::remove(path);
+    Check(!live.Poll().has_value() && (live.GetData().player_set_.size() == 9),
+          "live film removed");
+    std::filesystem::create_directories(path);
+    Check(!live.Poll().has_value(), "live film is a directory");
+
+    std::filesystem::remove_all(dir);
+}
+
+static void TestCarnageReport(const std::filesystem::path &root) {
+    auto report = ReadCarnageReport(root / "discrep" / "mpcarnagereport1_3385_0_0.xml");
+    Check(report.has_value(), "carnage report read");
+    if (!report.has_value()) {
+        return;
+    }
+
+    const auto &header = report->header_;
+    Check((header.game_enum_ == 2) && !header.is_matchmaking_ && (header.party_size_ == 1) &&
+              header.last_match_incomplete_ && !header.is_teams_enabled_,
+          "carnage report header flags");
+    Check((header.gametype_name_ == "Free For All") &&
+              (header.game_unique_id_ == "fc38d84d-ffb5-6c07-1a07-ee9c07c51d8f"),
+          "carnage report header text");
+
+    Check(report->PlayerCount() == 13, "carnage report player count");
+    Check((report->xbox_user_id_[0] == 0x000901F01D712418) &&
+              (report->Text(carnage_player_text::GAMERTAG, 0) == "CheckMate240hz") &&
+              (report->Text(carnage_player_text::CLANTAG, 0) == "MLG") &&
+              (report->Stat(carnage_player_stat::KILLS, 0) == 22) &&
+              (report->Stat(carnage_player_stat::TEAM_ID, 0) == -1) &&
+              (report->Stat(carnage_player_stat::MOST_USED_WEAPON_COUNT, 0) == 11),
+          "carnage report player attributes");
+    Check((report->MedalCount(0, 8) == 6) && (report->MedalCount(0, 0) == 0) &&
+              (report->MedalIds(0).size() == 14) && report->CustomStatNames(0).empty(),
+          "carnage report player medals");
+
+    bool totals_match = true;
+    for (size_t i = 0; i < report->PlayerCount(); ++i) {
+        int32_t total = 0;
+        for (int32_t count : report->MedalCounts(i)) {
+            total += count;
+        }
+        totals_match &= (total == report->Stat(carnage_player_stat::TOTAL_MEDAL_COUNT, i));
+    }
+    Check(totals_match, "carnage report medals add up to mTotalMedalCount");
+
+    // a copied report owns its text, and the views into it survive moving the report
+    auto loaded = LoadCarnageReport(root / "discrep" / "mpcarnagereport1_3385_0_0.xml");
+    auto moved = loaded.has_value() ? std::move(loaded.value()) : carnage_report();
+    Check((moved.PlayerCount() == 13) &&
+              (moved.Text(carnage_player_text::GAMERTAG, 0) == "CheckMate240hz") &&
+              (moved.header_.gametype_name_ == "Free For All"),
+          "carnage report load");
+
+    auto xml = ReadWholeFile(root / "quittedplayers" / "mpcarnagereport1_3385_0_0.xml");
+    carnage_report parsed;
+    Check(ParseCarnageReport(xml, parsed) && (parsed.PlayerCount() == 16) &&
+              (UnescapeXML(parsed.header_.gametype_name_) == "HIDE N' SEEK"),
+          "carnage report parse from a buffer");
+    Check(!ParseCarnageReport(std::string_view(xml).substr(0, xml.size() / 2), parsed),
+          "carnage report truncated");
+    Check(UnescapeXML("a&lt;&#x42;&#67;&amp;&unknown;") == "a<BC&&unknown;", "unescape xml");
+
+    // off the fast path: a '>' inside a value, then spaces around '=' and single quotes
+    std::string_view odd = "<R><Players><Player mGamertagText=\"a>b\" mKills=\"3\"/>"
+                           "<Player mKills = '4' ClantagText='c'></Player></Players></R>";
+    Check(ParseCarnageReport(odd, parsed) && (parsed.PlayerCount() == 2) &&
+              (parsed.Text(carnage_player_text::GAMERTAG, 0) == "a>b") &&
+              (parsed.Stat(carnage_player_stat::KILLS, 0) == 3) &&
+              (parsed.Stat(carnage_player_stat::KILLS, 1) == 4) &&
+              (parsed.Text(carnage_player_text::CLANTAG, 1) == "c"),
+          "carnage report attribute forms");
+    Check(report->malformed_values_ == 0, "carnage report numbers all parse");
+
+    // numbers with trailing junk, out of range or missing keep their defaults and are counted
+    std::string_view bad = "<R mGameEnum=\"\" mPartySize=\"2\"><Players>"
+                           "<Player mXboxUserId=\"0xZZ\" mKills=\"12abc\" mTeamId=\"99999999999\""
+                           " Score=\"7\"><Medal mId=\"x\" mCount=\"3\"/></Player></Players></R>";
+    Check(ParseCarnageReport(bad, parsed) && (parsed.PlayerCount() == 1) &&
+              (parsed.malformed_values_ == 5) && (parsed.header_.game_enum_ == 0) &&
+              (parsed.header_.party_size_ == 2) && (parsed.xbox_user_id_[0] == 0) &&
+              (parsed.Stat(carnage_player_stat::KILLS, 0) == 0) &&
+              (parsed.Stat(carnage_player_stat::TEAM_ID, 0) == 0) &&
+              (parsed.Stat(carnage_player_stat::SCORE, 0) == 7) &&
+              (parsed.MedalCount(0, 0) == 3),
+          "carnage report malformed numbers");
+    Check(ParseCarnageReport(odd, parsed) && (parsed.malformed_values_ == 0),
+          "carnage report clears malformed count");
+
+    // the fast path reads mKills, then gives up at the spaced '='; the generic reader reads the
+    // tag again from the start without counting mKills a second time
+    std::string_view fallback = "<R><Players><Player mKills=\"1x\" Score = \"5\"/></Players></R>";
+    Check(ParseCarnageReport(fallback, parsed) && (parsed.PlayerCount() == 1) &&
+              (parsed.malformed_values_ == 1) &&
+              (parsed.Stat(carnage_player_stat::KILLS, 0) == 0) &&
+              (parsed.Stat(carnage_player_stat::SCORE, 0) == 5),
+          "carnage report counts a malformed value once after falling back");
+    Check(UnescapeXML("&#x;&#12z;&#x41;") == "&#x;&#12z;A", "unescape bad character references");
+}
+
+static void BenchmarkCarnageReport(const std::filesystem::path &root) {
+    auto xml = ReadWholeFile(root / "discrep" / "mpcarnagereport1_3385_0_0.xml");
+
+    // players alone, to see the cost of a <Player> start tag apart from its medals
+    constexpr size_t player_count = 1000;
+    auto tag_begin = xml.find("<Player ");
+    auto tag = xml.substr(tag_begin, xml.find('>', tag_begin) + 1 - tag_begin);
+    std::string players_xml = "<MultiplayerCarnageReport><Players>";
+    for (size_t i = 0; i < player_count; ++i) {
+        players_xml += tag + "</Player>";
+    }
+    players_xml += "</Players></MultiplayerCarnageReport>";
+
+    constexpr size_t iterations = 1000;
+    carnage_report report;
+    size_t players = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        ParseCarnageReport(xml, report);
+        players += report.PlayerCount();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double mb = static_cast<double>(xml.size() * iterations) / (1024.0 * 1024.0);
+    std::cout << std::left << std::setw(align) << "parse carnage reports: "
+              << static_cast<size_t>(iterations / elapsed.count()) << " reports/s, " << std::fixed
+              << std::setprecision(1) << (mb / elapsed.count()) << " MB/s"
+              << " (" << players << " players)" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < (iterations / 10); ++i) {
+        ParseCarnageReport(players_xml, report);
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+
+    double attributes = static_cast<double>(std::count(tag.begin(), tag.end(), '='));
+    double ns_per_player = (elapsed.count() * 1e9) / ((iterations / 10) * player_count);
+    std::cout << std::left << std::setw(align) << "parse carnage players: " << std::fixed
+              << std::setprecision(1) << ns_per_player << " ns/player, "
+              << (ns_per_player / attributes) << " ns/attribute" << std::endl;
+}
+
+static void BenchmarkStatsStore() {
+    auto dir = std::filesystem::temp_directory_path() / "mccinfo_bench_stats_store";
+    std::filesystem::remove_all(dir);
+
+    // 10k matches of 200 players, spread over 100 gamertags and 10 maps
+    constexpr size_t matches = 10000;
+    constexpr size_t players = 200;
+    carnage_report report;
+    for (size_t c = 0; c < static_cast<size_t>(carnage_player_stat::COUNT); ++c) {
+        report.stats_[c].resize(players);
+    }
+    report.xbox_user_id_.resize(players);
+    report.custom_stats_begin_.resize(players);
+    report.medal_ids_.resize(3 * players);
+    report.medal_counts_.resize(3 * players);
+    for (size_t p = 0; p < players; ++p) {
+        report.medals_begin_.push_back(static_cast<uint32_t>(3 * p));
+    }
+    std::vector<std::string> gamertags;
+    for (size_t i = 0; i < 100; ++i) {
+        gamertags.push_back("Player " + std::to_string(i));
+    }
+    for (auto &column : report.texts_) {
+        column.resize(players);
+    }
+
+    stats_store store;
+    store.Open(dir);
+    for (size_t m = 0; m < matches; ++m) {
+        for (size_t p = 0; p < players; ++p) {
+            report.stats_[static_cast<size_t>(carnage_player_stat::KILLS)][p] =
+                static_cast<int32_t>((m + p) % 31);
+            report.stats_[static_cast<size_t>(carnage_player_stat::DEATHS)][p] =
+                static_cast<int32_t>((m * p) % 17);
+            report.texts_[static_cast<size_t>(carnage_player_text::GAMERTAG)][p] =
+                gamertags[(m + p) % gamertags.size()];
+            for (size_t i = 0; i < 3; ++i) {
+                report.medal_ids_[(3 * p) + i] = static_cast<uint16_t>(((m + p) % 100) + (i * 120));
+                report.medal_counts_[(3 * p) + i] = static_cast<int32_t>(1 + ((m + i) % 3));
+            }
+        }
+        store.Append(report, "Map " + std::to_string(m % 10));
+    }
+    auto view = store.View();
+
+    std::array keys = {stats_column::GAMERTAG, stats_column::MAP};
+    std::array values = {StatsColumn(carnage_player_stat::KILLS),
+                         StatsColumn(carnage_player_stat::DEATHS)};
+    std::array kills_filter = {stats_range{StatsColumn(carnage_player_stat::KILLS), 10, 20}};
+
+    int64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    checksum += view.Sum(StatsColumn(carnage_player_stat::KILLS));
+    std::chrono::duration<double> sum = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    checksum += view.Sum(StatsColumn(carnage_player_stat::DEATHS), kills_filter);
+    std::chrono::duration<double> filtered = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    checksum += static_cast<int64_t>(view.GroupBy(keys, values).size());
+    std::chrono::duration<double> grouped = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    checksum += view.SumMedal(130);
+    std::chrono::duration<double> medal = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    checksum += view.SumMedal(130, kills_filter);
+    std::chrono::duration<double> filtered_medal = std::chrono::steady_clock::now() - start;
+
+    size_t medal_bytes = 0;
+    for (size_t match = 0; match < view.MatchCount(); ++match) {
+        medal_bytes += view.Medals(match).Bytes().size();
+    }
+
+    std::cout << std::left << std::setw(align) << "stats store rows: " << view.RowCount()
+              << std::fixed << std::setprecision(1) << ", sum " << (sum.count() * 1e3)
+              << " ms, filtered sum " << (filtered.count() * 1e3) << " ms, group by "
+              << (grouped.count() * 1e3) << " ms (" << checksum << ")" << std::endl;
+    std::cout << std::left << std::setw(align) << "stats store medals: " << std::fixed
+              << std::setprecision(1) << "sum " << (medal.count() * 1e3) << " ms, filtered sum "
+              << (filtered_medal.count() * 1e3) << " ms, "
+              << (static_cast<double>(medal_bytes) / static_cast<double>(view.RowCount()))
+              << " bytes/player" << std::endl;
+
+    store.Close();
+    std::filesystem::remove_all(dir);
+}
+
+static void BenchmarkTranscoder() {
+    // a roster's worth of gamertag sized ascii names, as found in player tables
+    std::vector<std::byte> names;
+    for (int i = 0; i < 16; ++i) {
+        std::u16string name = u"Player Number " + std::u16string(1, char16_t(u'A' + i));
+        name.resize(16, u'\0');
+        auto bytes = ToUTF16LE(name);
+        names.insert(names.end(), bytes.begin(), bytes.end());
+    }
+
+    constexpr size_t iterations = 200000;
+    char buffer[UTF8CapacityFor(32)];
+    size_t written = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        for (size_t offset = 0; offset < names.size(); offset += 32) {
+            written += TranscodeUTF16LEToUTF8(std::span(names).subspan(offset, 32), buffer).size();
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double mb = static_cast<double>(names.size() * iterations) / (1024.0 * 1024.0);
+    std::cout << std::left << std::setw(align) << "transcode names: "
+              << static_cast<size_t>((iterations * 16) / elapsed.count()) << " names/s, "
+              << std::fixed << std::setprecision(1) << (mb / elapsed.count()) << " MB/s"
+              << " (" << written << " bytes)" << std::endl;
+}
+
+static void BenchmarkPathClassifier() {
+    using namespace mccinfo::fsm;
+    const auto &paths = ClassifierPaths();
+    const auto &classifier = mcc_path_classifier();
+
+    constexpr size_t iterations = 100000;
+    path_mask masks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        for (const auto &path : paths) {
+            masks |= classifier.classify(std::wstring_view(path));
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::left << std::setw(align) << "classify paths: " << std::fixed
+              << std::setprecision(1) << (elapsed.count() / (iterations * paths.size()))
+              << " ns/path, " << path_patterns.size() << " patterns, "
+              << classifier.state_count() << " states (" << std::popcount(masks) << " found)"
+              << std::endl;
+}
+
+int main(int argc, char **argv) {
+    std::filesystem::path corpus = (argc > 1) ? argv[1] : "../test_files";
+
+    TestTranscoderCases();
+    TestTranscoderCorpus(corpus);
+    TestPlayerRoster();
+    TestTimestamps();
+    TestHash();
+    TestParseCache();
+    TestByteSources();
+    TestTheaterFiles(corpus);
+    TestTheaterFileClassifier(corpus);
+    TestThreadPool();
+    TestIndexer(corpus);
+    TestLiveTheaterFile(corpus);
+    TestFilmIndex(corpus);
+    TestCarnageReport(corpus);
+    TestCarnageParseCache(corpus);
+    TestMedalVector(corpus);
+    TestStatsStore(corpus);
+    TestPathClassifier();
+    BenchmarkTranscoder();
+    BenchmarkCarnageReport(corpus);
+    BenchmarkStatsStore();
+    BenchmarkPathClassifier();
+
+    std::cout << (failures ? "FAILED" : "PASSED") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,503 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mccinfo/fsm/diagnostics.hpp"
+#include "mccinfo/fsm/edges/edges.hpp"
+#include "mccinfo/fsm/normalized_event.hpp"
+#include "mccinfo/fsm/predicates.hpp"
+#include "mccinfo/fsm/states/state_context.hpp"
+#include "mccinfo/fsm/theater_files.hpp"
+
+using namespace mccinfo::fsm;
+
+// Counts global operator new calls
+static std::atomic<uint64_t> allocations{0};
+
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p) noexcept {
+    std::free(p);
+}
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void *p, size_t) noexcept {
+    std::free(p);
+}
+
+constexpr uint8_t align = 28;
+
+static int failures = 0;
+
+static void Check(bool condition, const std::string &what) {
+    if (!condition) {
+        ++failures;
+        std::cout << "FAILED: " << what << std::endl;
+    }
+}
+
+// Events as the provider would normalize them
+static normalized_event ProcessEvent(predicates::opcodes::process opcode, std::string_view image,
+                                     uint32_t process_id) {
+    normalized_event event;
+    event.source_ = event_source::process;
+    event.opcode_ = static_cast<uint8_t>(opcode);
+    event.pid_ = 4;
+    event.process_id_ = process_id;
+    event.image_name_ = event_paths().find(image);
+    event.image_name_mask_ = event_paths().mask(event.image_name_);
+    return event;
+}
+
+static normalized_event FileCreateEvent(std::wstring_view open_path, uint32_t pid = 1000) {
+    normalized_event event;
+    event.source_ = event_source::file_io;
+    event.opcode_ = static_cast<uint8_t>(predicates::opcodes::fio::file_create);
+    event.pid_ = pid;
+    event.path_ = event_paths().intern_matching(open_path);
+    event.path_mask_ = event_paths().mask(event.path_);
+    return event;
+}
+
+static normalized_event FileReadEvent(uint32_t io_size, uint32_t pid = 1000) {
+    normalized_event event;
+    event.source_ = event_source::file_io;
+    event.opcode_ = static_cast<uint8_t>(predicates::opcodes::fio::file_read);
+    event.pid_ = pid;
+    event.io_size_ = io_size;
+    return event;
+}
+
+static const std::wstring temporary = L"\\Device\\HarddiskVolume3\\Users\\someone\\AppData\\"
+                                      L"LocalLow\\MCC\\Temporary\\";
+
+static void TestPathTable() {
+    path_table paths;
+    auto a = paths.intern(std::wstring_view(L"C:\\maps\\Shared.map"));
+    auto b = paths.intern(std::string_view("C:\\maps\\Shared.map"));
+    Check((a != no_path) && (a == b) && (paths.size() == 1), "path table interns once");
+    Check(paths.path(a) == L"C:\\maps\\Shared.map", "path table path");
+    Check(paths.mask(a) == to_mask({path_pattern::map_file, path_pattern::shared_map_file,
+                                    path_pattern::contains_shared}),
+          "path table mask");
+
+    Check(paths.intern_matching(L"C:\\Windows\\System32\\kernel32.dll") == no_path,
+          "path table skips unmatched paths");
+    Check((paths.size() == 1) && (paths.find(L"C:\\Windows\\System32\\kernel32.dll") == no_path),
+          "path table unmatched paths not stored");
+    Check((paths.path(no_path).empty()) && (paths.mask(no_path) == 0), "path table no path");
+    Check((paths.find(std::string_view("C:\\maps\\Shared.map")) == a) &&
+              (paths.find(std::string_view("notepad.exe")) == no_path) && (paths.size() == 1),
+          "path table finds narrow names without adding them");
+
+    // ids survive the table growing
+    std::vector<path_id> ids;
+    for (int i = 0; i < 1000; ++i) {
+        ids.push_back(paths.intern(L"f" + std::to_wstring(i) + L".map"));
+    }
+    bool stable = true;
+    for (int i = 0; i < 1000; ++i) {
+        stable &= (paths.find(L"f" + std::to_wstring(i) + L".map") == ids[i]) &&
+                  (paths.path(ids[i]) == (L"f" + std::to_wstring(i) + L".map"));
+    }
+    Check(stable, "path table ids stable");
+}
+
+static void TestPredicates() {
+    using predicates::opcodes::process;
+    namespace events = predicates::events;
+
+    auto launcher = ProcessEvent(process::start, mccinfo::constants::launcher_exe, 1234);
+    auto mcc = ProcessEvent(process::dc_start, mccinfo::constants::mcc_steam_exe, 1235);
+    size_t interned = event_paths().size();
+    auto other = ProcessEvent(process::start, "notepad.exe", 1236);
+    Check((other.image_name_ == no_path) && (event_paths().size() == interned),
+          "process events don't intern unknown images");
+    Check(events::launcher_started(launcher) && !events::launcher_terminated(launcher) &&
+              !events::launcher_started(other),
+          "launcher started");
+    Check(events::mcc_found(mcc) && !events::mcc_started(mcc) && !events::mcc_found(other),
+          "mcc found");
+    Check(predicates::filters::process_targets(mcc) &&
+              !predicates::filters::process_targets(other),
+          "process filter");
+
+    auto map = FileCreateEvent(L"D:\\MCC\\halo3\\maps\\guardian.map");
+    auto shared = FileCreateEvent(L"D:\\MCC\\halo3\\maps\\shared.map");
+    Check(events::non_generic_map_file_created(map) &&
+              !events::non_generic_map_file_created(shared),
+          "non generic map created");
+
+    auto report = FileCreateEvent(temporary + L"mpcarnagereport1_3385_0_0.xml.tmp");
+    auto survival = FileCreateEvent(temporary + L"survivalcarnagereport1_3385_0_0.xml.tmp");
+    Check(events::temp_carnage_report_created(report) &&
+              events::mp_temp_carnage_report_created(report) &&
+              !events::mp_temp_carnage_report_created(survival) &&
+              events::survival_temp_carnage_report_created(survival),
+          "carnage report created");
+
+    auto theater = FileCreateEvent(temporary + L"UserContent\\Halo3\\Movie\\asq_guardian.mov");
+    Check(events::theater_file_created(theater) && events::halo3_theater_file_created(theater) &&
+              !events::halo4_theater_file_created(theater),
+          "theater file created");
+
+    auto read = FileReadEvent(static_cast<uint32_t>(mccinfo::constants::fsb_fio_read_size));
+    Check(events::sound_file_read(read) && predicates::filters::file_io_targets(read) &&
+              !events::sound_file_read(FileReadEvent(1)),
+          "sound file read");
+
+    auto unrelated = FileCreateEvent(L"C:\\Windows\\Temp\\setup.log");
+    Check(!predicates::filters::file_io_targets(unrelated) &&
+              predicates::filters::file_io_targets(map),
+          "file io filter");
+}
+
+static void TestTheaterFileIndexing() {
+    namespace events = predicates::events;
+    const std::filesystem::path temp_root = L"C:\\Users\\someone\\AppData\\LocalLow\\MCC";
+
+    // Halo 3 and ODST save films as .film; their creates must reach the index like .mov ones
+    auto film = FileCreateEvent(temporary +
+                                L"UserContent\\Halo3\\Movie\\asq_chill_10DB95E8_65D005D4.film");
+    Check(predicates::filters::file_io_targets(film) && events::theater_file_created(film) &&
+              events::halo3_theater_file_created(film),
+          "film file created");
+
+    mccinfo::file_readers::film_index index;
+    auto indexed = index_theater_file(index, temp_root, film);
+    auto match = index.FindMatchingFilm(temp_root / "Temporary" / "Halo3" / "autosave" /
+                                        "asq_chill_10db95e8.temp");
+    Check(indexed.has_value() && match.has_value() && (match == indexed) &&
+              match->string().ends_with("asq_chill_10DB95E8_65D005D4.film"),
+          "film file indexed from its create event");
+
+    auto mov = FileCreateEvent(temporary + L"UserContent\\HaloReach\\Movie\\"
+                                           L"asq_sword_0FD4C0CF_00000001.mov");
+    Check(index_theater_file(index, temp_root, mov).has_value() && (index.Size() == 2),
+          "mov file indexed from its create event");
+    auto map = FileCreateEvent(L"D:\\MCC\\halo3\\maps\\guardian.map");
+    Check(!index_theater_file(index, temp_root, map).has_value() && (index.Size() == 2),
+          "other creates are not indexed");
+
+    auto rebased = rebase_temporary_path(
+        temp_root, L"\\Device\\HarddiskVolume3\\Users\\someone\\AppData\\LocalLow\\mcc\\"
+                   L"TEMPORARY\\UserContent\\Halo3\\Movie\\a.film");
+    Check((rebased == temp_root / "Temporary" / L"UserContent\\Halo3\\Movie\\a.film") &&
+              !rebase_temporary_path(temp_root, L"\\Device\\HarddiskVolume3\\MCC\\a.film"),
+          "rebase temporary path in any case");
+}
+
+static void TestSequences() {
+    namespace events = predicates::events;
+    auto h3_autosave = FileCreateEvent(temporary + L"Halo3\\autosave\\00000000.temp");
+    auto h3_film = FileCreateEvent(temporary + L"UserContent\\Halo3\\Movie\\asq_guardian.mov");
+    auto noise = FileCreateEvent(L"D:\\MCC\\halo3\\fmod\\pc\\sfx.fsb");
+
+    auto weak = edges::make_sequence(&events::halo3_autosave_temp_file_created,
+                                     &events::halo3_theater_file_created,
+                                     &events::halo3_autosave_temp_file_created);
+    weak.try_advance(h3_autosave);
+    weak.try_advance(noise);
+    weak.try_advance(h3_film);
+    Check(!weak.is_complete(), "weak sequence incomplete");
+    weak.try_advance(h3_autosave);
+    Check(weak.is_complete() && !weak.try_advance(h3_autosave), "weak sequence complete");
+    weak.reset();
+    Check(!weak.is_complete(), "sequence reset");
+
+    auto strict = edges::make_sequence_with_policy(edges::details::sequence_policy::strict,
+                                                   &events::halo3_autosave_temp_file_created,
+                                                   &events::halo3_theater_file_created);
+    strict.try_advance(h3_autosave);
+    strict.try_advance(noise);
+    strict.try_advance(h3_film);
+    Check(!strict.is_complete(), "strict sequence restarts");
+    strict.try_advance(h3_autosave);
+    strict.try_advance(h3_film);
+    Check(strict.is_complete(), "strict sequence complete");
+}
+
+static auto match_loading =
+    edges::make_sequence(&predicates::events::loadingscreen_gfx_file_created);
+static auto mcc_lost = edges::make_sequence(&predicates::events::mcc_terminated);
+
+static void TestEdges() {
+    auto container = edges::make_edges(std::make_tuple(&match_loading, events::load_start{}),
+                                       std::make_tuple(&mcc_lost, events::mcc_terminate{}));
+    container.reset();
+
+    diagnostics::ring ring;
+    ring.push_event({});
+    diagnostics::recorder rec(ring, 0);
+    auto loading = FileCreateEvent(L"D:\\MCC\\data\\ui\\loadingscreen.gfx");
+    auto unrelated = FileCreateEvent(L"D:\\MCC\\halo3\\maps\\guardian.map");
+    Check(!container.handle_trace_event(rec, unrelated).has_value(), "edges no event");
+
+    auto event = container.handle_trace_event(rec, loading);
+    Check(event.has_value() && std::holds_alternative<events::load_start>(event.value()),
+          "edges load start");
+
+    container.reset();
+    auto lost = ProcessEvent(predicates::opcodes::process::end,
+                             mccinfo::constants::mcc_msstore_exe, 1235);
+    event = container.handle_trace_event(rec, lost);
+    Check(event.has_value() && std::holds_alternative<events::mcc_terminate>(event.value()),
+          "edges mcc terminate");
+}
+
+// Two states in the shape of the user machine's in_menus and loading_in
+inline constinit auto test_match_loading =
+    edges::make_sequence(&predicates::events::loadingscreen_gfx_file_created);
+inline constinit auto test_match_started =
+    edges::make_sequence(&predicates::events::match_temp_file_created,
+                         &predicates::events::sound_file_read);
+inline constinit auto test_mcc_lost = edges::make_sequence(&predicates::events::mcc_terminated);
+
+struct test_menus {
+    static constexpr auto edges =
+        edges::make_edges(std::make_tuple(&test_match_loading, events::load_start{}),
+                          std::make_tuple(&test_mcc_lost, events::mcc_terminate{}));
+};
+
+struct test_loading {
+    static constexpr auto edges =
+        edges::make_edges(std::make_tuple(&test_match_started, events::match_start{}),
+                          std::make_tuple(&test_mcc_lost, events::mcc_terminate{}));
+};
+
+static void TestStateContext() {
+    using context = states::state_context<test_menus, test_loading>;
+    static_assert((context::index_of<test_menus> == 0) && (context::index_of<test_loading> == 1));
+
+    auto loading = FileCreateEvent(L"D:\\MCC\\data\\ui\\loadingscreen.gfx");
+    auto match_temp = FileCreateEvent(temporary + L"Halo3\\00000000.temp");
+    auto sound = FileReadEvent(static_cast<uint32_t>(mccinfo::constants::fsb_fio_read_size));
+    auto unrelated = FileCreateEvent(L"D:\\MCC\\halo3\\maps\\guardian.map");
+
+    // drives the two states the way the controller does, one event at a time
+    context sc;
+    diagnostics::ring ring;
+    bool in_menus = true;
+    size_t transitions = 0;
+    auto handle = [&](const normalized_event &event) {
+        ring.push_event(event);
+        diagnostics::recorder rec(ring, 0);
+        if (in_menus) {
+            sc.handle_trace_event<test_menus>(rec, event);
+        } else {
+            sc.handle_trace_event<test_loading>(rec, event);
+        }
+        while (auto evt = sc.pop_event_from_queue()) {
+            in_menus = std::holds_alternative<events::match_start>(evt.value());
+            transitions += 1;
+        }
+    };
+
+    const normalized_event *round[] = { &unrelated, &loading, &match_temp, &unrelated, &sound };
+    for (auto event : round) {
+        handle(*event);
+    }
+    Check((transitions == 2) && in_menus && (sc.event_queue_size() == 0),
+          "state context transitions");
+
+    // a state's edges start over when it is entered again
+    handle(loading);
+    handle(match_temp);
+    handle(loading);
+    handle(match_temp);
+    Check(!in_menus && (transitions == 3), "state context resets on entry");
+    handle(sound);
+
+    uint64_t allocs_start = allocations.load();
+    for (int i = 0; i < 10000; ++i) {
+        for (auto event : round) {
+            handle(*event);
+        }
+    }
+    uint64_t allocs = allocations.load() - allocs_start;
+    Check((allocs == 0) && (transitions == 4 + 20000),
+          "state context handles events without allocating");
+}
+
+// Stands in for the list of states boost::sml::sm finds in a transition table
+template <typename... _States>
+struct test_machine {
+    template <typename...>
+    struct list {};
+    using states = list<_States...>;
+};
+
+struct test_in_match {
+    static constexpr auto edges =
+        edges::make_edges(std::make_tuple(&test_mcc_lost, events::mcc_terminate{}));
+};
+
+struct test_sml_state {}; // sml's own states, e.g. its terminate state, have no edges
+
+static void TestStateCoverage() {
+    using context = states::state_context<test_menus, test_loading>;
+    static_assert(states::covers_machine_states<test_machine<test_menus, test_loading>, context>);
+    static_assert(states::covers_machine_states<
+                  test_machine<test_loading, test_sml_state, test_menus>, context>);
+    static_assert(!states::covers_machine_states<test_machine<test_menus>, context>);
+    static_assert(!states::covers_machine_states<
+                  test_machine<test_menus, test_loading, test_in_match>, context>);
+    static_assert(!states::covers_machine_states<
+                  test_machine<test_menus, test_loading>, states::state_context<test_menus>>);
+}
+
+static void TestStateDispatch() {
+    using context = states::state_context<test_menus, test_loading>;
+    static_assert((context::state_names[0] == "test_menus") &&
+                  (context::state_names[1] == "test_loading"));
+
+    auto loading = FileCreateEvent(L"D:\\MCC\\data\\ui\\loadingscreen.gfx");
+    auto match_temp = FileCreateEvent(temporary + L"Halo3\\00000000.temp");
+    auto sound = FileReadEvent(static_cast<uint32_t>(mccinfo::constants::fsb_fio_read_size));
+
+    // the current state picks the edges an event goes to
+    context sc;
+    diagnostics::ring ring;
+    ring.push_event({});
+    diagnostics::recorder rec(ring, 0);
+    Check(sc.current_state() == context::index_of<test_menus>, "dispatch starts in first state");
+    sc.handle_trace_event(rec, match_temp);
+    sc.handle_trace_event(rec, sound);
+    Check(sc.event_queue_size() == 0, "dispatch ignores other states' edges");
+    sc.handle_trace_event(rec, loading);
+    auto evt = sc.pop_event_from_queue();
+    Check(evt.has_value() && std::holds_alternative<events::load_start>(evt.value()),
+          "dispatch to current state");
+
+    sc.set_current_state(context::index_of<test_loading>);
+    sc.handle_trace_event(rec, match_temp);
+    sc.handle_trace_event(rec, sound);
+    evt = sc.pop_event_from_queue();
+    Check(evt.has_value() && std::holds_alternative<events::match_start>(evt.value()),
+          "dispatch after state change");
+
+    // a machine in none of the context's states has no edges
+    sc.set_current_state(context::state_count);
+    sc.handle_trace_event(rec, loading);
+    Check(sc.event_queue_size() == 0, "dispatch outside the context's states");
+}
+
+static void TestDiagnostics() {
+    using context = states::state_context<test_menus, test_loading>;
+    Check(diagnostics::type_name<events::load_start>() == "load_start", "type name");
+    Check(diagnostics::event_names[events::event_t(events::match_paused{}).index()] ==
+              "match_paused",
+          "event names");
+
+    // the records of one event, handled and sent on the way the controller does
+    context sc;
+    diagnostics::ring ring;
+    auto loading = FileCreateEvent(L"D:\\MCC\\data\\ui\\loadingscreen.gfx");
+    uint64_t id = ring.push_event(loading);
+    diagnostics::recorder rec(ring, 0);
+    sc.handle_trace_event(rec, loading);
+    while (auto evt = sc.pop_event_from_queue()) {
+        rec.record_sent(evt.value());
+        sc.set_current_state(context::index_of<test_loading>);
+        rec.set_state(sc.current_state());
+        rec.record(diagnostics::record_kind::result_state);
+    }
+
+    const std::array<diagnostics::machine_names, 1> machines = {{
+        { L"user", context::state_names },
+    }};
+    std::wostringstream expected;
+    expected << L"\tEvent 0: " << loading << L"\n"
+             << L"\t\tuser Current State: test_menus\n"
+             << L"\t\t\tState Context Cache: miss\n"
+             << L"\t\t\tSequence Result (0): complete\n"
+             << L"\t\t\tSequence Result (1): nil\n"
+             << L"\t\t\tSending Event: load_start\n"
+             << L"\t\t\tResult State: test_loading\n";
+    std::wostringstream woss;
+    diagnostics::format(woss, ring, id, machines);
+    Check(woss.str() == expected.str(), "format records");
+
+    // only the newest events are kept, and formatting starts at the oldest of them
+    for (size_t i = 0; i < diagnostics::ring::event_capacity; ++i) {
+        ring.push_event(loading);
+        diagnostics::recorder(ring, 0).record(diagnostics::record_kind::cache_hit);
+    }
+    Check((ring.find_event(0) == nullptr) && (ring.find_event(1) != nullptr) &&
+              (ring.first_event() == 1),
+          "ring overwrites oldest event");
+    size_t records = 0;
+    ring.for_each(ring.event_count() - 2, [&](const diagnostics::record &) { ++records; });
+    Check(records == 2, "ring records from event");
+    woss.str(L"");
+    diagnostics::format(woss, ring, 0, machines);
+    Check(woss.str().starts_with(L"\tEvent 1: "), "format from oldest held event");
+}
+
+static void TestPrint() {
+    std::wostringstream woss;
+    woss << FileCreateEvent(L"D:\\MCC\\halo3\\maps\\guardian.map", 77);
+    Check(woss.str() == L"FileIo (64) pid=77 tid=0 Path=D:\\MCC\\halo3\\maps\\guardian.map",
+          "print event");
+}
+
+static void BenchmarkFilters() {
+    // a trace is mostly reads and creates the filters turn away
+    std::vector<normalized_event> events;
+    for (int i = 0; i < 64; ++i) {
+        events.push_back(FileCreateEvent(L"C:\\Windows\\Temp\\file" + std::to_wstring(i) + L".log"));
+        events.push_back(FileReadEvent(4096 + i));
+    }
+    events.push_back(FileCreateEvent(L"D:\\MCC\\halo3\\maps\\guardian.map"));
+    events.push_back(FileReadEvent(static_cast<uint32_t>(mccinfo::constants::fsb_fio_read_size)));
+
+    constexpr size_t iterations = 20000;
+    size_t accepted = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        for (const auto &event : events) {
+            accepted += predicates::filters::file_io_targets(event) ? 1 : 0;
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << std::left << std::setw(align) << "filter file io events: " << std::fixed
+              << std::setprecision(1) << (elapsed.count() / (iterations * events.size()))
+              << " ns/event (" << accepted << " accepted)" << std::endl;
+}
+
+int main() {
+    TestPathTable();
+    TestPredicates();
+    TestTheaterFileIndexing();
+    TestSequences();
+    TestEdges();
+    TestStateContext();
+    TestStateCoverage();
+    TestStateDispatch();
+    TestDiagnostics();
+    TestPrint();
+    BenchmarkFilters();
+
+    std::cout << (failures ? "FAILED" : "PASSED") << std::endl;
+    return failures ? 1 : 0;
+}